@@ -0,0 +1,162 @@
+/*
+ * Compares element-wise loops over SIN arrays written the naive way against the form the code generator emits for them.
+ *
+ * The naive loops read the length and the elements through the same pointer, as `while i < a:len { ... }` would be
+ * translated one statement at a time. The generated form hoists `restrict` element pointers out of the loop and runs it
+ * in blocks of SINL_ARRAY_VECTOR_BLOCK iterations, which gcc vectorizes at -O2.
+ *
+ * Build with the makefile in this directory, then run `./array_loops [rounds]`.
+ * Adding `-DSINL_ARRAY_ALIGNMENT=32` (or 16, or 64) to the build flags measures the aligned array layout instead.
+ * Adding `-fopt-info-vec` to the build flags shows which loops were vectorized.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_array.h"
+
+#define LENGTH 4099
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned char *new_array(uint32_t length, size_t width)
+{
+    unsigned char *array = calloc(1, SINL_ARRAY_HEADER_SIZE + length * width);
+    memcpy(array, &length, sizeof length);
+    return array;
+}
+
+/* c[i] = a[i] * b[i] + 1.0 over float arrays */
+
+__attribute__((noinline)) static void multiply_naive(unsigned char *c, unsigned char *a, unsigned char *b)
+{
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(c))
+    {
+        ((float *)sinl_array_data(c))[i] = ((float *)sinl_array_data(a))[i] * ((float *)sinl_array_data(b))[i] + 1.0f;
+        i = i + 1;
+    }
+}
+
+__attribute__((noinline)) static void multiply_generated(unsigned char *c, unsigned char *a, unsigned char *b)
+{
+    int32_t i = 0;
+    const int64_t trip = sinl_array_length(c);
+    float *restrict elements_c = SINL_ARRAY_DATA(c, float);
+    float *restrict elements_a = SINL_ARRAY_DATA(a, float);
+    float *restrict elements_b = SINL_ARRAY_DATA(b, float);
+    for (int64_t blocks = sinl_array_blocks(i, trip); blocks > 0; blocks--)
+    {
+        SINL_ARRAY_IVDEP
+        for (int lane = 0; lane < SINL_ARRAY_VECTOR_BLOCK; lane++)
+        {
+            elements_c[i] = elements_a[i] * elements_b[i] + 1.0f;
+            i = i + 1;
+        }
+    }
+    while (i < trip)
+    {
+        elements_c[i] = elements_a[i] * elements_b[i] + 1.0f;
+        i = i + 1;
+    }
+}
+
+/* c[i] = c[i] + a[i] over int arrays */
+
+__attribute__((noinline)) static void accumulate_naive(unsigned char *c, unsigned char *a)
+{
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(c))
+    {
+        ((int32_t *)sinl_array_data(c))[i] = ((int32_t *)sinl_array_data(c))[i] + ((int32_t *)sinl_array_data(a))[i];
+        i = i + 1;
+    }
+}
+
+__attribute__((noinline)) static void accumulate_generated(unsigned char *c, unsigned char *a)
+{
+    int32_t i = 0;
+    const int64_t trip = sinl_array_length(c);
+    int32_t *restrict elements_c = SINL_ARRAY_DATA(c, int32_t);
+    int32_t *restrict elements_a = SINL_ARRAY_DATA(a, int32_t);
+    for (int64_t blocks = sinl_array_blocks(i, trip); blocks > 0; blocks--)
+    {
+        SINL_ARRAY_IVDEP
+        for (int lane = 0; lane < SINL_ARRAY_VECTOR_BLOCK; lane++)
+        {
+            elements_c[i] = elements_c[i] + elements_a[i];
+            i = i + 1;
+        }
+    }
+    while (i < trip)
+    {
+        elements_c[i] = elements_c[i] + elements_a[i];
+        i = i + 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 100000;
+
+    unsigned char *fa = new_array(LENGTH, sizeof(float));
+    unsigned char *fb = new_array(LENGTH, sizeof(float));
+    unsigned char *fc = new_array(LENGTH, sizeof(float));
+    unsigned char *ia = new_array(LENGTH, sizeof(int32_t));
+    unsigned char *ic = new_array(LENGTH, sizeof(int32_t));
+    for (uint32_t i = 0; i < LENGTH; i++)
+    {
+        SINL_ARRAY_DATA(fa, float)[i] = (float)i;
+        SINL_ARRAY_DATA(fb, float)[i] = 0.5f;
+        SINL_ARRAY_DATA(ia, int32_t)[i] = (int32_t)i;
+    }
+
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+        multiply_naive(fc, fa, fb);
+    const double multiply_naive_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        multiply_generated(fc, fa, fb);
+    const double multiply_generated_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        accumulate_naive(ic, ia);
+    const double accumulate_naive_time = now() - start;
+
+    const int32_t naive_last = SINL_ARRAY_DATA(ic, int32_t)[LENGTH - 1];
+    memset(SINL_ARRAY_DATA(ic, int32_t), 0, LENGTH * sizeof(int32_t));
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        accumulate_generated(ic, ia);
+    const double accumulate_generated_time = now() - start;
+
+    if (naive_last != SINL_ARRAY_DATA(ic, int32_t)[LENGTH - 1])
+        puts("results differ");
+
+    printf("%12s %18s %18s %9s\n", "loop", "naive (ns/elem)", "generated (ns/elem)", "speedup");
+    printf("%12s %18.3f %18.3f %8.2fx\n", "multiply",
+        multiply_naive_time / rounds / LENGTH * 1e9, multiply_generated_time / rounds / LENGTH * 1e9,
+        multiply_naive_time / multiply_generated_time);
+    printf("%12s %18.3f %18.3f %8.2fx\n", "accumulate",
+        accumulate_naive_time / rounds / LENGTH * 1e9, accumulate_generated_time / rounds / LENGTH * 1e9,
+        accumulate_naive_time / accumulate_generated_time);
+
+    free(fa);
+    free(fb);
+    free(fc);
+    free(ia);
+    free(ic);
+    return 0;
+}
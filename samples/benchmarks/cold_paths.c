@@ -0,0 +1,273 @@
+/*
+ * Measures what bounds checks cost indexed loops, with the failure handling written inline at each check against the
+ * form the code generator emits: a branch, marked unlikely, to the runtime's shared cold and noreturn routine.
+ *
+ * Each workload is run three ways: with the error message formatted and the program exited right at the check, as a
+ * straightforward translation would; through `sinl_array_check`, as generated; and with no checks at all, as a lower
+ * bound. The indices come from another array, so gcc can't prove them in range and remove the checks itself. Two of
+ * the workloads are single tight loops. The third calls 256 different functions in turn, each with 16 checks in its
+ * loop, so that their code doesn't fit in the instruction cache; if the inline failure handling made the checked code
+ * larger, this is where it would show.
+ *
+ * Each time is the fastest of several repeats, as noise on the machine only ever adds time.
+ *
+ * Build with the makefile in this directory, then run `./cold_paths [rounds] [window]`.
+ *
+ * With gcc -O2, the inline and outlined forms run at the same speed in all three workloads, within the noise of the
+ * measurement: gcc already treats a path that ends in `exit` as cold, moves it after the function's return, and merges
+ * the checks' failure paths into one. `objdump -d cold_paths` shows the same loops in both. What the shared routine
+ * saves is the size of the failure handling, not time on the common path.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_array.h"
+
+#define LENGTH 4096
+#define INDICES (1 << 16)
+#define REPEATS 7
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned char *new_array(uint32_t length, size_t width)
+{
+    unsigned char *array = calloc(1, SINL_ARRAY_HEADER_SIZE + length * width);
+    memcpy(array, &length, sizeof length);
+    return array;
+}
+
+static const struct sinl_error_site site_gather = SINL_ERROR_SITE("cold_paths.sin", 4);
+static const struct sinl_error_site site_histogram = SINL_ERROR_SITE("cold_paths.sin", 12);
+static const struct sinl_error_site site_kernel = SINL_ERROR_SITE("cold_paths.sin", 20);
+
+#define INLINE_CHECK(array, index, line) \
+    do \
+    { \
+        if ((uint64_t)(index) >= sinl_array_length(array)) \
+        { \
+            fprintf(stderr, "%s:%u: index %lld is out of bounds for an array of length %u\n", "cold_paths.sin", \
+                (unsigned)(line), (long long)(index), (unsigned)sinl_array_length(array)); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+
+/* while i < idx:len { let sum = sum + data[idx[i]]; let i = i + 1; } -- only the access to `data` is checked */
+
+__attribute__((noinline)) static int64_t gather_inline(unsigned char *data, unsigned char *idx)
+{
+    int64_t sum = 0;
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    const int32_t *elements = SINL_ARRAY_DATA(data, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+    {
+        const int64_t k = indices[i];
+        INLINE_CHECK(data, k, 4);
+        sum += elements[k];
+    }
+    return sum;
+}
+
+__attribute__((noinline)) static int64_t gather_outlined(unsigned char *data, unsigned char *idx)
+{
+    int64_t sum = 0;
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    const int32_t *elements = SINL_ARRAY_DATA(data, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+        sum += elements[sinl_array_check(data, indices[i], &site_gather)];
+    return sum;
+}
+
+__attribute__((noinline)) static int64_t gather_unchecked(unsigned char *data, unsigned char *idx)
+{
+    int64_t sum = 0;
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    const int32_t *elements = SINL_ARRAY_DATA(data, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+        sum += elements[indices[i]];
+    return sum;
+}
+
+/* while i < idx:len { let counts[idx[i]] = counts[idx[i]] + 1; let i = i + 1; } */
+
+__attribute__((noinline)) static void histogram_inline(unsigned char *counts, unsigned char *idx)
+{
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    int32_t *elements = SINL_ARRAY_DATA(counts, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+    {
+        const int64_t k = indices[i];
+        INLINE_CHECK(counts, k, 12);
+        elements[k]++;
+    }
+}
+
+__attribute__((noinline)) static void histogram_outlined(unsigned char *counts, unsigned char *idx)
+{
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    int32_t *elements = SINL_ARRAY_DATA(counts, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+        elements[sinl_array_check(counts, indices[i], &site_histogram)]++;
+}
+
+__attribute__((noinline)) static void histogram_unchecked(unsigned char *counts, unsigned char *idx)
+{
+    const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    int32_t *elements = SINL_ARRAY_DATA(counts, int32_t);
+    for (int64_t i = 0; i < (int64_t)sinl_array_length(idx); i++)
+        elements[indices[i]]++;
+}
+
+/*
+ * def int kernel_N(alloc array<int> data, alloc array<int> idx, alloc int start, alloc int window) {
+ *     ... let sum = sum + data[idx[start + i + T]] * (16 * N + T + 1); ... for T in 0 to 15, while i < window
+ * }
+ *
+ * Only the accesses to `data` are checked. The window is passed in, so that gcc can't unroll the loops completely.
+ */
+
+#define CHECK_inline(array, k, line) INLINE_CHECK(array, k, line)
+#define CHECK_outlined(array, k, line) k = sinl_array_check(array, k, &site_kernel)
+#define CHECK_unchecked(array, k, line) (void)(line)
+
+#define TAP(checks, n, t) \
+    { \
+        int64_t k = indices[i + t]; \
+        CHECK_##checks(data, k, 20 + (n) * 16 + t); \
+        sum += elements[k] * ((n) * 16 + t + 1); \
+    }
+
+#define KERNEL(checks, n) \
+    __attribute__((noinline)) static int64_t kernel_##checks##_##n(unsigned char *data, unsigned char *idx, int64_t start, int64_t window) \
+    { \
+        int64_t sum = 0; \
+        const int32_t *indices = SINL_ARRAY_DATA(idx, int32_t) + start; \
+        const int32_t *elements = SINL_ARRAY_DATA(data, int32_t); \
+        for (int64_t i = 0; i < window; i++) \
+        { \
+            TAP(checks, n, 0) TAP(checks, n, 1) TAP(checks, n, 2) TAP(checks, n, 3) \
+            TAP(checks, n, 4) TAP(checks, n, 5) TAP(checks, n, 6) TAP(checks, n, 7) \
+            TAP(checks, n, 8) TAP(checks, n, 9) TAP(checks, n, 10) TAP(checks, n, 11) \
+            TAP(checks, n, 12) TAP(checks, n, 13) TAP(checks, n, 14) TAP(checks, n, 15) \
+        } \
+        return sum; \
+    }
+
+// 256 kernels for each form of check, numbered in base 4
+#define KERNELS_4(checks, n) KERNEL(checks, n##0) KERNEL(checks, n##1) KERNEL(checks, n##2) KERNEL(checks, n##3)
+#define KERNELS_16(checks, n) KERNELS_4(checks, n##0) KERNELS_4(checks, n##1) KERNELS_4(checks, n##2) KERNELS_4(checks, n##3)
+#define KERNELS_64(checks, n) KERNELS_16(checks, n##0) KERNELS_16(checks, n##1) KERNELS_16(checks, n##2) KERNELS_16(checks, n##3)
+#define KERNELS_256(checks) KERNELS_64(checks, 0) KERNELS_64(checks, 1) KERNELS_64(checks, 2) KERNELS_64(checks, 3)
+
+#define LIST_4(checks, n) kernel_##checks##_##n##0, kernel_##checks##_##n##1, kernel_##checks##_##n##2, kernel_##checks##_##n##3,
+#define LIST_16(checks, n) LIST_4(checks, n##0) LIST_4(checks, n##1) LIST_4(checks, n##2) LIST_4(checks, n##3)
+#define LIST_64(checks, n) LIST_16(checks, n##0) LIST_16(checks, n##1) LIST_16(checks, n##2) LIST_16(checks, n##3)
+#define LIST_256(checks) { LIST_64(checks, 0) LIST_64(checks, 1) LIST_64(checks, 2) LIST_64(checks, 3) }
+
+#define KERNEL_COUNT 256
+#define TAPS 16
+
+typedef int64_t (*kernel)(unsigned char *, unsigned char *, int64_t, int64_t);
+
+KERNELS_256(inline)
+KERNELS_256(outlined)
+KERNELS_256(unchecked)
+
+static const kernel kernels[3][KERNEL_COUNT] = { LIST_256(inline), LIST_256(outlined), LIST_256(unchecked) };
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 200;
+    const int64_t window = argc > 2 ? atoi(argv[2]) : 8;
+
+    unsigned char *data = new_array(LENGTH, sizeof(int32_t));
+    unsigned char *counts = new_array(LENGTH, sizeof(int32_t));
+    unsigned char *idx = new_array(INDICES, sizeof(int32_t));
+    if (window < 0 || window + 2 * TAPS > INDICES)
+    {
+        fputs("the window must be between 0 and 65504\n", stderr);
+        return 1;
+    }
+
+    int32_t *elements = SINL_ARRAY_DATA(data, int32_t);
+    for (int32_t i = 0; i < LENGTH; i++)
+        elements[i] = i * 7 - 3;
+
+    int32_t *indices = SINL_ARRAY_DATA(idx, int32_t);
+    uint32_t seed = 12345;
+    for (int32_t i = 0; i < INDICES; i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        indices[i] = (int32_t)((seed >> 8) % LENGTH);
+    }
+
+    int64_t (*const gathers[])(unsigned char *, unsigned char *) = { gather_inline, gather_outlined, gather_unchecked };
+    void (*const histograms[])(unsigned char *, unsigned char *) = { histogram_inline, histogram_outlined, histogram_unchecked };
+    const char *const names[] = { "inline", "outlined", "unchecked" };
+
+    printf("%-12s %18s %18s %18s\n", "checks", "gather (ns/elt)", "histogram (ns/elt)", "kernels (ns/elt)");
+    int64_t expected = 0;
+    int64_t expected_kernels = 0;
+    for (int v = 0; v < 3; v++)
+    {
+        double gather_time = 1e9;
+        double histogram_time = 1e9;
+        double kernel_time = 1e9;
+        int64_t sum = 0;
+        int64_t kernel_sum = 0;
+        for (int repeat = 0; repeat < REPEATS; repeat++)
+        {
+            sum = 0;
+            double start = now();
+            for (int r = 0; r < rounds; r++)
+                sum += gathers[v](data, idx);
+            double elapsed = now() - start;
+            gather_time = elapsed < gather_time ? elapsed : gather_time;
+
+            start = now();
+            for (int r = 0; r < rounds; r++)
+                histograms[v](counts, idx);
+            elapsed = now() - start;
+            histogram_time = elapsed < histogram_time ? elapsed : histogram_time;
+
+            // the kernels are run in turn, each starting at a different index
+            kernel_sum = 0;
+            start = now();
+            for (int r = 0; r < rounds; r++)
+            {
+                for (int k = 0; k < KERNEL_COUNT; k++)
+                    kernel_sum += kernels[v][k](data, idx, k % TAPS, window);
+            }
+            elapsed = now() - start;
+            kernel_time = elapsed < kernel_time ? elapsed : kernel_time;
+        }
+
+        if (v == 0)
+        {
+            expected = sum;
+            expected_kernels = kernel_sum;
+        }
+        else if (sum != expected || kernel_sum != expected_kernels)
+        {
+            puts("results differ");
+        }
+
+        const double elements_run = (double)rounds * INDICES;
+        const double kernel_elements_run = (double)rounds * KERNEL_COUNT * TAPS * (window > 0 ? window : 1);
+        printf("%-12s %18.3f %18.3f %18.3f\n", names[v], gather_time / elements_run * 1e9, histogram_time / elements_run * 1e9,
+            kernel_time / kernel_elements_run * 1e9);
+    }
+
+    free(data);
+    free(counts);
+    free(idx);
+    return 0;
+}
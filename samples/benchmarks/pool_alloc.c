@@ -0,0 +1,120 @@
+/*
+ * Compares the runtime's pooled allocator against plain malloc() and free().
+ *
+ * Each workload allocates a batch of same-sized blocks, touches them, and releases them again,
+ * which is the pattern generated code follows for dynamic data allocated in a loop or a short-lived scope.
+ *
+ * Build with the makefile in this directory, then run `./pool_alloc [rounds]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_pool.h"
+
+#define BATCH 4096
+
+static void *blocks[BATCH];
+static size_t sizes[BATCH];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void touch(void *block, size_t size, size_t i)
+{
+    /* keep the allocations from being optimized out */
+    ((unsigned char *)block)[0] = (unsigned char)i;
+    ((unsigned char *)block)[size - 1] = (unsigned char)i;
+}
+
+static unsigned long checksum(size_t size)
+{
+    unsigned long sum = 0;
+    for (size_t i = 0; i < BATCH; i++)
+        sum += ((unsigned char *)blocks[i])[size - 1];
+    return sum;
+}
+
+static double run_malloc(size_t size, int rounds, unsigned long *sum)
+{
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            blocks[i] = malloc(size);
+            touch(blocks[i], size, i);
+        }
+        *sum += checksum(size);
+        for (size_t i = 0; i < BATCH; i++)
+            free(blocks[i]);
+    }
+    return now() - start;
+}
+
+static double run_pool(size_t size, int rounds, unsigned long *sum)
+{
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            blocks[i] = sinl_pool_alloc(size);
+            touch(blocks[i], size, i);
+        }
+        *sum += checksum(size);
+        for (size_t i = 0; i < BATCH; i++)
+            sinl_pool_free(blocks[i], size);
+    }
+    return now() - start;
+}
+
+static double run_pool_bulk(size_t size, int rounds, unsigned long *sum)
+{
+    for (size_t i = 0; i < BATCH; i++)
+        sizes[i] = size;
+
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < BATCH; i++)
+        {
+            blocks[i] = sinl_pool_alloc(size);
+            touch(blocks[i], size, i);
+        }
+        *sum += checksum(size);
+        sinl_pool_release(blocks, sizes, BATCH);
+    }
+    return now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    const size_t test_sizes[] = { 8, 16, 24, 64, 100, 256 };
+    unsigned long sum = 0;
+
+    printf("%8s %14s %14s %14s %9s\n", "size", "malloc (ns)", "pool (ns)", "bulk (ns)", "speedup");
+    for (size_t s = 0; s < sizeof(test_sizes) / sizeof(test_sizes[0]); s++)
+    {
+        const size_t size = test_sizes[s];
+        const double ops = (double)rounds * BATCH;
+
+        double m = run_malloc(size, rounds, &sum);
+        double p = run_pool(size, rounds, &sum);
+        double b = run_pool_bulk(size, rounds, &sum);
+
+        printf("%8zu %14.2f %14.2f %14.2f %8.2fx\n", size, m / ops * 1e9, p / ops * 1e9, b / ops * 1e9, m / p);
+    }
+
+    /* print the checksum so the work can't be discarded */
+    fprintf(stderr, "checksum: %lu\n", sum);
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Measures what `--instrument` adds to each function call, using a naive Fibonacci function, which does almost
+ * nothing but call itself.
+ *
+ * The instrumented version is written the way the code generator emits it: a static profiling site, holding the SIN
+ * name, at the start of the body, and the exit recorded once the return value has been computed. At exit, the runtime
+ * writes the profile to `sinl_profile.txt` (or wherever `SINL_PROFILE` names; `-` for standard error).
+ *
+ * Build with the makefile in this directory, then run `./profile_overhead [n]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_profile.h"
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* def int fib(alloc int n) { if (n < 2) { return n; } return @fib(n - 1) + @fib(n - 2); } */
+
+__attribute__((noinline)) static int32_t fib(int32_t n)
+{
+    if (n < 2)
+        return n;
+    return fib(n - 1) + fib(n - 2);
+}
+
+__attribute__((noinline)) static int32_t fib_instrumented(int32_t n)
+{
+    static struct sinl_profile_site _sinl_impl_profile_site = { "fib", "fib.sin", 1, 0 };
+    sinl_profile_enter(&_sinl_impl_profile_site);
+    if (n < 2)
+    {
+        sinl_profile_exit();
+        return n;
+    }
+    const int32_t _sinl_impl_return = fib_instrumented(n - 1) + fib_instrumented(n - 2);
+    sinl_profile_exit();
+    return _sinl_impl_return;
+}
+
+/* def int run(alloc int n) { return @fib(n); } -- so that the call graph has more than one function */
+
+__attribute__((noinline)) static int32_t run_instrumented(int32_t n)
+{
+    static struct sinl_profile_site _sinl_impl_profile_site = { "run", "fib.sin", 5, 0 };
+    sinl_profile_enter(&_sinl_impl_profile_site);
+    const int32_t _sinl_impl_return = fib_instrumented(n);
+    sinl_profile_exit();
+    return _sinl_impl_return;
+}
+
+int main(int argc, char **argv)
+{
+    const int32_t n = argc > 1 ? atoi(argv[1]) : 30;
+
+    double start = now();
+    const int32_t plain = fib(n);
+    const double plain_time = now() - start;
+
+    start = now();
+    const int32_t instrumented = run_instrumented(n);
+    const double instrumented_time = now() - start;
+
+    if (plain != instrumented)
+        puts("results differ");
+
+    /* fib(n) makes 2 * fib(n + 1) - 1 calls */
+    double calls = 0.0, a = 0.0, b = 1.0;
+    for (int32_t i = 0; i <= n; i++)
+    {
+        const double next = a + b;
+        a = b;
+        b = next;
+    }
+    calls = 2.0 * a - 1.0;
+
+    printf("%14s %14s %14s %14s\n", "calls", "plain (ms)", "instr. (ms)", "ns/call added");
+    printf("%14.0f %14.3f %14.3f %14.2f\n", calls, plain_time * 1e3, instrumented_time * 1e3,
+        (instrumented_time - plain_time) / calls * 1e9);
+
+    return 0;
+}
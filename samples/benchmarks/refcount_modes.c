@@ -0,0 +1,68 @@
+/*
+ * Compares the cost of the runtime's reference counting modes in a single-threaded program.
+ *
+ * Each workload copies references to a set of resources around, as generated code does when pointers are reseated
+ * or resources are passed to functions, then releases every resource.
+ *
+ * Build with the makefile in this directory, then run `./refcount_modes [rounds]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_refcount.h"
+
+#define RESOURCES 1024
+#define COPIES 16
+
+static void *resources[RESOURCES];
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#define DEFINE_BENCHMARK(mode, alloc)                                   \
+    static double run_##mode(int rounds)                                \
+    {                                                                   \
+        double start = now();                                           \
+        for (int r = 0; r < rounds; r++)                                \
+        {                                                               \
+            for (size_t i = 0; i < RESOURCES; i++)                      \
+                resources[i] = alloc(16);                               \
+            for (int c = 0; c < COPIES; c++)                            \
+                for (size_t i = 0; i < RESOURCES; i++)                  \
+                    sinl_rc_retain_##mode(resources[i]);                \
+            for (int c = 0; c < COPIES; c++)                            \
+                for (size_t i = 0; i < RESOURCES; i++)                  \
+                    sinl_rc_release_##mode(resources[i]);               \
+            for (size_t i = 0; i < RESOURCES; i++)                      \
+                sinl_rc_release_##mode(resources[i]);                   \
+        }                                                               \
+        return now() - start;                                           \
+    }
+
+DEFINE_BENCHMARK(atomic, sinl_rc_alloc)
+DEFINE_BENCHMARK(nonatomic, sinl_rc_alloc)
+DEFINE_BENCHMARK(biased, sinl_rc_alloc_biased)
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 2000;
+    const double ops = (double)rounds * RESOURCES * (COPIES * 2 + 1);
+
+    double atomic = run_atomic(rounds);
+    double nonatomic = run_nonatomic(rounds);
+    double biased = run_biased(rounds);
+
+    printf("%10s %14s %9s\n", "mode", "ns per op", "speedup");
+    printf("%10s %14.2f %8.2fx\n", "atomic", atomic / ops * 1e9, 1.0);
+    printf("%10s %14.2f %8.2fx\n", "nonatomic", nonatomic / ops * 1e9, atomic / nonatomic);
+    printf("%10s %14.2f %8.2fx\n", "biased", biased / ops * 1e9, atomic / biased);
+    return 0;
+}
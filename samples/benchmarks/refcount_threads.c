@@ -0,0 +1,137 @@
+/*
+ * Checks that resources shared between threads with biased reference counts are freed, and times handing them over.
+ *
+ * An owning thread allocates resources and hands a reference to each to a second thread. In alternate rounds, the
+ * owner drops its own reference before or after the other thread drops the one it was given, so the releases of
+ * references the owner's count holds are handed back to the owner in both orders. The last resources are released
+ * only once the owner has exited. The program fails if any resource is still live at the end.
+ *
+ * Build with the makefile in this directory, then run `./refcount_threads [rounds]`.
+ * The allocation profile is written when the program exits, as usual; set SINL_ALLOC_REPORT=- to see it.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_refcount.h"
+
+#define RESOURCES 1024
+
+static struct sinl_alloc_site site = SINL_ALLOC_SITE("refcount_threads.c", __LINE__);
+static void *handed[RESOURCES];
+static pthread_barrier_t barrier;
+static int rounds;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void hand_over(void)
+{
+    for (size_t i = 0; i < RESOURCES; i++)
+    {
+        handed[i] = sinl_rc_track(sinl_rc_alloc_biased(16), &site);
+        sinl_rc_retain_biased(handed[i]);
+    }
+}
+
+static void release_handed(void)
+{
+    for (size_t i = 0; i < RESOURCES; i++)
+        sinl_rc_release_biased(handed[i]);
+}
+
+static void *owner(void *arg)
+{
+    (void)arg;
+    for (int r = 0; r < rounds; r++)
+    {
+        hand_over();
+        pthread_barrier_wait(&barrier);
+        if (r % 2 == 0)
+        {
+            release_handed();
+            pthread_barrier_wait(&barrier);
+        }
+        else
+        {
+            pthread_barrier_wait(&barrier);
+            release_handed();
+        }
+
+        // the next round hands over new resources in the same slots
+        pthread_barrier_wait(&barrier);
+    }
+
+    // the last references are released after this thread has exited
+    hand_over();
+    release_handed();
+    return NULL;
+}
+
+static void *borrower(void *arg)
+{
+    (void)arg;
+    for (int r = 0; r < rounds; r++)
+    {
+        pthread_barrier_wait(&barrier);
+
+        // a retain and release that only touch the shared count
+        for (size_t i = 0; i < RESOURCES; i++)
+            sinl_rc_retain_biased(handed[i]);
+        release_handed();
+
+        if (r % 2 == 0)
+        {
+            pthread_barrier_wait(&barrier);
+            release_handed();
+        }
+        else
+        {
+            release_handed();
+            pthread_barrier_wait(&barrier);
+        }
+
+        pthread_barrier_wait(&barrier);
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    rounds = argc > 1 ? atoi(argv[1]) : 1000;
+    pthread_barrier_init(&barrier, NULL, 2);
+
+    pthread_t owner_thread;
+    pthread_t borrower_thread;
+    double start = now();
+    pthread_create(&owner_thread, NULL, owner, NULL);
+    pthread_create(&borrower_thread, NULL, borrower, NULL);
+    pthread_join(borrower_thread, NULL);
+    pthread_join(owner_thread, NULL);
+    double elapsed = now() - start;
+
+    release_handed();
+    pthread_barrier_destroy(&barrier);
+
+    const double handed_over = rounds > 0 ? (double)rounds * RESOURCES : 1.0;
+    printf("%-24s %10.2f ns per resource handed over\n", "biased", elapsed / handed_over * 1e9);
+
+    const int64_t live = __atomic_load_n(&site.live_bytes, __ATOMIC_RELAXED);
+    if (live != 0)
+    {
+        printf("%lld bytes are still live\n", (long long)live);
+        return 1;
+    }
+
+    printf("every resource was freed\n");
+    return 0;
+}
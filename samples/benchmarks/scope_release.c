@@ -0,0 +1,76 @@
+/*
+ * Compares releasing a scope's managed locals one at a time against releasing them with a single batched call.
+ *
+ * Each round enters a scope that takes a reference to a number of managed resources and then exits it,
+ * as generated code does for a function or block with several managed locals.
+ * Non-atomic counts are used so that the cost of the calls isn't hidden behind the cost of atomic operations.
+ *
+ * Build with the makefile in this directory, then run `./scope_release [rounds]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_refcount.h"
+
+#define MAX_LOCALS 32
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* one out-of-line call per local, as releases through the SRE would be */
+__attribute__((noinline)) static void release_one(void *local)
+{
+    sinl_rc_release_nonatomic(local);
+}
+
+static double run(size_t locals, int rounds, int batched)
+{
+    void *slots[MAX_LOCALS];
+    for (size_t i = 0; i < locals; i++)
+        slots[i] = sinl_rc_alloc(16);
+
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < locals; i++)
+            sinl_rc_retain_nonatomic(slots[i]);
+
+        if (batched)
+        {
+            sinl_rc_release_batch_nonatomic(slots, locals);
+        }
+        else
+        {
+            for (size_t i = locals; i > 0; i--)
+                release_one(slots[i - 1]);
+        }
+    }
+    double elapsed = now() - start;
+
+    sinl_rc_release_batch_nonatomic(slots, locals);
+    return elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 1000000;
+    const size_t counts[] = { 1, 4, 8, 16, 32 };
+
+    printf("%8s %16s %16s %9s\n", "locals", "each (ns/scope)", "batch (ns/scope)", "speedup");
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        double each = run(counts[c], rounds, 0);
+        double batch = run(counts[c], rounds, 1);
+        printf("%8zu %16.2f %16.2f %8.2fx\n", counts[c], each / rounds * 1e9, batch / rounds * 1e9, each / batch);
+    }
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Compares the inline small-string layout against the previous layout, where every string pointed to a
+ * length-prefixed buffer in dynamic memory.
+ *
+ * Each round builds a large number of strings by concatenating two pieces of text, reads every character of each,
+ * and then releases them all. The lengths cover strings that fit inline and strings that don't,
+ * so both sides of the threshold are visible.
+ *
+ * Build with the makefile in this directory, then run `./small_string [rounds]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "sinl_string.h"
+
+/* the number of strings live at once */
+#define COUNT 100000
+
+static const char text[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* the previous layout: a pointer to the length followed by the characters */
+
+static char *heap_create(const char *data, uint32_t length)
+{
+    char *str = malloc(sizeof(uint32_t) + length + 1);
+    memcpy(str, &length, sizeof(uint32_t));
+    memcpy(str + sizeof(uint32_t), data, length);
+    str[sizeof(uint32_t) + length] = '\0';
+    return str;
+}
+
+static char *heap_concat(char *left, const char *data, uint32_t length)
+{
+    uint32_t left_length;
+    memcpy(&left_length, left, sizeof(uint32_t));
+
+    char *str = heap_create(left + sizeof(uint32_t), left_length + length);
+    memcpy(str + sizeof(uint32_t) + left_length, data, length);
+    free(left);
+    return str;
+}
+
+static double run_heap(uint32_t half, int rounds, unsigned long *checksum)
+{
+    static char *strings[COUNT];
+
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t n = 0; n < COUNT; n++)
+        {
+            strings[n] = heap_create(text + n % half, half);
+            strings[n] = heap_concat(strings[n], text + half, half);
+        }
+
+        for (size_t n = 0; n < COUNT; n++)
+        {
+            uint32_t length;
+            memcpy(&length, strings[n], sizeof(uint32_t));
+            for (uint32_t i = 0; i < length; i++)
+                *checksum += (unsigned char)strings[n][sizeof(uint32_t) + i];
+        }
+
+        for (size_t n = 0; n < COUNT; n++)
+            free(strings[n]);
+    }
+
+    return now() - start;
+}
+
+static double run_inline(uint32_t half, int rounds, unsigned long *checksum)
+{
+    static sinl_string strings[COUNT];
+
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (size_t n = 0; n < COUNT; n++)
+        {
+            sinl_string tail = SINL_STRING_EMPTY;
+            strings[n] = (sinl_string)SINL_STRING_EMPTY;
+            sinl_string_assign(&strings[n], text + n % half, half);
+            sinl_string_assign(&tail, text + half, half);
+            sinl_string_concat(&strings[n], &strings[n], &tail);
+            sinl_string_release(&tail);
+        }
+
+        for (size_t n = 0; n < COUNT; n++)
+        {
+            const uint32_t length = sinl_string_length(&strings[n]);
+            const char *data = sinl_string_data(&strings[n]);
+            for (uint32_t i = 0; i < length; i++)
+                *checksum += (unsigned char)data[i];
+        }
+
+        for (size_t n = 0; n < COUNT; n++)
+            sinl_string_release(&strings[n]);
+    }
+
+    return now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 20;
+    const uint32_t lengths[] = { 4, 8, 12, 16, 18, 24, 32, 48 };
+    unsigned long checksum = 0;
+
+    printf("%8s %16s %16s %9s\n", "length", "heap (ns/string)", "inline (ns/str)", "speedup");
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+    {
+        double heap = run_heap(lengths[l] / 2, rounds, &checksum);
+        double inl = run_inline(lengths[l] / 2, rounds, &checksum);
+        printf("%8u %16.2f %16.2f %8.2fx\n", lengths[l], heap / rounds / COUNT * 1e9, inl / rounds / COUNT * 1e9, heap / inl);
+    }
+
+    // keeps the reads from being optimized away
+    if (checksum == 0)
+        puts("unexpected checksum");
+
+    return 0;
+}
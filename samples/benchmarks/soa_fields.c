@@ -0,0 +1,175 @@
+/*
+ * Compares loops that scan the fields of an array of structs stored as an ordinary array (AoS) against the same loops
+ * over a `soa` array, which stores one array for each member.
+ *
+ * Both layouts are written the way the code generator emits them: the AoS array is its length followed by the structs,
+ * and the `soa` array is its length followed by the columns, so `a[i].x` becomes `a.x[i]`. Every access is bounds
+ * checked against the length at the head of the array, as it would be without the optimizer.
+ *
+ * The arrays are much larger than the cache, so each loop is limited by how many of the bytes it reads it actually uses.
+ *
+ * Build with the makefile in this directory, then run `./soa_fields [rounds]`.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "sinl_array.h"
+
+#define LENGTH (1 << 20)
+
+struct particle
+{
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    int32_t id;
+};
+
+/* what `alloc array<LENGTH, particle> a &soa;` generates */
+typedef struct
+{
+    uint32_t len;
+    float x[LENGTH];
+    float y[LENGTH];
+    float z[LENGTH];
+    float vx[LENGTH];
+    float vy[LENGTH];
+    float vz[LENGTH];
+    float mass[LENGTH];
+    int32_t id[LENGTH];
+} soa_particles;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* keeps the sums from being computed once and reused across rounds */
+static void clobber(void)
+{
+    __asm__ volatile("" ::: "memory");
+}
+
+static void check(const void *array, int64_t index)
+{
+    if (index < 0 || index >= sinl_array_length(array))
+    {
+        fputs("index out of range\n", stderr);
+        exit(1);
+    }
+}
+
+/* let sum = sum + a[i].x */
+
+__attribute__((noinline)) static float sum_aos(unsigned char *a)
+{
+    float sum = 0.0f;
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(a))
+    {
+        check(a, i);
+        sum = sum + SINL_ARRAY_DATA(a, struct particle)[i].x;
+        i = i + 1;
+    }
+    return sum;
+}
+
+__attribute__((noinline)) static float sum_soa(soa_particles *a)
+{
+    float sum = 0.0f;
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(a))
+    {
+        check(a, i);
+        sum = sum + a->x[i];
+        i = i + 1;
+    }
+    return sum;
+}
+
+/* let a[i].x = a[i].x + a[i].vx */
+
+__attribute__((noinline)) static void move_aos(unsigned char *a)
+{
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(a))
+    {
+        check(a, i);
+        SINL_ARRAY_DATA(a, struct particle)[i].x = SINL_ARRAY_DATA(a, struct particle)[i].x +
+            SINL_ARRAY_DATA(a, struct particle)[i].vx;
+        i = i + 1;
+    }
+}
+
+__attribute__((noinline)) static void move_soa(soa_particles *a)
+{
+    int32_t i = 0;
+    while (i < (int64_t)sinl_array_length(a))
+    {
+        check(a, i);
+        a->x[i] = a->x[i] + a->vx[i];
+        i = i + 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int rounds = argc > 1 ? atoi(argv[1]) : 50;
+    const uint32_t length = LENGTH;
+
+    unsigned char *aos = calloc(1, SINL_ARRAY_HEADER_SIZE + sizeof(struct particle) * (size_t)LENGTH);
+    soa_particles *soa = calloc(1, sizeof(soa_particles));
+    memcpy(aos, &length, sizeof length);
+    soa->len = length;
+    for (uint32_t i = 0; i < LENGTH; i++)
+    {
+        SINL_ARRAY_DATA(aos, struct particle)[i].x = soa->x[i] = (float)(i % 100);
+        SINL_ARRAY_DATA(aos, struct particle)[i].vx = soa->vx[i] = 0.25f;
+    }
+
+    float aos_sum = 0.0f, soa_sum = 0.0f;
+    double start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        aos_sum += sum_aos(aos);
+        clobber();
+    }
+    const double sum_aos_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+    {
+        soa_sum += sum_soa(soa);
+        clobber();
+    }
+    const double sum_soa_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        move_aos(aos);
+    const double move_aos_time = now() - start;
+
+    start = now();
+    for (int r = 0; r < rounds; r++)
+        move_soa(soa);
+    const double move_soa_time = now() - start;
+
+    if (aos_sum != soa_sum || SINL_ARRAY_DATA(aos, struct particle)[LENGTH - 1].x != soa->x[LENGTH - 1])
+        puts("results differ");
+
+    printf("%12s %18s %18s %9s\n", "loop", "AoS (ns/elem)", "soa (ns/elem)", "speedup");
+    printf("%12s %18.3f %18.3f %8.2fx\n", "sum x",
+        sum_aos_time / rounds / LENGTH * 1e9, sum_soa_time / rounds / LENGTH * 1e9, sum_aos_time / sum_soa_time);
+    printf("%12s %18.3f %18.3f %8.2fx\n", "x += vx",
+        move_aos_time / rounds / LENGTH * 1e9, move_soa_time / rounds / LENGTH * 1e9, move_aos_time / move_soa_time);
+
+    free(aos);
+    free(soa);
+    return 0;
+}
@@ -1,17 +1,126 @@
 #include "cgen.hpp"
+#include "../parser/parser.hpp"
 #include "../parser/statements.hpp"
+#include "../optimizer/optimizer.hpp"
 #include "../util/exceptions.hpp"
 #include "../util/enumerated_types.hpp"
+#include "../util/constants.hpp"
+#include "../util/data_widths.hpp"
+#include "../util/phase_report.hpp"
 
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
 
-cgen::cgen(bool allow_unsafe, bool use_strict, bool use_micro)
+cgen::cgen(bool allow_unsafe, bool use_strict, bool use_micro, unsigned int optimization_level)
     : _unsafe(allow_unsafe)
     , _strict(use_strict)
-    , _micro(use_micro) { }
+    , _micro(use_micro)
+    , _optimization_level(optimization_level)
+    , _allocation_mode(enumerations::allocation_mode::POOLED_ALLOCATION)
+    , _region_size(DEFAULT_REGION_SIZE)
+    , _refcount_mode(enumerations::refcount_mode::ATOMIC_REFCOUNT)
+    , _array_alignment(sin_widths::ARRAY_LENGTH_SIZE)
+    , _struct_layout(enumerations::struct_layout::DECLARED_LAYOUT)
+    , _instrument(false)
+    , _profile_allocations(false)
+    , _count_costs(false)
+    , _site_count(0)
+    , _whole_program(false)
+    , _function(nullptr)
+    , _block_count(0)
+    , _element_loop_count(0) { }
 
 cgen::~cgen() { }
 
+void cgen::set_allocation_mode(enumerations::allocation_mode mode)
+{
+    _allocation_mode = mode;
+}
+
+void cgen::set_region_size(size_t size)
+{
+    _region_size = size;
+}
+
+void cgen::set_refcount_mode(enumerations::refcount_mode mode)
+{
+    _refcount_mode = mode;
+}
+
+/**
+ * Aligns the elements of every array to 16, 32, or 64 bytes so that they may be loaded directly into vector registers.
+ *
+ * The array length is padded out to the alignment, which changes the width of every array type.
+ */
+void cgen::set_array_alignment(size_t alignment)
+{
+    if (alignment != 16 && alignment != 32 && alignment != 64)
+    {
+        throw error::compiler_exception("Array alignment must be 16, 32, or 64 bytes");
+    }
+
+    _array_alignment = alignment;
+    data_type::set_array_alignment(alignment);
+}
+
+void cgen::set_struct_layout(enumerations::struct_layout layout)
+{
+    _struct_layout = layout;
+}
+
+/**
+ * Makes every function record its calls and how long they take, so that the program writes a profile when it exits.
+ */
+void cgen::set_instrumentation(bool instrument)
+{
+    _instrument = instrument;
+}
+
+/**
+ * Makes every managed allocation record where it was made, so that the program writes a profile of its memory use.
+ */
+void cgen::set_allocation_profiling(bool profile)
+{
+    _profile_allocations = profile;
+}
+
+/**
+ * Makes every runtime bounds check and reference count update count how often it runs, so that the program writes the
+ * counts for each line when it exits.
+ */
+void cgen::set_cost_counters(bool count)
+{
+    _count_costs = count;
+}
+
+/**
+ * Reads a profile of the program, written by a build with `--pgo-generate`, and uses it to mark functions hot or cold.
+ */
+void cgen::set_profile_feedback(const std::string& filename)
+{
+    _profile.load(filename);
+}
+
+/**
+ * Gets the name by which the generated C refers to a symbol.
+ */
+std::string cgen::get_c_name(const symbol& sym) const
+{
+    auto it = _pooled_symbols.find(sym.get_decorated_name());
+    if (it != _pooled_symbols.end())
+    {
+        return it->second;
+    }
+
+    return sym.get_name();
+}
+
 void cgen::process_statement(const statement::statement_base& s)
 {
     using s_type = enumerations::statement_type;
@@ -27,58 +136,47 @@ void cgen::process_statement(const statement::statement_base& s)
             _text << gen_allocation(alloc);
             break;
         }
-        case s_type::ASSIGNMENT:
-        {
-            break;
-        }
-        case s_type::COMPOUND_ASSIGNMENT:
-        {
-            break;
-        }
-        case s_type::CALL:
-        {
-            break;
-        }
-        case s_type::CONSTRUCTION_STATEMENT:
-        {
-            break;
-        }
         case s_type::DECLARATION:
         {
+            gen_declaration(dynamic_cast<const declaration&>(s));
             break;
         }
         case s_type::FUNCTION_DEFINITION:
         {
-            break;
-        }
-        case s_type::IF_THEN_ELSE:
-        {
+            const function_definition& def(dynamic_cast<const function_definition&>(s));
+            declare_function(def, true);
+            _function_definitions.push_back(&def);
             break;
         }
         case s_type::INCLUDE:
         {
-            break;
-        }
-        case s_type::MOVEMENT:
-        {
-            break;
-        }
-        case s_type::RETURN_STATEMENT:
-        {
-            break;
-        }
-        case s_type::SCOPED_BLOCK:
-        {
+            gen_include(dynamic_cast<const include&>(s), _source_filename);
             break;
         }
         case s_type::STRUCT_DEFINITION:
         {
+            // when compiling a whole program, an earlier unit may have defined the struct when it included this one
+            const struct_definition& def(dynamic_cast<const struct_definition&>(s));
+            if (!(_whole_program && _structs.contains(def.get_name())))
+            {
+                _struct_definitions << gen_struct_definition(def);
+            }
             break;
         }
+        case s_type::ASSIGNMENT:
+        case s_type::COMPOUND_ASSIGNMENT:
+        case s_type::MOVEMENT:
+        case s_type::CALL:
+        case s_type::CONSTRUCTION_STATEMENT:
+        case s_type::IF_THEN_ELSE:
         case s_type::WHILE_LOOP:
-        {
-            break;
-        }
+        case s_type::RETURN_STATEMENT:
+        case s_type::SCOPED_BLOCK:
+            throw error::compiler_exception(
+                "Only allocations, declarations, and definitions may be at file scope",
+                error_code::ILLEGAL_OPERATION_ERROR,
+                s.get_line_number()
+            );
         default:
             throw error::compiler_exception("Unsupported statement type", error_code::UNSUPPORTED_FEATURE, s.get_line_number());
             break;
@@ -90,28 +188,249 @@ void cgen::process_statement(const statement::statement_base& s)
     }
 }
 
+/**
+ * The bodies of functions are generated after everything else at file scope, so that they may use anything the unit
+ * declares, however it is ordered.
+ */
 void cgen::generate_code(const statement::statement_block& ast)
 {
     size_t error_count = 0;
 
-    for (const auto& s: ast)
     {
+        general_utilities::phase_report::scope collecting("collect symbols");
+        for (const auto& s: ast.statements_list)
+        {
+            try
+            {
+                process_statement(*s);   
+            }
+            catch(const std::exception& e)
+            {
+                error_count++;
+                std::cerr << e.what() << '\n';
+                
+                if (error_count > 5)
+                    break;
+            }
+        }
+    }
+
+    order_functions(_function_definitions);
+    for (const statement::function_definition* def: _function_definitions)
+    {
+        if (error_count > 5)
+            break;
+
         try
         {
-            process_statement(s);   
+            _functions << gen_function_definition(*def);
         }
-        catch(const std::exception& e)
+        catch (const std::exception& e)
         {
             error_count++;
             std::cerr << e.what() << '\n';
-            
-            if (error_count > 5)
-                break;
+
+            // the function was abandoned part of the way through
+            _scope.clear();
+            _function = nullptr;
         }
     }
+    _function_definitions.clear();
+
+    // the errors have been reported, but the unit mustn't be written out
+    if (error_count)
+    {
+        throw error::compiler_exception(
+            "Code generation failed with " + std::to_string(error_count) + (error_count == 1 ? " error" : " errors")
+        );
+    }
+}
+
+/**
+ * Parses a unit, and optimizes it if optimizations are enabled, writing the optimizer's report to `report`.
+ *
+ * This only reads the generator's settings, so units may be parsed on several threads at once.
+ */
+statement::statement_block cgen::parse_unit(const std::string& filename, std::ostream& report) const
+{
+    using general_utilities::phase_report;
+
+    parser p(filename);
+    statement::statement_block ast;
+    {
+        phase_report::scope parsing("parse", filename);
+        ast = p.create_ast();
+    }
+
+    if (_optimization_level > 0)
+    {
+        phase_report::scope optimizing("optimize");
+        optimizer opt(_optimization_level);
+        opt.optimize(ast);
+        opt.print_report(report);
+    }
+
+    return ast;
 }
 
 void cgen::generate_code(const std::string& in_filename, std::string out_filename)
 {
+    using general_utilities::phase_report;
+
+    _source_filename = in_filename;
+    const statement::statement_block ast = parse_unit(in_filename, std::cout);
+
+    {
+        phase_report::scope generating("generate");
+        generate_code(ast);
+    }
+
+    // the default output file is the input file with a '.c' extension
+    if (out_filename.empty())
+    {
+        out_filename = in_filename.substr(0, in_filename.find_last_of('.')) + ".c";
+    }
+
+    write_output(out_filename);
+}
+
+/**
+ * Compiles the units of a program together into a single C file, so that the C compiler may inline calls between them.
+ *
+ * The units are parsed and optimized in parallel, then generated one after another, in the order they were given, so
+ * that the output is the same however the work was scheduled. Every unit shares the generator's tables, so names at
+ * file scope must be unique across the program. Small functions are made `static inline` (see `gen_function_linkage`).
+ */
+void cgen::generate_program(const std::vector<std::string>& in_filenames, std::string out_filename)
+{
+    using general_utilities::phase_report;
+
+    if (in_filenames.empty())
+    {
+        throw error::compiler_exception("No units to compile");
+    }
+
+    _whole_program = true;
+
+    const size_t units = in_filenames.size();
+    std::vector<statement::statement_block> asts(units);
+    std::vector<std::string> reports(units);
+    std::vector<std::exception_ptr> errors(units);
+    {
+        phase_report::scope parsing("parse", std::to_string(units) + " units");
+
+        // each worker takes the next unit until there are none left
+        std::atomic<size_t> next_unit{0};
+        auto work = [&]()
+        {
+            for (size_t i = next_unit++; i < units; i = next_unit++)
+            {
+                try
+                {
+                    std::stringstream report;
+                    asts[i] = parse_unit(in_filenames[i], report);
+                    reports[i] = report.str();
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            }
+        };
 
+        const size_t workers = std::min<size_t>(units, std::max(1u, std::thread::hardware_concurrency()));
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < workers; w++)
+        {
+            threads.emplace_back(work);
+        }
+        for (auto& t: threads)
+        {
+            t.join();
+        }
+    }
+
+    for (size_t i = 0; i < units; i++)
+    {
+        if (errors[i])
+        {
+            std::rethrow_exception(errors[i]);
+        }
+        std::cout << reports[i];
+    }
+
+    // units that include one another are declared from the ASTs that were already parsed, and a unit that has been
+    // generated is never included again
+    for (size_t i = 0; i < units; i++)
+    {
+        _program_units[std::filesystem::path(in_filenames[i]).lexically_normal().string()] = &asts[i];
+    }
+
+    for (size_t i = 0; i < units; i++)
+    {
+        phase_report::scope generating("generate", in_filenames[i]);
+        _source_filename = in_filenames[i];
+        _included.insert(std::filesystem::path(in_filenames[i]).lexically_normal().string());
+        generate_code(asts[i]);
+    }
+    _program_units.clear();
+
+    // the default output file is named for the first unit, which is usually the one with the program's entry point
+    if (out_filename.empty())
+    {
+        out_filename = in_filenames.front().substr(0, in_filenames.front().find_last_of('.')) + ".c";
+    }
+
+    write_output(out_filename);
+}
+
+/**
+ * Writes the generated code, with the settings and headers it needs, to a file.
+ */
+void cgen::write_output(const std::string& out_filename)
+{
+    using general_utilities::phase_report;
+
+    phase_report::scope writing("write output", out_filename);
+
+    std::ofstream out(out_filename);
+    if (!out.good())
+    {
+        throw error::compiler_exception("Could not open output file '" + out_filename + "'");
+    }
+    if (_array_alignment > sin_widths::ARRAY_LENGTH_SIZE)
+    {
+        // the runtime must lay arrays out the same way the compiler did
+        out << "#define SINL_ARRAY_ALIGNMENT " << _array_alignment << "\n";
+    }
+    if (_micro)
+    {
+        // without a runtime library, failed checks can only trap
+        out << "#define SINL_ERROR_TRAP 1\n";
+    }
+    if (_profile_allocations)
+    {
+        // like the array layout, the layout of reference count headers must be the same in every file
+        out << "#define SINL_ALLOC_PROFILE 1\n";
+    }
+    // SIN's primitive types are C's fixed-width ones
+    out << "#include <stdbool.h>\n#include <stdint.h>\n";
+    for (const auto& header: _includes)
+    {
+        out << "#include \"" << header << "\"\n";
+    }
+    if (_includes.count("sinl_region.h"))
+    {
+        // the region lives in static memory so that it may be used without a runtime
+        const std::string buffer = general_utilities::constants::CONSTANT_BASE + "region_buffer";
+        out << "static unsigned char " << buffer << "[" << _region_size << "];\n";
+        out << "static struct sinl_region " << general_utilities::constants::CONSTANT_BASE << "region = { " <<
+            buffer << ", " << _region_size << ", 0 };\n";
+    }
+    out << _literals.get_definitions() << _struct_definitions.str() << _declarations.str();
+    for (const auto& prototype: _prototypes)
+    {
+        out << prototype.second;
+    }
+    out << _text.str() << _functions.str();
 }
@@ -3,9 +3,19 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <ostream>
 
 #include "../parser/statements.hpp"
 #include "common/symbol_table.hpp"
+#include "common/function_symbol.hpp"
+#include "common/constant_evaluator.hpp"
+#include "common/literal_pool.hpp"
+#include "common/struct_table.hpp"
+#include "common/profile_feedback.hpp"
+#include "../util/enumerated_types.hpp"
 
 /**
  * The code generator class.
@@ -15,11 +25,81 @@ class cgen
     bool _unsafe;
     bool _strict;
     bool _micro;
+    /**
+     * The optimization level; see `optimizer` for what each level enables.
+     */
+    unsigned int _optimization_level;
+    /**
+     * How dynamic memory is obtained.
+     */
+    enumerations::allocation_mode _allocation_mode;
+    /**
+     * The size, in bytes, of the static buffer backing the allocation region.
+     */
+    size_t _region_size;
+    /**
+     * How reference counts are updated on managed resources.
+     */
+    enumerations::refcount_mode _refcount_mode;
+    /**
+     * The alignment of array elements; no greater than the length word when arrays are packed.
+     */
+    size_t _array_alignment;
+    /**
+     * How the members of structs are laid out.
+     */
+    enumerations::struct_layout _struct_layout;
+    /**
+     * Whether functions record their calls and timings for the runtime's profiler.
+     */
+    bool _instrument;
+    /**
+     * Whether managed allocations are recorded in the runtime's allocation profile.
+     */
+    bool _profile_allocations;
+    /**
+     * Whether runtime bounds checks and reference count updates are counted, by line, for the runtime's cost counters.
+     */
+    bool _count_costs;
+    /**
+     * Used to name the sites emitted for the runtime's allocation profile and cost counters.
+     */
+    size_t _site_count;
+    /**
+     * Whether every unit of the program is being compiled into a single translation unit.
+     */
+    bool _whole_program;
+    /**
+     * The name of the file being compiled, as it appears in profiles and diagnostics.
+     */
+    std::string _source_filename;
 
     /**
      * The symbols known by the generator.
      */
     utility::symbol_table _symbols;
+    /**
+     * Evaluates constant expressions and tracks named constants.
+     */
+    utility::constant_evaluator _constants;
+    /**
+     * The string literals used by the unit, each of which is emitted once.
+     */
+    utility::literal_pool _literals;
+    /**
+     * The layouts of the structs defined in the unit.
+     */
+    utility::struct_table _structs;
+    /**
+     * The symbols that refer directly to a pooled literal, rather than having storage of their own.
+     *
+     * Note the key is a decorated name.
+     */
+    std::unordered_map<std::string, std::string> _pooled_symbols;
+    /**
+     * The profile used to mark functions hot or cold, if one was given.
+     */
+    utility::profile_feedback _profile;
     /**
      * The full nested scope name.
      */
@@ -32,15 +112,177 @@ class cgen
      * Contains the definitions for various structs defined here.
      */
     std::stringstream _struct_definitions;
+    /**
+     * Contains the declarations of data defined elsewhere.
+     */
+    std::stringstream _declarations;
+    /**
+     * The prototype of each function that has been declared, keyed by its name.
+     */
+    std::map<std::string, std::string> _prototypes;
+    /**
+     * Contains the definitions of functions, which follow everything else so that they may use it.
+     */
+    std::stringstream _functions;
+    /**
+     * The functions defined by the unit being generated; their bodies are generated once the rest of the unit has been.
+     */
+    std::vector<const statement::function_definition*> _function_definitions;
+    /**
+     * The function whose body is being generated, if any.
+     */
+    const function_symbol* _function;
+    /**
+     * Used to give each block in a function a scope name of its own.
+     */
+    size_t _block_count;
+    /**
+     * The files that have been included, each of which is only declared once.
+     */
+    std::set<std::string> _included;
+    /**
+     * The units read by `include` statements; the generator's tables refer to their nodes, so they are kept here.
+     */
+    std::vector<statement::statement_block> _included_units;
+    /**
+     * When compiling a whole program, the units of the program, keyed by filename, so that they needn't be parsed
+     * again when they are included.
+     */
+    std::map<std::string, const statement::statement_block*> _program_units;
+    /**
+     * The runtime headers the generated code needs.
+     */
+    std::set<std::string> _includes;
+    /**
+     * The scopes that have recorded their position in the allocation region, and so must reset it when they exit.
+     */
+    std::set<std::vector<std::string>> _region_scopes;
+    /**
+     * The error sites defined for runtime checks, keyed by the file and line of the checks.
+     */
+    std::map<std::pair<std::string, unsigned int>, std::string> _error_sites;
+    /**
+     * The storage types generated for `soa` arrays, each of which is defined once.
+     */
+    std::set<std::string> _soa_types;
+    /**
+     * The storage types generated for arrays, keyed by the C type of their elements and their length.
+     */
+    std::map<std::pair<std::string, size_t>, std::string> _array_types;
+    /**
+     * The storage types generated for tuples, keyed by the C types of their elements.
+     */
+    std::map<std::vector<std::string>, std::string> _tuple_types;
+    /**
+     * The element pointers hoisted out of the element-wise loop being generated, keyed by array name.
+     */
+    std::unordered_map<std::string, std::string> _element_pointers;
+    /**
+     * Used to generate names for the values hoisted out of element-wise loops.
+     */
+    size_t _element_loop_count;
 
     bool next();
 
-    void generate_code(const statement::statement_block& ast);
+    statement::statement_block parse_unit(const std::string& filename, std::ostream& report) const;
+    void write_output(const std::string& out_filename);
+    void process_statement(const statement::statement_base& s);
+    std::string get_c_name(const symbol& sym) const;
+    void evaluate_array_length(data_type& t, unsigned int line);
+    std::string gen_c_type(const data_type& t, unsigned int line);
+    std::string gen_array_type(const data_type& t, unsigned int line);
+    std::string gen_tuple_type(const data_type& t, unsigned int line);
+    std::string gen_zero_value(const data_type& t, unsigned int line);
+    std::string gen_folded_value(const expression::expression_base& exp, const data_type& t, unsigned int line);
     std::string gen_allocation(const statement::allocation& alloc);
+    std::string gen_constant_initializer(const expression::expression_base& exp, const data_type& t, unsigned int line);
+    std::string gen_statement(const statement::statement_base& s);
+    std::string gen_block(const statement::statement_block& block);
+    std::string gen_branch(const statement::statement_base& branch);
+    std::string gen_assignment(const statement::assignment& assign);
+    std::string gen_compound_assignment(const statement::compound_assignment& assign);
+    std::string gen_movement(const statement::movement& move);
+    std::string gen_store(const data_type& t, const std::string& target, const expression::expression_base& value, unsigned int line, bool add_ref = true,
+        bool in_place = true);
+    std::string gen_if_else(const statement::if_else& ite);
+    std::string gen_while_loop(const statement::while_loop& loop);
+    std::string gen_return(const statement::return_statement& ret);
+    std::string gen_expression(const expression::expression_base& exp, unsigned int line);
+    std::string gen_literal(const expression::literal& lit, unsigned int line);
+    std::string gen_identifier(const expression::identifier& ident, unsigned int line);
+    std::string gen_unary(const expression::unary& u, unsigned int line);
+    std::string gen_binary(const expression::binary& b, unsigned int line);
+    std::string gen_member(const expression::binary& b, unsigned int line);
+    std::string gen_indexed(const expression::indexed& idx, unsigned int line);
+    std::string gen_attribute(const expression::attribute_selection& attr, unsigned int line);
+    std::string gen_typecast(const expression::typecast& cast, unsigned int line);
+    std::string gen_call(const expression::procedure& call, unsigned int line);
+    std::string gen_address(const expression::expression_base& exp, unsigned int line);
+    bool is_lvalue(const expression::expression_base& exp, unsigned int line);
+    bool holds_storage(const expression::expression_base& exp, unsigned int line);
+    void check_assignment(const expression::expression_base& lvalue, unsigned int line);
+    static const char* get_c_operator(enumerations::exp_operator op);
+    std::string gen_array_element(const expression::expression_base& array, const data_type& t, const std::string& index, unsigned int line);
+    std::string gen_array_length(const expression::expression_base& array, const data_type& t, unsigned int line);
+    data_type get_expression_type(const expression::expression_base& exp, unsigned int line);
+    const symbol& find_symbol(const std::string& name, unsigned int line) const;
+    const function_symbol& find_function(const expression::expression_base& name, unsigned int line) const;
+    const function_symbol& add_function(const std::string& name, const data_type& return_type, const std::vector<const statement::statement_base*>& parameters, bool defined, unsigned int line);
+    std::string gen_function_signature(const function_symbol& func, unsigned int line);
+    void declare_function(const statement::function_definition& def, bool defined);
+    std::string gen_function_definition(const statement::function_definition& def);
+    void gen_declaration(const statement::declaration& decl);
+    void gen_include(const statement::include& inc, const std::string& from);
+    void declare_unit(const statement::statement_block& unit, const std::string& filename);
+    std::string gen_dynamic_allocation(const data_type& t, std::stringstream& code, unsigned int line);
+    std::string gen_dynamic_array_init(const data_type& t, const std::string& name, const std::string& value, unsigned int line);
+    std::string gen_scope_exit(unsigned int line);
+    std::string gen_function_exit(unsigned int line);
+    std::string gen_release_locals(const std::vector<const symbol*>& locals, unsigned int line);
+    bool is_counted(const data_type& t) const;
+    void check_counted_value(const expression::expression_base& value, unsigned int line);
+    std::string gen_add_ref(const std::string& resource, unsigned int line);
+    std::string gen_release(const std::string& resource, unsigned int line);
+    std::string gen_element_loop_preheader(const statement::while_loop& loop);
+    std::string gen_element_loop(const statement::while_loop& loop, const std::string& bound, const std::string& body);
+    std::string gen_element_access(const std::string& array, const std::string& index) const;
+    std::string gen_error_site(unsigned int line);
+    std::string gen_bounds_check(const expression::indexed& idx, const std::string& array, const std::string& index, unsigned int line);
+    std::string gen_null_check(const std::string& pointer, unsigned int line);
+    std::string gen_struct_definition(const statement::struct_definition& def);
+    std::string gen_soa_type(const data_type& t, unsigned int line);
+    std::string gen_indexed_member(const std::string& array, const data_type& t, const std::string& index, const std::string& member) const;
+    std::string gen_profile_enter(const statement::function_definition& def);
+    std::string gen_profile_exit() const;
+    std::string gen_cost_counter(const std::string& kind, unsigned int line, const std::string& count = "1");
+    std::string gen_function_attributes(const statement::function_definition& def);
+    std::string gen_function_linkage(const statement::function_definition& def) const;
+    void order_functions(std::vector<const statement::function_definition*>& functions) const;
 
 public:
+    static constexpr size_t DEFAULT_REGION_SIZE = 1024 * 1024;
+    /**
+     * The most statements a function may have and still be made `static inline` when compiling a whole program.
+     */
+    static constexpr size_t INLINE_STATEMENT_LIMIT = 8;
+
     void generate_code(const std::string& in_filename, std::string out_filename);
+    /**
+     * Generates code for an AST that has already been parsed (and optimized, if it is to be), without writing it out.
+     */
+    void generate_code(const statement::statement_block& ast);
+    void generate_program(const std::vector<std::string>& in_filenames, std::string out_filename);
+
+    void set_allocation_mode(enumerations::allocation_mode mode);
+    void set_region_size(size_t size);
+    void set_refcount_mode(enumerations::refcount_mode mode);
+    void set_array_alignment(size_t alignment);
+    void set_struct_layout(enumerations::struct_layout layout);
+    void set_instrumentation(bool instrument);
+    void set_allocation_profiling(bool profile);
+    void set_cost_counters(bool count);
+    void set_profile_feedback(const std::string& filename);
 
-    cgen(bool allow_unsafe, bool use_strict, bool use_micro);
+    cgen(bool allow_unsafe, bool use_strict, bool use_micro, unsigned int optimization_level = 0);
     ~cgen();
 };
@@ -0,0 +1,1047 @@
+#include "constant_evaluator.hpp"
+
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <limits>
+
+namespace utility
+{
+    bool constant_value::is_integral() const
+    {
+        return type.get_primary() == enumerations::primitive_type::INT ||
+            type.get_primary() == enumerations::primitive_type::CHAR;
+    }
+
+    bool constant_value::is_negative() const
+    {
+        if (type.get_primary() == enumerations::primitive_type::FLOAT)
+        {
+            return floating < 0;
+        }
+        else if (is_integral())
+        {
+            return type.get_qualities().is_signed() && as_signed() < 0;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    std::string constant_value::to_c_literal() const
+    {
+        using enumerations::primitive_type;
+
+        std::stringstream literal;
+
+        switch (type.get_primary())
+        {
+        case primitive_type::INT:
+        {
+            if (type.get_qualities().is_signed())
+            {
+                // the most negative value can't be written directly as a literal in C
+                if (type.get_width() == sin_widths::LONG_WIDTH && as_signed() == std::numeric_limits<int64_t>::min())
+                {
+                    literal << "(-9223372036854775807LL - 1)";
+                }
+                else
+                {
+                    literal << as_signed();
+                    if (type.get_width() == sin_widths::LONG_WIDTH)
+                        literal << "LL";
+                }
+            }
+            else
+            {
+                literal << integer << "U";
+                if (type.get_width() == sin_widths::LONG_WIDTH)
+                    literal << "LL";
+            }
+            break;
+        }
+        case primitive_type::CHAR:
+        {
+            literal << "((char)" << integer << ")";
+            break;
+        }
+        case primitive_type::FLOAT:
+        {
+            // use hexadecimal floats so that no precision is lost
+            if (std::isnan(floating))
+            {
+                literal << "(0.0 / 0.0)";
+            }
+            else if (std::isinf(floating))
+            {
+                literal << (floating < 0 ? "(-1.0 / 0.0)" : "(1.0 / 0.0)");
+            }
+            else
+            {
+                literal << std::hexfloat << floating;
+            }
+
+            if (type.get_width() == sin_widths::FLOAT_WIDTH && std::isfinite(floating))
+                literal << "f";
+            break;
+        }
+        case primitive_type::BOOL:
+        {
+            literal << (boolean ? "true" : "false");
+            break;
+        }
+        case primitive_type::STRING:
+        {
+            literal << '"';
+            for (char ch: string)
+            {
+                if (ch == '"' || ch == '\\')
+                {
+                    literal << '\\' << ch;
+                }
+                else if (ch == '\n')
+                {
+                    literal << "\\n";
+                }
+                else if (ch == '\t')
+                {
+                    literal << "\\t";
+                }
+                else if (static_cast<unsigned char>(ch) < 0x20 || static_cast<unsigned char>(ch) >= 0x7f)
+                {
+                    // octal escapes can't run into the following character like hex escapes can
+                    literal << '\\' << std::oct << std::setw(3) << std::setfill('0')
+                        << static_cast<unsigned int>(static_cast<unsigned char>(ch))
+                        << std::dec;
+                }
+                else
+                {
+                    literal << ch;
+                }
+            }
+            literal << '"';
+            break;
+        }
+        default:
+            throw error::type_error(0);
+        }
+
+        return literal.str();
+    }
+
+    std::unique_ptr<expression::literal> constant_value::to_literal() const
+    {
+        using enumerations::primitive_type;
+
+        std::stringstream value;
+        switch (type.get_primary())
+        {
+        case primitive_type::INT:
+            if (type.get_qualities().is_signed())
+                value << as_signed();
+            else
+                value << integer;
+            break;
+        case primitive_type::CHAR:
+            value << static_cast<char>(integer);
+            break;
+        case primitive_type::FLOAT:
+            value << std::setprecision(std::numeric_limits<double>::max_digits10) << floating;
+            break;
+        case primitive_type::BOOL:
+            value << (boolean ? "true" : "false");
+            break;
+        case primitive_type::STRING:
+            value << string;
+            break;
+        default:
+            throw error::type_error(0);
+        }
+
+        auto lit = std::make_unique<expression::literal>(type, value.str());
+        lit->set_const();
+        return lit;
+    }
+
+    constant_value::constant_value(const data_type& type)
+        : type(type)
+        , integer(0)
+        , floating(0)
+        , boolean(false) { }
+
+    constant_value::constant_value()
+        : constant_value(data_type()) { }
+
+    uint64_t constant_evaluator::truncate(uint64_t value, const data_type& t)
+    {
+        size_t bits = t.get_width() * 8;
+        if (bits == 0 || bits >= 64)
+            return value;
+
+        uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+        value &= mask;
+
+        // sign-extend so that the value may be read as an int64_t
+        if (t.get_primary() == enumerations::primitive_type::INT &&
+            t.get_qualities().is_signed() &&
+            (value >> (bits - 1)) & 1)
+        {
+            value |= ~mask;
+        }
+
+        return value;
+    }
+
+    data_type constant_evaluator::integral_type(size_t width, bool is_signed)
+    {
+        symbol_qualities q(
+            true,
+            false,
+            false,
+            is_signed,
+            width == sin_widths::LONG_WIDTH,
+            width == sin_widths::SHORT_WIDTH
+        );
+        if (!is_signed)
+            q.add_quality(enumerations::symbol_quality::UNSIGNED);
+
+        return data_type(enumerations::primitive_type::INT, data_type(), q);
+    }
+
+    std::string constant_evaluator::qualify(const std::string& name, const std::vector<std::string>& scope, size_t depth)
+    {
+        std::stringstream qualified;
+        for (size_t i = 0; i < depth && i < scope.size(); i++)
+        {
+            qualified << scope[i] << "::";
+        }
+        qualified << name;
+
+        return qualified.str();
+    }
+
+    void constant_evaluator::add_constant(  const std::string& name,
+                                            const std::vector<std::string>& scope,
+                                            const data_type& type,
+                                            const expression::expression_base* initializer )
+    {
+        named_constant c;
+        c.type = type;
+        c.initializer = initializer;
+        c.value = nullptr;
+        c.evaluating = false;
+
+        _constants[qualify(name, scope, scope.size())] = std::move(c);
+    }
+
+    bool constant_evaluator::is_constant(const std::string& name, const std::vector<std::string>& scope) const
+    {
+        for (size_t depth = scope.size() + 1; depth > 0; depth--)
+        {
+            if (_constants.count(qualify(name, scope, depth - 1)))
+                return true;
+        }
+
+        return false;
+    }
+
+    const constant_value& constant_evaluator::evaluate( const expression::expression_base& exp,
+                                                        const std::vector<std::string>& scope,
+                                                        unsigned int line )
+    {
+        using enumerations::expression_type;
+
+        auto it = _results.find(&exp);
+        if (it != _results.end())
+            return it->second;
+
+        constant_value result;
+        switch (exp.get_expression_type())
+        {
+        case expression_type::LITERAL:
+            result = evaluate_literal(static_cast<const expression::literal&>(exp), line);
+            break;
+        case expression_type::IDENTIFIER:
+            result = evaluate_identifier(static_cast<const expression::identifier&>(exp), scope, line);
+            break;
+        case expression_type::UNARY:
+            result = evaluate_unary(static_cast<const expression::unary&>(exp), scope, line);
+            break;
+        case expression_type::BINARY:
+            result = evaluate_binary(static_cast<const expression::binary&>(exp), scope, line);
+            break;
+        case expression_type::CAST:
+            result = evaluate_typecast(static_cast<const expression::typecast&>(exp), scope, line);
+            break;
+        case expression_type::ATTRIBUTE:
+            result = evaluate_attribute(static_cast<const expression::attribute_selection&>(exp), line);
+            break;
+        default:
+            throw error::compiler_exception(
+                "Expression cannot be evaluated at compile time",
+                error_code::NON_CONST_VALUE_ERROR,
+                line
+            );
+        }
+
+        return _results.insert(std::make_pair<>(&exp, result)).first->second;
+    }
+
+    bool constant_evaluator::can_evaluate(  const expression::expression_base& exp,
+                                            const std::vector<std::string>& scope )
+    {
+        try
+        {
+            evaluate(exp, scope);
+            return true;
+        }
+        catch (error::compiler_exception& e)
+        {
+            return false;
+        }
+    }
+
+    void constant_evaluator::forget(const expression::expression_base& exp)
+    {
+        using enumerations::expression_type;
+
+        _results.erase(&exp);
+        switch (exp.get_expression_type())
+        {
+        case expression_type::UNARY:
+            forget(static_cast<const expression::unary&>(exp).get_operand());
+            break;
+        case expression_type::BINARY:
+        {
+            auto& b = static_cast<const expression::binary&>(exp);
+            forget(b.get_left());
+            forget(b.get_right());
+            break;
+        }
+        case expression_type::CAST:
+            forget(static_cast<const expression::typecast&>(exp).get_exp());
+            break;
+        case expression_type::ATTRIBUTE:
+            forget(static_cast<const expression::attribute_selection&>(exp).get_selected());
+            break;
+        default:
+            break;
+        }
+    }
+
+    constant_value constant_evaluator::evaluate_literal(const expression::literal& exp, unsigned int line) const
+    {
+        using enumerations::primitive_type;
+
+        constant_value v(exp.get_data_type());
+        v.type.add_quality(enumerations::symbol_quality::CONSTANT);
+
+        try
+        {
+            switch (v.type.get_primary())
+            {
+            case primitive_type::INT:
+            {
+                // negative values only come from folding, which writes them with a sign
+                if (!exp.get_value().empty() && exp.get_value()[0] == '-')
+                {
+                    const int64_t parsed = std::stoll(exp.get_value());
+                    v.integer = truncate(static_cast<uint64_t>(parsed), v.type);
+                    if (!v.type.get_qualities().is_signed() || v.as_signed() != parsed)
+                    {
+                        error::compiler_warning(
+                            "Integer literal is too large for its type and will be truncated",
+                            error_code::POTENTIAL_DATA_LOSS,
+                            line
+                        );
+                    }
+                    break;
+                }
+
+                // literals are read as unsigned so that the full range of 'unsigned long int' is available
+                uint64_t parsed = std::stoull(exp.get_value());
+                if (v.type.get_qualities().is_signed() && parsed > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+                {
+                    error::compiler_warning(
+                        "Integer literal is too large for its type and will be truncated",
+                        error_code::POTENTIAL_DATA_LOSS,
+                        line
+                    );
+                }
+
+                v.integer = truncate(parsed, v.type);
+                if (v.integer != parsed && !(v.type.get_qualities().is_signed() && v.as_signed() == static_cast<int64_t>(parsed)))
+                {
+                    error::compiler_warning(
+                        "Integer literal is too large for its type and will be truncated",
+                        error_code::POTENTIAL_DATA_LOSS,
+                        line
+                    );
+                }
+                break;
+            }
+            case primitive_type::FLOAT:
+            {
+                v.floating = std::stod(exp.get_value());
+                if (v.type.get_width() == sin_widths::FLOAT_WIDTH)
+                    v.floating = static_cast<float>(v.floating);
+                break;
+            }
+            case primitive_type::BOOL:
+            {
+                v.boolean = exp.get_value() == "true";
+                break;
+            }
+            case primitive_type::CHAR:
+            {
+                v.integer = exp.get_value().empty() ? 0 : static_cast<unsigned char>(exp.get_value()[0]);
+                break;
+            }
+            case primitive_type::STRING:
+            {
+                v.string = exp.get_value();
+                break;
+            }
+            default:
+                throw error::type_error(line);
+            }
+        }
+        catch (std::logic_error& e)
+        {
+            // std::stoll, std::stoull and std::stod throw invalid_argument and out_of_range
+            throw error::compiler_exception(
+                "Invalid literal '" + exp.get_value() + "'",
+                error_code::BAD_LITERAL,
+                line
+            );
+        }
+
+        return v;
+    }
+
+    constant_value constant_evaluator::evaluate_identifier( const expression::identifier& exp,
+                                                            const std::vector<std::string>& scope,
+                                                            unsigned int line )
+    {
+        // search from the innermost scope outward
+        for (size_t depth = scope.size() + 1; depth > 0; depth--)
+        {
+            auto it = _constants.find(qualify(exp.getValue(), scope, depth - 1));
+            if (it == _constants.end())
+                continue;
+
+            named_constant& c = it->second;
+            if (!c.value)
+            {
+                if (c.evaluating)
+                {
+                    throw error::compiler_exception(
+                        "Constant '" + exp.getValue() + "' is defined in terms of itself",
+                        error_code::NON_CONST_VALUE_ERROR,
+                        line
+                    );
+                }
+                else if (!c.initializer)
+                {
+                    throw error::referenced_before_initialization(exp.getValue(), line);
+                }
+
+                // the initializer belongs to the scope in which the constant was allocated
+                std::vector<std::string> constant_scope(scope.begin(), scope.begin() + (depth - 1));
+
+                c.evaluating = true;
+                try
+                {
+                    constant_value v = evaluate(*c.initializer, constant_scope, line);
+
+                    // the value takes on the declared type of the constant, as it does when the constant is allocated
+                    if (c.type.get_primary() == enumerations::primitive_type::STRING)
+                    {
+                        if (v.type.get_primary() != enumerations::primitive_type::STRING &&
+                            v.type.get_primary() != enumerations::primitive_type::CHAR)
+                        {
+                            throw error::type_error(line);
+                        }
+                    }
+                    else
+                    {
+                        // the allocation has already warned if the value doesn't fit
+                        bool exact;
+                        v = convert(v, c.type, exact, line);
+                    }
+
+                    v.type = c.type;
+                    c.value = std::make_unique<constant_value>(v);
+                }
+                catch (...)
+                {
+                    c.evaluating = false;
+                    throw;
+                }
+                c.evaluating = false;
+            }
+
+            return *c.value;
+        }
+
+        throw error::compiler_exception(
+            "'" + exp.getValue() + "' is not a compile-time constant",
+            error_code::NON_CONST_VALUE_ERROR,
+            line
+        );
+    }
+
+    constant_value constant_evaluator::evaluate_unary(  const expression::unary& exp,
+                                                        const std::vector<std::string>& scope,
+                                                        unsigned int line )
+    {
+        using enumerations::exp_operator;
+        using enumerations::primitive_type;
+
+        constant_value v = evaluate(exp.get_operand(), scope, line);
+
+        switch (exp.get_operator())
+        {
+        case exp_operator::UNARY_PLUS:
+        {
+            if (v.type.get_primary() != primitive_type::INT && v.type.get_primary() != primitive_type::FLOAT)
+                throw error::compiler_exception("Unary plus is not defined for this type", error_code::UNARY_TYPE_NOT_SUPPORTED, line);
+            break;
+        }
+        case exp_operator::UNARY_MINUS:
+        {
+            if (v.type.get_primary() == primitive_type::FLOAT)
+            {
+                v.floating = -v.floating;
+            }
+            else if (v.type.get_primary() == primitive_type::INT)
+            {
+                if (!v.type.get_qualities().is_signed())
+                {
+                    error::compiler_warning(
+                        "Unary minus applied to an unsigned value",
+                        error_code::SIGNED_UNSIGNED_MISMATCH,
+                        line
+                    );
+                }
+                v.integer = truncate(~v.integer + 1, v.type);
+            }
+            else
+            {
+                throw error::compiler_exception("Unary minus is not defined for this type", error_code::UNARY_TYPE_NOT_SUPPORTED, line);
+            }
+            break;
+        }
+        case exp_operator::NOT:
+        {
+            if (v.type.get_primary() != primitive_type::BOOL)
+                throw error::compiler_exception("Logical not is only defined for 'bool'", error_code::UNARY_TYPE_NOT_SUPPORTED, line);
+
+            v.boolean = !v.boolean;
+            break;
+        }
+        case exp_operator::BIT_NOT:
+        {
+            if (v.type.get_primary() != primitive_type::INT)
+                throw error::compiler_exception("Bitwise not is only defined for integral types", error_code::UNARY_TYPE_NOT_SUPPORTED, line);
+
+            v.integer = truncate(~v.integer, v.type);
+            break;
+        }
+        default:
+            throw error::compiler_exception(
+                "Expression cannot be evaluated at compile time",
+                error_code::NON_CONST_VALUE_ERROR,
+                line
+            );
+        }
+
+        return v;
+    }
+
+    constant_value constant_evaluator::evaluate_binary( const expression::binary& exp,
+                                                        const std::vector<std::string>& scope,
+                                                        unsigned int line )
+    {
+        using enumerations::exp_operator;
+        using enumerations::primitive_type;
+
+        constant_value left = evaluate(exp.get_left(), scope, line);
+        constant_value right = evaluate(exp.get_right(), scope, line);
+        exp_operator op = exp.get_operator();
+
+        // strings may be concatenated with chars; everything else requires matching types
+        if (left.type.get_primary() == primitive_type::STRING &&
+            (right.type.get_primary() == primitive_type::STRING || right.type.get_primary() == primitive_type::CHAR))
+        {
+            std::string r = right.type.get_primary() == primitive_type::CHAR ? std::string(1, static_cast<char>(right.integer)) : right.string;
+            constant_value v(left.type);
+            if (op == exp_operator::PLUS)
+            {
+                v.string = left.string + r;
+            }
+            else if (op == exp_operator::EQUAL || op == exp_operator::NOT_EQUAL)
+            {
+                v = constant_value(data_type(primitive_type::BOOL));
+                v.boolean = (left.string == r) == (op == exp_operator::EQUAL);
+            }
+            else
+            {
+                throw error::undefined_operator("string", line);
+            }
+
+            v.type.add_quality(enumerations::symbol_quality::CONSTANT);
+            return v;
+        }
+        else if (left.type.get_primary() != right.type.get_primary())
+        {
+            throw error::type_error(line);
+        }
+
+        switch (left.type.get_primary())
+        {
+        case primitive_type::INT:
+        case primitive_type::CHAR:
+            return integer_binary(op, left, right, line);
+        case primitive_type::FLOAT:
+            return floating_binary(op, left, right, line);
+        case primitive_type::BOOL:
+        {
+            constant_value v(data_type(primitive_type::BOOL));
+            v.type.add_quality(enumerations::symbol_quality::CONSTANT);
+            switch (op)
+            {
+            case exp_operator::AND:
+                v.boolean = left.boolean && right.boolean;
+                break;
+            case exp_operator::OR:
+                v.boolean = left.boolean || right.boolean;
+                break;
+            case exp_operator::XOR:
+            case exp_operator::NOT_EQUAL:
+                v.boolean = left.boolean != right.boolean;
+                break;
+            case exp_operator::EQUAL:
+                v.boolean = left.boolean == right.boolean;
+                break;
+            default:
+                throw error::undefined_operator("bool", line);
+            }
+            return v;
+        }
+        default:
+            throw error::compiler_exception(
+                "Expression cannot be evaluated at compile time",
+                error_code::NON_CONST_VALUE_ERROR,
+                line
+            );
+        }
+    }
+
+    constant_value constant_evaluator::integer_binary(  enumerations::exp_operator op,
+                                                        const constant_value& left,
+                                                        const constant_value& right,
+                                                        unsigned int line )
+    {
+        using enumerations::exp_operator;
+
+        // SIN doesn't perform implicit conversions; mismatches are warnings, and the wider type wins
+        // the type of a shift is always the type of its left operand
+        const bool is_shift = op == exp_operator::LEFT_SHIFT || op == exp_operator::RIGHT_SHIFT;
+        const bool is_signed = left.type.get_qualities().is_signed();
+        if (!is_shift && is_signed != right.type.get_qualities().is_signed())
+        {
+            error::compiler_warning(
+                "Signed/unsigned mismatch in constant expression",
+                error_code::SIGNED_UNSIGNED_MISMATCH,
+                line
+            );
+        }
+
+        size_t width = left.type.get_width();
+        if (!is_shift && width != right.type.get_width())
+        {
+            error::compiler_warning(
+                "Width mismatch in constant expression",
+                error_code::WIDTH_MISMATCH,
+                line
+            );
+            width = std::max(width, right.type.get_width());
+        }
+
+        data_type result_type = left.type.get_primary() == enumerations::primitive_type::CHAR ?
+            left.type :
+            integral_type(width, is_signed);
+        result_type.add_quality(enumerations::symbol_quality::CONSTANT);
+        const size_t bits = result_type.get_width() * 8;
+
+        constant_value v(result_type);
+        const uint64_t l = left.integer;
+        const uint64_t r = right.integer;
+        const int64_t sl = left.as_signed();
+        const int64_t sr = right.as_signed();
+
+        // comparisons yield 'bool'
+        constant_value b(data_type(enumerations::primitive_type::BOOL));
+        b.type.add_quality(enumerations::symbol_quality::CONSTANT);
+
+        switch (op)
+        {
+        case exp_operator::PLUS:
+        case exp_operator::MINUS:
+        case exp_operator::MULT:
+        {
+            // arithmetic wraps, like it does at runtime; signed overflow is worth a warning
+            int64_t exact;
+            bool overflow = false;
+            if (op == exp_operator::PLUS)
+            {
+                v.integer = l + r;
+                overflow = __builtin_add_overflow(sl, sr, &exact);
+            }
+            else if (op == exp_operator::MINUS)
+            {
+                v.integer = l - r;
+                overflow = __builtin_sub_overflow(sl, sr, &exact);
+            }
+            else
+            {
+                v.integer = l * r;
+                overflow = __builtin_mul_overflow(sl, sr, &exact);
+            }
+
+            v.integer = truncate(v.integer, result_type);
+            if (is_signed && (overflow || v.as_signed() != exact))
+            {
+                error::compiler_warning(
+                    "Signed overflow in constant expression; the result will wrap",
+                    error_code::POTENTIAL_DATA_LOSS,
+                    line
+                );
+            }
+            return v;
+        }
+        case exp_operator::DIV:
+        case exp_operator::MODULO:
+        {
+            if (r == 0)
+            {
+                throw error::compiler_exception(
+                    "Division by zero in constant expression",
+                    error_code::DIVISION_BY_ZERO,
+                    line
+                );
+            }
+
+            if (is_signed)
+            {
+                // the most negative value divided by -1 wraps back to itself
+                if (sr == -1)
+                    v.integer = op == exp_operator::DIV ? ~l + 1 : 0;
+                else
+                    v.integer = static_cast<uint64_t>(op == exp_operator::DIV ? sl / sr : sl % sr);
+            }
+            else
+            {
+                v.integer = op == exp_operator::DIV ? l / r : l % r;
+            }
+
+            v.integer = truncate(v.integer, result_type);
+            return v;
+        }
+        case exp_operator::BIT_AND:
+            v.integer = truncate(l & r, result_type);
+            return v;
+        case exp_operator::BIT_OR:
+            v.integer = truncate(l | r, result_type);
+            return v;
+        case exp_operator::BIT_XOR:
+            v.integer = truncate(l ^ r, result_type);
+            return v;
+        case exp_operator::LEFT_SHIFT:
+        case exp_operator::RIGHT_SHIFT:
+        {
+            if (right.is_negative())
+            {
+                throw error::compiler_exception(
+                    "Shift by a negative amount in constant expression",
+                    error_code::ILLEGAL_OPERATION_ERROR,
+                    line
+                );
+            }
+            else if (r >= bits)
+            {
+                error::compiler_warning(
+                    "Shift amount is greater than or equal to the width of the type",
+                    error_code::BITSHIFT_RESULT,
+                    line
+                );
+                v.integer = (op == exp_operator::RIGHT_SHIFT && is_signed && sl < 0) ? ~static_cast<uint64_t>(0) : 0;
+            }
+            else if (op == exp_operator::LEFT_SHIFT)
+            {
+                v.integer = l << r;
+            }
+            else
+            {
+                // right shifts are arithmetic for signed types
+                v.integer = is_signed ? static_cast<uint64_t>(sl >> r) : (l >> r);
+            }
+
+            v.integer = truncate(v.integer, result_type);
+            return v;
+        }
+        case exp_operator::EQUAL:
+            b.boolean = l == r;
+            return b;
+        case exp_operator::NOT_EQUAL:
+            b.boolean = l != r;
+            return b;
+        case exp_operator::LESS:
+            b.boolean = is_signed ? sl < sr : l < r;
+            return b;
+        case exp_operator::LESS_OR_EQUAL:
+            b.boolean = is_signed ? sl <= sr : l <= r;
+            return b;
+        case exp_operator::GREATER:
+            b.boolean = is_signed ? sl > sr : l > r;
+            return b;
+        case exp_operator::GREATER_OR_EQUAL:
+            b.boolean = is_signed ? sl >= sr : l >= r;
+            return b;
+        default:
+            throw error::undefined_operator("int", line);
+        }
+    }
+
+    constant_value constant_evaluator::floating_binary( enumerations::exp_operator op,
+                                                        const constant_value& left,
+                                                        const constant_value& right,
+                                                        unsigned int line )
+    {
+        using enumerations::exp_operator;
+
+        data_type result_type = left.type;
+        if (left.type.get_width() != right.type.get_width())
+        {
+            error::compiler_warning(
+                "Width mismatch in constant expression",
+                error_code::WIDTH_MISMATCH,
+                line
+            );
+            if (right.type.get_width() > left.type.get_width())
+                result_type = right.type;
+        }
+
+        constant_value v(result_type);
+        constant_value b(data_type(enumerations::primitive_type::BOOL));
+        b.type.add_quality(enumerations::symbol_quality::CONSTANT);
+
+        switch (op)
+        {
+        case exp_operator::PLUS:
+            v.floating = left.floating + right.floating;
+            break;
+        case exp_operator::MINUS:
+            v.floating = left.floating - right.floating;
+            break;
+        case exp_operator::MULT:
+            v.floating = left.floating * right.floating;
+            break;
+        case exp_operator::DIV:
+            v.floating = left.floating / right.floating;
+            break;
+        case exp_operator::EQUAL:
+            b.boolean = left.floating == right.floating;
+            return b;
+        case exp_operator::NOT_EQUAL:
+            b.boolean = left.floating != right.floating;
+            return b;
+        case exp_operator::LESS:
+            b.boolean = left.floating < right.floating;
+            return b;
+        case exp_operator::LESS_OR_EQUAL:
+            b.boolean = left.floating <= right.floating;
+            return b;
+        case exp_operator::GREATER:
+            b.boolean = left.floating > right.floating;
+            return b;
+        case exp_operator::GREATER_OR_EQUAL:
+            b.boolean = left.floating >= right.floating;
+            return b;
+        default:
+            throw error::undefined_operator("float", line);
+        }
+
+        // single-precision results must be rounded like they would be at runtime
+        if (result_type.get_width() == sin_widths::FLOAT_WIDTH)
+            v.floating = static_cast<float>(v.floating);
+
+        return v;
+    }
+
+    constant_value constant_evaluator::evaluate_typecast(   const expression::typecast& exp,
+                                                            const std::vector<std::string>& scope,
+                                                            unsigned int line )
+    {
+        return cast(evaluate(exp.get_exp(), scope, line), exp.get_new_type(), line);
+    }
+
+    constant_value constant_evaluator::cast(const constant_value& from, const data_type& t, unsigned int line)
+    {
+        using enumerations::primitive_type;
+
+        data_type to_type = t;
+        to_type.add_quality(enumerations::symbol_quality::CONSTANT);
+        constant_value v(to_type);
+
+        const primitive_type from_primary = from.type.get_primary();
+        switch (to_type.get_primary())
+        {
+        case primitive_type::INT:
+        case primitive_type::CHAR:
+        {
+            if (from.is_integral())
+            {
+                v.integer = truncate(from.integer, to_type);
+            }
+            else if (from_primary == primitive_type::BOOL)
+            {
+                v.integer = from.boolean ? 1 : 0;
+            }
+            else if (from_primary == primitive_type::FLOAT)
+            {
+                // float-to-integer conversions truncate toward zero; out-of-range values are an error
+                double truncated = std::trunc(from.floating);
+                if (std::isnan(truncated) || truncated < -9223372036854775808.0 || truncated >= 18446744073709551616.0 ||
+                    (to_type.get_qualities().is_signed() && truncated >= 9223372036854775808.0))
+                {
+                    throw error::compiler_exception(
+                        "Floating-point value is out of range for the target type",
+                        error_code::INVALID_CAST_ERROR,
+                        line
+                    );
+                }
+
+                uint64_t raw = truncated < 0 ? static_cast<uint64_t>(static_cast<int64_t>(truncated)) : static_cast<uint64_t>(truncated);
+                v.integer = truncate(raw, to_type);
+            }
+            else
+            {
+                throw error::illegal_typecast(line);
+            }
+            break;
+        }
+        case primitive_type::FLOAT:
+        {
+            if (from.is_integral())
+                v.floating = from.type.get_qualities().is_signed() ? static_cast<double>(from.as_signed()) : static_cast<double>(from.integer);
+            else if (from_primary == primitive_type::FLOAT)
+                v.floating = from.floating;
+            else if (from_primary == primitive_type::BOOL)
+                v.floating = from.boolean ? 1.0 : 0.0;
+            else
+                throw error::illegal_typecast(line);
+
+            if (to_type.get_width() == sin_widths::FLOAT_WIDTH)
+                v.floating = static_cast<float>(v.floating);
+            break;
+        }
+        case primitive_type::BOOL:
+        {
+            if (from.is_integral())
+                v.boolean = from.integer != 0;
+            else if (from_primary == primitive_type::FLOAT)
+                v.boolean = from.floating != 0;
+            else if (from_primary == primitive_type::BOOL)
+                v.boolean = from.boolean;
+            else
+                throw error::illegal_typecast(line);
+            break;
+        }
+        default:
+            // conversions to strings and other types are left to the runtime
+            throw error::compiler_exception(
+                "Expression cannot be evaluated at compile time",
+                error_code::NON_CONST_VALUE_ERROR,
+                line
+            );
+        }
+
+        return v;
+    }
+
+    constant_value constant_evaluator::convert(const constant_value& from, const data_type& t, bool& exact, unsigned int line)
+    {
+        using enumerations::primitive_type;
+
+        // SIN has no implicit conversions between booleans and numbers
+        if ((from.type.get_primary() == primitive_type::BOOL) != (t.get_primary() == primitive_type::BOOL))
+        {
+            throw error::type_error(line);
+        }
+
+        constant_value v = cast(from, t, line);
+        switch (t.get_primary())
+        {
+        case primitive_type::INT:
+        case primitive_type::CHAR:
+        {
+            if (from.type.get_primary() == primitive_type::FLOAT)
+            {
+                exact = std::trunc(from.floating) == from.floating;
+            }
+            else
+            {
+                // the value survives if it has the same sign and bits once both are extended to 64 bits
+                const bool to_signed = t.get_primary() == primitive_type::INT && t.get_qualities().is_signed();
+                exact = v.integer == from.integer && from.is_negative() == (to_signed && v.as_signed() < 0);
+            }
+            break;
+        }
+        case primitive_type::FLOAT:
+        {
+            if (from.is_integral())
+            {
+                const long double original = from.is_negative() ?
+                    static_cast<long double>(from.as_signed()) :
+                    static_cast<long double>(from.integer);
+                exact = static_cast<long double>(v.floating) == original;
+            }
+            else
+            {
+                exact = v.floating == from.floating || (std::isnan(v.floating) && std::isnan(from.floating));
+            }
+            break;
+        }
+        default:
+            exact = true;
+            break;
+        }
+
+        return v;
+    }
+
+    constant_value constant_evaluator::evaluate_attribute(const expression::attribute_selection& exp, unsigned int line)
+    {
+        // only the sizes of types are known at this stage; the lengths of objects are left to the runtime
+        if (exp.get_attribute() == enumerations::attribute::SIZE &&
+            exp.get_selected().get_expression_type() == enumerations::expression_type::KEYWORD_EXP)
+        {
+            auto& kw = static_cast<const expression::keyword&>(exp.get_selected());
+            if (kw.get_type().get_width() != 0)
+            {
+                constant_value v(integral_type(sin_widths::INT_WIDTH, false));
+                v.integer = kw.get_type().get_width();
+                return v;
+            }
+        }
+
+        throw error::compiler_exception(
+            "Attribute cannot be evaluated at compile time",
+            error_code::NON_CONST_VALUE_ERROR,
+            line
+        );
+    }
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../../util/data_type.hpp"
+#include "../../parser/expressions.hpp"
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cinttypes>
+
+namespace utility
+{
+    /**
+     * A value known at compile time.
+     *
+     * Integral values (including `char`) are stored in `integer`, already truncated to the width of `type`.
+     * Signed values are sign-extended to 64 bits so that `as_signed` returns the correct value.
+     */
+    struct constant_value
+    {
+        data_type type;
+
+        uint64_t integer;
+        double floating;
+        bool boolean;
+        std::string string;
+
+        int64_t as_signed() const { return static_cast<int64_t>(integer); }
+        bool is_integral() const;
+        bool is_negative() const;
+
+        /**
+         * Gets the literal used in the generated C for this value.
+         */
+        std::string to_c_literal() const;
+        /**
+         * Creates a literal expression that holds this value.
+         */
+        std::unique_ptr<expression::literal> to_literal() const;
+
+        constant_value(const data_type& type);
+        constant_value();
+    };
+
+    /**
+     * Evaluates `constexpr` expressions at compile time.
+     *
+     * Results are memoised per expression node and per named constant, so an expression will only ever be evaluated once.
+     * This means that the nodes given to the evaluator must outlive it (or be removed with `forget`).
+     */
+    class constant_evaluator
+    {
+        struct named_constant
+        {
+            data_type type;
+            const expression::expression_base* initializer;
+            std::unique_ptr<constant_value> value;
+            bool evaluating;
+        };
+
+        /**
+         * Results for expression nodes we have already evaluated.
+         */
+        std::unordered_map<const expression::expression_base*, constant_value> _results;
+        /**
+         * The named constants we know about.
+         *
+         * Note the key is the name qualified by its full scope.
+         */
+        std::unordered_map<std::string, named_constant> _constants;
+
+        static std::string qualify(const std::string& name, const std::vector<std::string>& scope, size_t depth);
+
+        constant_value evaluate_literal(const expression::literal& exp, unsigned int line) const;
+        constant_value evaluate_identifier(const expression::identifier& exp, const std::vector<std::string>& scope, unsigned int line);
+        constant_value evaluate_unary(const expression::unary& exp, const std::vector<std::string>& scope, unsigned int line);
+        constant_value evaluate_binary(const expression::binary& exp, const std::vector<std::string>& scope, unsigned int line);
+        constant_value evaluate_typecast(const expression::typecast& exp, const std::vector<std::string>& scope, unsigned int line);
+        constant_value evaluate_attribute(const expression::attribute_selection& exp, unsigned int line);
+
+        static constant_value integer_binary(enumerations::exp_operator op, const constant_value& left, const constant_value& right, unsigned int line);
+        static constant_value floating_binary(enumerations::exp_operator op, const constant_value& left, const constant_value& right, unsigned int line);
+    public:
+        /**
+         * Truncates `value` to the width and sign of the integral type `t`.
+         */
+        static uint64_t truncate(uint64_t value, const data_type& t);
+        /**
+         * Gets a `const` integral type of the given width and sign.
+         */
+        static data_type integral_type(size_t width, bool is_signed);
+        /**
+         * Converts `value` to type `t`, as a typecast to `t` would.
+         */
+        static constant_value cast(const constant_value& value, const data_type& t, unsigned int line);
+        /**
+         * Converts `value` to the type `t` of the data it initializes, setting `exact` to whether the result is equal to
+         * the original value. Values that don't fit wrap, as they would at runtime.
+         *
+         * Booleans and numbers may not be converted to each other implicitly.
+         */
+        static constant_value convert(const constant_value& value, const data_type& t, bool& exact, unsigned int line);
+
+        /**
+         * Registers a named constant so that identifiers referring to it may be evaluated.
+         *
+         * The initializer is not evaluated until the constant is first used.
+         */
+        void add_constant(  const std::string& name,
+                            const std::vector<std::string>& scope,
+                            const data_type& type,
+                            const expression::expression_base* initializer );
+        /**
+         * Checks whether `name` refers to a known constant from the given scope.
+         */
+        bool is_constant(const std::string& name, const std::vector<std::string>& scope) const;
+
+        /**
+         * Evaluates an expression at compile time.
+         *
+         * Throws a compiler exception if the expression is not a compile-time constant.
+         */
+        const constant_value& evaluate( const expression::expression_base& exp,
+                                        const std::vector<std::string>& scope,
+                                        unsigned int line = 0 );
+        /**
+         * Checks whether an expression may be evaluated at compile time without generating any errors.
+         */
+        bool can_evaluate(  const expression::expression_base& exp,
+                            const std::vector<std::string>& scope );
+
+        /**
+         * Removes the memoised results for `exp` and its children.
+         *
+         * This must be used before a node is destroyed if the evaluator is still in use.
+         */
+        void forget(const expression::expression_base& exp);
+
+        constant_evaluator() = default;
+        ~constant_evaluator() = default;
+    };
+}
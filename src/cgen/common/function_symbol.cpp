@@ -0,0 +1,24 @@
+#include "function_symbol.hpp"
+
+size_t function_symbol::get_required_arguments() const
+{
+    size_t required = 0;
+    for (size_t i = 0; i < _parameters.size(); i++)
+    {
+        if (!_parameters[i].default_value)
+            required = i + 1;
+    }
+
+    return required;
+}
+
+function_symbol::function_symbol(   const std::string& name,
+                                    const data_type& return_type,
+                                    const std::vector<function_parameter>& parameters,
+                                    const bool defined,
+                                    const size_t line_defined )
+    : symbol(name, std::vector<std::string>{ }, return_type, defined, line_defined)
+    , _parameters(parameters)
+{
+    _symbol_type = enumerations::symbol_type::FUNCTION_SYMBOL;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "symbol.hpp"
+#include "../../parser/expression/expression.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * A formal parameter of a function.
+ */
+struct function_parameter
+{
+    std::string name;
+    data_type type;
+    /**
+     * The value passed when a call leaves the parameter out, or nullptr if it must always be given.
+     *
+     * This belongs to the function's AST, which must outlive the symbol.
+     */
+    const expression::expression_base* default_value;
+};
+
+/**
+ * The symbol for a function, which knows the function's parameters so that calls to it may be checked and completed.
+ *
+ * The type of the symbol is the function's return type.
+ */
+class function_symbol : public symbol
+{
+    std::vector<function_parameter> _parameters;
+public:
+    const std::vector<function_parameter>& get_parameters() const { return _parameters; }
+
+    /**
+     * Gets the number of arguments a call must give; the parameters after these all have default values.
+     */
+    size_t get_required_arguments() const;
+
+    function_symbol(const std::string& name,
+                    const data_type& return_type,
+                    const std::vector<function_parameter>& parameters,
+                    const bool defined=true,
+                    const size_t line_defined=0 );
+    virtual ~function_symbol() = default;
+};
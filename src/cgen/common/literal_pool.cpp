@@ -0,0 +1,88 @@
+#include "literal_pool.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/data_widths.hpp"
+
+#include <cctype>
+
+namespace utility
+{
+    size_t literal_pool::get_string_length(const std::string& escaped)
+    {
+        // the lexer keeps C's escape sequences as they were written, so they are counted the way a C compiler would
+        size_t length = 0;
+        for (size_t i = 0; i < escaped.size(); i++)
+        {
+            if (escaped[i] == '\\' && i + 1 < escaped.size())
+            {
+                i++;
+                if (escaped[i] >= '0' && escaped[i] <= '7')
+                {
+                    // up to three octal digits
+                    for (size_t digits = 1; digits < 3 && i + 1 < escaped.size() && escaped[i + 1] >= '0' && escaped[i + 1] <= '7'; digits++)
+                        i++;
+                }
+                else if (escaped[i] == 'x')
+                {
+                    while (i + 1 < escaped.size() && std::isxdigit(static_cast<unsigned char>(escaped[i + 1])))
+                        i++;
+                }
+            }
+
+            length++;
+        }
+
+        return length;
+    }
+
+    literal_pool::pooled_string& literal_pool::intern(const std::string& value)
+    {
+        auto it = _strings.find(value);
+        if (it != _strings.end())
+        {
+            return it->second;
+        }
+
+        pooled_string pooled;
+        pooled.label = general_utilities::constants::STRING_BASE + std::to_string(_strings.size());
+        pooled.length = get_string_length(value);
+        pooled.defined = false;
+
+        // the characters of long literals are defined separately so that the pooled string, and any copy of it, can refer to them
+        if (pooled.length > sin_widths::STRING_SMALL_CAPACITY)
+        {
+            pooled.data_label = pooled.label + "_data";
+            _definitions << "static const char " << pooled.data_label << "[] = \"" << value << "\";\n";
+        }
+
+        return _strings.insert(std::make_pair<>(value, std::move(pooled))).first->second;
+    }
+
+    std::string literal_pool::get_initializer(const std::string& value, const pooled_string& pooled)
+    {
+        if (pooled.data_label.empty())
+        {
+            return "SINL_STRING_SMALL_LITERAL(\"" + value + "\", " + std::to_string(pooled.length) + ")";
+        }
+        else
+        {
+            return "SINL_STRING_LARGE_LITERAL(" + pooled.data_label + ", " + std::to_string(pooled.length) + ")";
+        }
+    }
+
+    const std::string& literal_pool::get_string(const std::string& value)
+    {
+        pooled_string& pooled = intern(value);
+        if (!pooled.defined)
+        {
+            _definitions << "static const sinl_string " << pooled.label << " = " << get_initializer(value, pooled) << ";\n";
+            pooled.defined = true;
+        }
+
+        return pooled.label;
+    }
+
+    std::string literal_pool::get_string_initializer(const std::string& value)
+    {
+        return get_initializer(value, intern(value));
+    }
+}
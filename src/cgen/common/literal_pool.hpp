@@ -0,0 +1,59 @@
+#pragma once
+
+#include <unordered_map>
+#include <string>
+#include <sstream>
+
+namespace utility
+{
+    /**
+     * Interns the string literals used by a unit so that each distinct literal is emitted only once.
+     *
+     * A literal used as a value becomes a `static const sinl_string` with its length computed at compile time.
+     * The characters of literals too long to be stored inline get a `static const char` array of their own,
+     * which strings initialized from the literal refer to rather than copying.
+     */
+    class literal_pool
+    {
+        struct pooled_string
+        {
+            std::string label;
+            std::string data_label;     // empty if the literal is stored inline
+            size_t length;
+            bool defined;               // whether the `sinl_string` itself has been emitted
+        };
+
+        /**
+         * The pooled literals, keyed by their text as it appears in the source.
+         */
+        std::unordered_map<std::string, pooled_string> _strings;
+        /**
+         * The definitions of the pooled objects, in the order they were needed.
+         */
+        std::stringstream _definitions;
+
+        pooled_string& intern(const std::string& value);
+        static std::string get_initializer(const std::string& value, const pooled_string& pooled);
+    public:
+        /**
+         * Gets the number of characters in a string literal as it appears in the source, with its escape sequences left in.
+         */
+        static size_t get_string_length(const std::string& escaped);
+
+        /**
+         * Gets the label of the pooled `sinl_string` holding the literal, adding it to the pool if necessary.
+         *
+         * The object may be referred to wherever the string is only read.
+         */
+        const std::string& get_string(const std::string& value);
+        /**
+         * Gets an initializer for a string whose contents start out as the literal.
+         *
+         * Short literals are copied into the string; long ones refer to the pooled characters until the string is modified.
+         */
+        std::string get_string_initializer(const std::string& value);
+
+        bool empty() const { return _strings.empty(); }
+        std::string get_definitions() const { return _definitions.str(); }
+    };
+}
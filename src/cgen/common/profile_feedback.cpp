@@ -0,0 +1,114 @@
+#include "profile_feedback.hpp"
+#include "../../util/exceptions.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace utility
+{
+    std::string profile_feedback::get_key(const std::string& file, const std::string& name)
+    {
+        return file + ":" + name;
+    }
+
+    void profile_feedback::load(const std::string& filename)
+    {
+        std::ifstream in(filename);
+        if (!in.good())
+        {
+            throw error::compiler_exception("Could not open profile '" + filename + "'");
+        }
+
+        _functions.clear();
+        _files.clear();
+        _hot_threshold = 0;
+
+        // skip to the flat profile's column headings
+        std::string line;
+        bool found = false;
+        while (!found && std::getline(in, line))
+        {
+            found = line.rfind("Flat profile", 0) == 0;
+        }
+        std::getline(in, line);
+        std::getline(in, line);
+
+        if (!found)
+        {
+            throw error::compiler_exception("'" + filename + "' is not a profile written by the SIN runtime");
+        }
+
+        // each line is `% self  self  total  calls  name (file:line)`, until the blank line before the call graph
+        std::vector<uint64_t> times;
+        uint64_t all = 0;
+        while (std::getline(in, line) && !line.empty())
+        {
+            std::istringstream fields(line);
+            double share;
+            uint64_t total;
+            function_counts counts;
+            std::string rest;
+            if (!(fields >> share >> counts.self >> total >> counts.calls) || !std::getline(fields >> std::ws, rest))
+            {
+                throw error::compiler_exception("Malformed line in profile '" + filename + "': " + line);
+            }
+
+            const size_t open = rest.rfind(" (");
+            const size_t colon = rest.rfind(':');
+            if (open == std::string::npos || colon == std::string::npos || colon < open)
+            {
+                throw error::compiler_exception("Malformed line in profile '" + filename + "': " + line);
+            }
+
+            const std::string name = rest.substr(0, open);
+            const std::string file = rest.substr(open + 2, colon - open - 2);
+            _functions[get_key(file, name)] = counts;
+            _files[file]++;
+
+            times.push_back(counts.self);
+            all += counts.self;
+        }
+
+        // the hot functions are the busiest that, together, account for most of the time
+        std::sort(times.begin(), times.end(), std::greater<uint64_t>());
+        uint64_t covered = 0;
+        for (uint64_t t: times)
+        {
+            _hot_threshold = t;
+            covered += t;
+            if (covered >= all * HOT_FRACTION)
+                break;
+        }
+
+        _loaded = true;
+    }
+
+    profile_feedback::temperature profile_feedback::get_temperature(const std::string& file, const std::string& name) const
+    {
+        // a profile of some other program says nothing about this one
+        if (!_loaded || !_files.count(file))
+        {
+            return temperature::UNKNOWN;
+        }
+
+        auto it = _functions.find(get_key(file, name));
+        if (it == _functions.end() || it->second.calls == 0)
+        {
+            return temperature::COLD;
+        }
+
+        return it->second.self > 0 && it->second.self >= _hot_threshold ? temperature::HOT : temperature::NORMAL;
+    }
+
+    uint64_t profile_feedback::get_weight(const std::string& file, const std::string& name) const
+    {
+        auto it = _functions.find(get_key(file, name));
+        return it == _functions.end() ? 0 : it->second.self;
+    }
+
+    profile_feedback::profile_feedback()
+        : _hot_threshold(0)
+        , _loaded(false) { }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace utility
+{
+    /**
+     * The counts from a profile written by a program compiled with `--pgo-generate` (or `--instrument`), used to tell
+     * the code generator which functions are hot and which are cold.
+     *
+     * The profile is read from the flat profile the runtime's profiler writes. Functions are matched by their names in
+     * the SIN source and the file they are in, not by line, so that a profile still applies after unrelated edits.
+     */
+    class profile_feedback
+    {
+        struct function_counts
+        {
+            uint64_t calls;
+            uint64_t self;
+        };
+
+        /**
+         * The counts for each function in the profile, keyed by file and name.
+         */
+        std::unordered_map<std::string, function_counts> _functions;
+        /**
+         * The number of functions in the profile from each file.
+         */
+        std::unordered_map<std::string, size_t> _files;
+        /**
+         * The least time a function may spend in itself and be hot.
+         */
+        uint64_t _hot_threshold;
+        bool _loaded;
+
+        static std::string get_key(const std::string& file, const std::string& name);
+    public:
+        /**
+         * The fraction of the profile's time that the hot functions, together, account for.
+         */
+        static constexpr double HOT_FRACTION = 0.9;
+
+        enum class temperature
+        {
+            UNKNOWN,    // there is no profile for the function's file
+            COLD,       // never called while profiling
+            NORMAL,
+            HOT         // among the functions the program spent most of its time in
+        };
+
+        /**
+         * Reads a profile, replacing any read before.
+         */
+        void load(const std::string& filename);
+        bool is_loaded() const { return _loaded; }
+
+        temperature get_temperature(const std::string& file, const std::string& name) const;
+        /**
+         * Gets the time the function spent in itself while profiling, or 0 if it wasn't called.
+         */
+        uint64_t get_weight(const std::string& file, const std::string& name) const;
+
+        profile_feedback();
+    };
+}
@@ -0,0 +1,239 @@
+#include "struct_table.hpp"
+#include "../../util/data_widths.hpp"
+#include "../../util/exceptions.hpp"
+
+#include <algorithm>
+
+namespace utility
+{
+    struct_info::struct_info(const std::string& name, std::vector<struct_member>&& members, size_t width, size_t alignment, bool packed)
+        : _name(name)
+        , _members(std::move(members))
+        , _width(width)
+        , _alignment(alignment)
+        , _packed(packed) { }
+
+    const struct_member* struct_info::find_member(const std::string& name) const
+    {
+        auto it = std::find_if(_members.begin(), _members.end(), [&name](const struct_member& m) {
+            return m.name == name;
+        });
+
+        return it == _members.end() ? nullptr : &(*it);
+    }
+
+    std::vector<struct_member> struct_table::get_members(const std::vector<std::pair<std::string, data_type>>& members,
+                                                         unsigned int line) const
+    {
+        std::vector<struct_member> laid_out;
+        for (const auto& m: members)
+        {
+            // dynamic members are only pointers to their resources
+            const bool dynamic = m.second.get_qualities().is_dynamic();
+            const size_t width = dynamic ? sin_widths::PTR_WIDTH : get_width(m.second);
+            const size_t alignment = dynamic ? sin_widths::PTR_WIDTH : get_alignment(m.second);
+            if (width == 0)
+            {
+                throw error::compiler_exception(
+                    "The width of struct member '" + m.first + "' could not be determined",
+                    error_code::TYPE_ERROR,
+                    line
+                );
+            }
+
+            laid_out.push_back(struct_member{ m.first, m.second, 0, width, alignment });
+        }
+
+        return laid_out;
+    }
+
+    /**
+     * Assigns each member its offset, in the order given, returning the width of the struct.
+     *
+     * If `aligned` is set, each member is padded to its natural alignment, and the struct to the largest of them;
+     * otherwise, the members are packed.
+     */
+    size_t struct_table::lay_out(std::vector<struct_member>& members, bool aligned, size_t& alignment)
+    {
+        size_t offset = 0;
+        alignment = 1;
+        for (auto& m: members)
+        {
+            if (aligned)
+            {
+                offset = (offset + m.alignment - 1) / m.alignment * m.alignment;
+                alignment = std::max(alignment, m.alignment);
+            }
+
+            m.offset = offset;
+            offset += m.width;
+        }
+
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    const struct_info& struct_table::define(const std::string& name,
+                                            const std::vector<std::pair<std::string, data_type>>& members,
+                                            bool reorder,
+                                            unsigned int line)
+    {
+        if (_structs.count(name))
+        {
+            throw error::compiler_exception(
+                "Struct '" + name + "' has already been defined",
+                error_code::DUPLICATE_DEFINITION_ERROR,
+                line
+            );
+        }
+
+        std::vector<struct_member> laid_out = get_members(members, line);
+        size_t alignment;
+        size_t width = lay_out(laid_out, reorder, alignment);
+        if (reorder)
+        {
+            // a stable sort keeps members of the same alignment in declaration order
+            std::vector<struct_member> sorted = laid_out;
+            std::stable_sort(sorted.begin(), sorted.end(), [](const struct_member& a, const struct_member& b) {
+                return a.alignment > b.alignment;
+            });
+
+            // arrays may not fill their alignment, in which case sorting can occasionally make things worse
+            const size_t sorted_width = lay_out(sorted, true, alignment);
+            if (sorted_width < width)
+            {
+                laid_out = std::move(sorted);
+                width = sorted_width;
+            }
+            else
+            {
+                lay_out(laid_out, true, alignment);
+            }
+        }
+
+        return _structs.insert(
+            std::make_pair<>(name, struct_info(name, std::move(laid_out), width, alignment, !reorder))
+        ).first->second;
+    }
+
+    size_t struct_table::get_declared_width(const std::vector<std::pair<std::string, data_type>>& members, unsigned int line) const
+    {
+        std::vector<struct_member> laid_out = get_members(members, line);
+        size_t alignment;
+        return lay_out(laid_out, true, alignment);
+    }
+
+    const struct_info& struct_table::find(const std::string& name, unsigned int line) const
+    {
+        auto it = _structs.find(name);
+        if (it == _structs.end())
+        {
+            throw error::compiler_exception(
+                "Struct '" + name + "' must be defined before it is used",
+                error_code::UNDEFINED_ERROR,
+                line
+            );
+        }
+
+        return it->second;
+    }
+
+    bool struct_table::contains(const std::string& name) const
+    {
+        return _structs.count(name) != 0;
+    }
+
+    size_t struct_table::get_width(const data_type& t) const
+    {
+        switch (t.get_primary())
+        {
+        case enumerations::primitive_type::STRUCT:
+        {
+            auto it = _structs.find(t.get_struct_name());
+            return it == _structs.end() ? 0 : it->second.get_width();
+        }
+        case enumerations::primitive_type::ARRAY:
+        {
+            if (t.get_qualities().is_soa())
+            {
+                auto it = _structs.find(t.get_subtype().get_struct_name());
+                return it == _structs.end() ? 0 : get_soa_width(it->second, t.get_array_length());
+            }
+
+            // arrays of structs don't know their own width, as their element width comes from this table
+            const size_t element_width = t.get_contained_types().empty() ? 0 : get_width(t.get_subtype());
+            if (t.get_array_length() == 0 || element_width == 0)
+                return t.get_width();
+
+            return data_type::get_array_width(t.get_array_length(), element_width);
+        }
+        default:
+            return t.get_width();
+        }
+    }
+
+    size_t struct_table::get_alignment(const data_type& t) const
+    {
+        switch (t.get_primary())
+        {
+        case enumerations::primitive_type::PTR:
+        case enumerations::primitive_type::REFERENCE:
+        case enumerations::primitive_type::STRING:  // long strings hold a pointer to their characters
+            return sin_widths::PTR_WIDTH;
+        case enumerations::primitive_type::STRUCT:
+        {
+            auto it = _structs.find(t.get_struct_name());
+            return it == _structs.end() ? 1 : it->second.get_alignment();
+        }
+        case enumerations::primitive_type::ARRAY:
+        {
+            // the elements follow the header, so the whole array must be aligned as strictly as either
+            size_t alignment = std::max(data_type::get_array_header_size(), t.get_contained_types().empty() ? 1 : get_alignment(t.get_subtype()));
+            if (t.get_qualities().is_soa())
+            {
+                auto it = _structs.find(t.get_subtype().get_struct_name());
+                if (it != _structs.end())
+                {
+                    for (const auto& member: it->second.get_members())
+                        alignment = std::max(alignment, get_column_alignment(member));
+                }
+            }
+
+            return alignment;
+        }
+        case enumerations::primitive_type::TUPLE:
+        {
+            size_t alignment = 1;
+            for (const auto& contained: t.get_contained_types())
+                alignment = std::max(alignment, get_alignment(contained));
+            return alignment;
+        }
+        default:
+        {
+            // scalars are aligned to their own width
+            const size_t width = t.get_width();
+            return width == 0 ? 1 : width;
+        }
+        }
+    }
+
+    size_t struct_table::get_column_alignment(const struct_member& member)
+    {
+        // the columns are arrays in their own right, so they are aligned like any other array's elements
+        const size_t header = data_type::get_array_header_size();
+        return header > sin_widths::ARRAY_LENGTH_SIZE ? std::max(header, member.alignment) : member.alignment;
+    }
+
+    size_t struct_table::get_soa_width(const struct_info& info, size_t length)
+    {
+        size_t offset = sin_widths::ARRAY_LENGTH_SIZE;
+        size_t alignment = sin_widths::ARRAY_LENGTH_SIZE;
+        for (const auto& member: info.get_members())
+        {
+            const size_t column_alignment = get_column_alignment(member);
+            offset = (offset + column_alignment - 1) / column_alignment * column_alignment + length * member.width;
+            alignment = std::max(alignment, column_alignment);
+        }
+
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
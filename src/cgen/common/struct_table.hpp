@@ -0,0 +1,102 @@
+#pragma once
+
+#include "../../util/data_type.hpp"
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace utility
+{
+    /**
+     * A data member of a struct, and where it lies in the struct's objects.
+     */
+    struct struct_member
+    {
+        std::string name;
+        data_type type;
+        size_t offset;
+        size_t width;
+        size_t alignment;
+    };
+
+    /**
+     * The layout of a struct's objects.
+     */
+    class struct_info
+    {
+        std::string _name;
+        /**
+         * The members in the order they are laid out in memory.
+         */
+        std::vector<struct_member> _members;
+        size_t _width;
+        size_t _alignment;
+        bool _packed;   // whether the members were laid out with no padding; the C struct must then be packed too
+    public:
+        const std::string& get_name() const { return _name; }
+        const std::vector<struct_member>& get_members() const { return _members; }
+        size_t get_width() const { return _width; }
+        size_t get_alignment() const { return _alignment; }
+        bool is_packed() const { return _packed; }
+
+        /**
+         * Finds a member by name, returning nullptr if the struct has no such member.
+         */
+        const struct_member* find_member(const std::string& name) const;
+
+        struct_info(const std::string& name, std::vector<struct_member>&& members, size_t width, size_t alignment, bool packed);
+    };
+
+    /**
+     * Contains the layouts of the structs defined in the unit.
+     *
+     * Members are always addressed by name through the table, so the order in which they are laid out is free to
+     * differ from the order in which they were declared.
+     */
+    class struct_table
+    {
+        std::unordered_map<std::string, struct_info> _structs;
+
+        std::vector<struct_member> get_members(const std::vector<std::pair<std::string, data_type>>& members, unsigned int line) const;
+        static size_t lay_out(std::vector<struct_member>& members, bool aligned, size_t& alignment);
+    public:
+        /**
+         * Lays out a struct whose members are given in declaration order, and adds it to the table.
+         *
+         * If `reorder` is set, the members are sorted by decreasing alignment and padded to their natural alignment;
+         * otherwise, they are kept in declaration order with no padding.
+         */
+        const struct_info& define(const std::string& name,
+                                  const std::vector<std::pair<std::string, data_type>>& members,
+                                  bool reorder,
+                                  unsigned int line);
+        /**
+         * Gets the width the struct's objects would have if its members were padded to their natural alignment in declaration
+         * order, as a C compiler would lay them out.
+         */
+        size_t get_declared_width(const std::vector<std::pair<std::string, data_type>>& members, unsigned int line) const;
+
+        const struct_info& find(const std::string& name, unsigned int line) const;
+        bool contains(const std::string& name) const;
+
+        /**
+         * Gets the width of an object of the given type, looking up the widths of structs in the table.
+         */
+        size_t get_width(const data_type& t) const;
+        /**
+         * Gets the natural alignment of an object of the given type.
+         */
+        size_t get_alignment(const data_type& t) const;
+
+        /**
+         * Gets the alignment of each member's column in a `soa` array of the struct.
+         */
+        static size_t get_column_alignment(const struct_member& member);
+        /**
+         * Gets the width of a `soa` array of `length` objects of the struct: the length, followed by an array of each member.
+         */
+        static size_t get_soa_width(const struct_info& info, size_t length);
+    };
+}
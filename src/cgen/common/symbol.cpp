@@ -42,11 +42,15 @@ symbol::symbol( const std::string& name,
                 const data_type& type,
                 const bool defined,
                 const size_t line_defined )
-    : _name(name)
-    , _scope(scope)
+    : _is_parameter(false)
+    , _name(name)
+    , _symbol_type(enumerations::symbol_type::VARIABLE)
     , _type(type)
+    , _scope(scope)
     , _defined(defined)
     , _line_defined(line_defined)
+    , _initialized(false)
+    , _freed(false)
     {
         _decorated_name = decorate(_name, _scope, _type);
     }
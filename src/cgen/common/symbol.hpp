@@ -69,6 +69,7 @@ public:
     void set_as_parameter() { _is_parameter = true; }
 
     const std::string& get_name() const { return _name; }
+    const std::string& get_decorated_name() const { return _decorated_name; }
 
     const std::vector<std::string>& get_scope() const
     {
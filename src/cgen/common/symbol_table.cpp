@@ -1,13 +1,23 @@
 #include "symbol_table.hpp"
 
+#include <algorithm>
+
 namespace utility
 {
-    void symbol_table::add_symbol(symbol&& sym)
+    void symbol_table::add_symbol(symbol&& sym, bool must_release)
     {
+        add_symbol(std::make_unique<symbol>(std::move(sym)), must_release);
+    }
+
+    void symbol_table::add_symbol(std::unique_ptr<symbol> sym, bool must_release)
+    {
+        // get the keys before the symbol is moved into the table
+        const std::string decorated = sym->get_decorated_name();
+        const std::string name = sym->get_name();
         auto it = _symbols.insert(
             std::make_pair<>(
-                sym.get_name(),
-                std::make_unique<symbol>(std::move(sym))
+                decorated,
+                std::move(sym)
             )
         );
         
@@ -15,6 +25,79 @@ namespace utility
         {
             throw error::compiler_exception("Could not add symbol to table.");
         }
+
+        _names[name].push_back(decorated);
+
+        if (must_release)
+        {
+            _locals.push_back(decorated);
+        }
+    }
+
+    std::vector<const symbol*> symbol_table::pop_locals(const std::vector<std::string>& scope)
+    {
+        std::vector<const symbol*> locals;
+        while (!_locals.empty())
+        {
+            auto it = _symbols.find(_locals.back());
+            if (it == _symbols.end() || it->second->get_scope() != scope)
+                break;
+
+            locals.push_back(it->second.get());
+            _locals.pop_back();
+        }
+
+        return locals;
+    }
+
+    std::vector<const symbol*> symbol_table::get_locals(const std::vector<std::string>& scope) const
+    {
+        std::vector<const symbol*> locals;
+        for (auto it = _locals.rbegin(); it != _locals.rend(); it++)
+        {
+            auto sym = _symbols.find(*it);
+            if (sym == _symbols.end())
+                break;
+
+            // the locals of inner scopes are always allocated after those of the scopes enclosing them
+            const std::vector<std::string>& local_scope = sym->second->get_scope();
+            if (local_scope.size() < scope.size() || !std::equal(scope.begin(), scope.end(), local_scope.begin()))
+                break;
+
+            locals.push_back(sym->second.get());
+        }
+
+        return locals;
+    }
+
+    const symbol* symbol_table::find(const std::string& name, const std::vector<std::string>& scope) const
+    {
+        auto it = _names.find(name);
+        if (it == _names.end())
+        {
+            return nullptr;
+        }
+
+        // the symbol in the innermost scope enclosing this one shadows the others
+        const symbol* found = nullptr;
+        for (const auto& decorated: it->second)
+        {
+            const symbol* candidate = _symbols.at(decorated).get();
+            const std::vector<std::string>& candidate_scope = candidate->get_scope();
+            if (candidate_scope.size() <= scope.size() &&
+                std::equal(candidate_scope.begin(), candidate_scope.end(), scope.begin()) &&
+                (!found || candidate_scope.size() >= found->get_scope().size()))
+            {
+                found = candidate;
+            }
+        }
+
+        return found;
+    }
+
+    symbol* symbol_table::find(const std::string& name, const std::vector<std::string>& scope)
+    {
+        return const_cast<symbol*>(static_cast<const symbol_table&>(*this).find(name, scope));
     }
 
     bool symbol_table::contains(const std::string& name,
@@ -7,6 +7,7 @@
 #include <memory>
 #include <utility>
 #include <deque>
+#include <vector>
 
 namespace utility
 {
@@ -27,9 +28,35 @@ namespace utility
          * Note the deque contains the decorated symbol name.
          */
         std::deque<std::string> _locals;
+        /**
+         * The decorated names of the symbols with each name, in the order they were added.
+         */
+        std::unordered_map<std::string, std::vector<std::string>> _names;
     
     public:
-        void add_symbol(symbol&& sym);
+        /**
+         * Adds a symbol to the table.
+         *
+         * If `must_release` is set, the symbol is a local whose resource must be released when its scope exits.
+         */
+        void add_symbol(symbol&& sym, bool must_release = false);
+        void add_symbol(std::unique_ptr<symbol> sym, bool must_release = false);
+        /**
+         * Removes the locals that must be released from the given scope, returning them in the reverse order of their allocation.
+         */
+        std::vector<const symbol*> pop_locals(const std::vector<std::string>& scope);
+        /**
+         * Gets the locals that must be released from the given scope and the scopes nested in it, in the reverse order
+         * of their allocation, without removing them.
+         */
+        std::vector<const symbol*> get_locals(const std::vector<std::string>& scope) const;
+        /**
+         * Finds the symbol that `name` refers to from the given scope, searching from the innermost scope outwards.
+         *
+         * Returns nullptr if there is no such symbol.
+         */
+        const symbol* find(const std::string& name, const std::vector<std::string>& scope) const;
+        symbol* find(const std::string& name, const std::vector<std::string>& scope);
         bool contains(const std::string& name, const std::vector<std::string>& scope, const data_type& type) const;
         
         symbol_table() = default;
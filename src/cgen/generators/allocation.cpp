@@ -1,35 +1,627 @@
 #include "../cgen.hpp"
 #include "../../parser/statement/allocation.hpp"
+#include "../../parser/expressions.hpp"
+#include "../../util/data_widths.hpp"
+#include "../../util/general_utilities.hpp"
 
 using statement::allocation;
 
-cgen::gen_allocation(const allocation& alloc)
+/**
+ * Gets the suffix of the runtime's reference counting functions for the current mode.
+ */
+static const char* get_refcount_suffix(enumerations::refcount_mode mode)
 {
+    switch (mode)
+    {
+    case enumerations::refcount_mode::NONATOMIC_REFCOUNT:
+        return "nonatomic";
+    case enumerations::refcount_mode::BIASED_REFCOUNT:
+        return "biased";
+    default:
+        return "atomic";
+    }
+}
+
+/**
+ * Makes a statement of an expression that may be empty, such as a cost counter that is disabled.
+ */
+static std::string as_statement(const std::string& exp)
+{
+    return exp.empty() ? exp : exp + ";\n";
+}
+
+/**
+ * Gets the name of the position in the allocation region recorded by the given scope.
+ *
+ * Marks are named for the depth of their scope, so that a mark never hides those of the scopes enclosing it.
+ */
+static std::string get_region_mark(const std::vector<std::string>& scope)
+{
+    return general_utilities::constants::CONSTANT_BASE + "region_mark_" + std::to_string(scope.size());
+}
+
+/**
+ * Evaluates the length of an array type, if it has one, so that its width is known.
+ *
+ * The lengths of fixed-length arrays must be known at compile time.
+ */
+void cgen::evaluate_array_length(data_type& t, unsigned int line)
+{
+    if (t.get_primary() == enumerations::primitive_type::ARRAY && t.get_array_length_expression())
+    {
+        const expression::expression_base& length_exp = *t.get_array_length_expression();
+        if (length_exp.is_const())
+        {
+            const utility::constant_value& length = _constants.evaluate(length_exp, _scope, line);
+            if (!length.is_integral() || length.is_negative())
+            {
+                throw error::compiler_exception(
+                    "Array length must be a non-negative integer",
+                    error_code::TYPE_ERROR,
+                    line
+                );
+            }
+
+            t.set_array_length(length.integer);
+        }
+        else if (!t.get_qualities().is_dynamic())
+        {
+            throw error::variable_array_length(line);
+        }
+    }
+}
+
+/**
+ * Folds a constant expression into a literal of type `t`, the type of the data it initializes.
+ *
+ * Values that don't fit the type wrap as they would at runtime, which generates a warning (an error in strict mode).
+ */
+std::string cgen::gen_folded_value(const expression::expression_base& exp, const data_type& t, unsigned int line)
+{
+    bool exact;
+    const utility::constant_value value = utility::constant_evaluator::convert(_constants.evaluate(exp, _scope, line), t, exact, line);
+    if (!exact)
+    {
+        const std::string message = "Initial value does not fit in '" + t.get_c_typename() + "' and will be changed to " + value.to_c_literal();
+        if (_strict)
+        {
+            throw error::compiler_exception(message, error_code::POTENTIAL_DATA_LOSS, line);
+        }
+
+        error::compiler_warning(message, error_code::POTENTIAL_DATA_LOSS, line);
+    }
+
+    return value.to_c_literal();
+}
+
+/**
+ * Generates the initializer of data of type `t` from a constant expression, for data in static memory or `const`
+ * data, whose initial values must be known at compile time.
+ *
+ * Lists are folded element by element; anything else that can't be folded is an error.
+ */
+std::string cgen::gen_constant_initializer(const expression::expression_base& exp, const data_type& t, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    auto not_constant = [&]()
+    {
+        if (t.get_qualities().is_const())
+        {
+            return error::compiler_exception(
+                "'const' data must be initialized with a compile-time constant",
+                error_code::NON_CONST_VALUE_ERROR,
+                line
+            );
+        }
+
+        return error::compiler_exception(
+            "Static memory must be initialized with a compile-time constant",
+            error_code::STATIC_MEMORY_INITIALIZATION_ERROR,
+            line
+        );
+    };
+
+    if (exp.get_expression_type() == enumerations::expression_type::LIST)
+    {
+        const std::vector<const expression::expression_base*> elements = static_cast<const expression::list_expression&>(exp).get_list();
+        std::string value;
+        if (t.get_primary() == primitive_type::ARRAY && !t.get_qualities().is_soa())
+        {
+            if (elements.size() > t.get_array_length())
+            {
+                throw error::compiler_exception(
+                    "The list has more elements than the array has room for",
+                    error_code::OUT_OF_BOUNDS,
+                    line
+                );
+            }
+
+            value = "{ .len = " + std::to_string(t.get_array_length()) + ", .data = { ";
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                value += (i ? ", " : "") + gen_constant_initializer(*elements[i], t.get_subtype(), line);
+            }
+        }
+        else if (t.get_primary() == primitive_type::TUPLE && elements.size() == t.get_contained_types().size())
+        {
+            value = "{ ";
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                value += (i ? ", " : "") + gen_constant_initializer(*elements[i], t.get_contained_types()[i], line);
+            }
+        }
+        else
+        {
+            throw error::compiler_exception(
+                "Lists may only be used to initialize or assign arrays and tuples",
+                error_code::LIST_TYPE_MISMATCH,
+                line
+            );
+        }
+
+        return value + (t.get_primary() == primitive_type::ARRAY ? " } }" : " }");
+    }
+    else if (t.get_primary() == primitive_type::STRING && exp.get_expression_type() == enumerations::expression_type::LITERAL)
+    {
+        _includes.insert("sinl_string.h");
+        return _literals.get_string_initializer(static_cast<const expression::literal&>(exp).get_value());
+    }
+    else if ((t.get_primary() == primitive_type::INT || t.get_primary() == primitive_type::FLOAT ||
+        t.get_primary() == primitive_type::BOOL || t.get_primary() == primitive_type::CHAR) &&
+        (exp.is_const() || _constants.can_evaluate(exp, _scope)))
+    {
+        return gen_folded_value(exp, t, line);
+    }
+
+    throw not_constant();
+}
+
+std::string cgen::gen_allocation(const allocation& alloc)
+{
+    using enumerations::primitive_type;
+
+    const unsigned int line = alloc.get_line_number();
     std::stringstream code;
 
-    _symbols.add_symbol(symbol {
-                            alloc.get_name(),
-                            _scope,
-                            alloc.get_type_information(),
-                            alloc.was_initialized(),
-                            alloc.get_line_number()
-                        });
+    data_type t = alloc.get_type_information();
+    evaluate_array_length(t, line);
 
-    const data_type& t = alloc.get_type_information();
-    code << t.get_c_typename() << " ";
-    code << alloc.get_name();
+    // data at file scope and static locals are in static memory, which is initialized when the program is loaded
+    const bool is_static = _scope.empty() || t.get_qualities().is_static();
+    if (is_static && t.get_qualities().is_dynamic())
+    {
+        throw error::compiler_exception(
+            "Dynamic data may only be allocated in functions",
+            error_code::STATIC_MEMORY_INITIALIZATION_ERROR,
+            line
+        );
+    }
+    else if (t.get_primary() == primitive_type::REFERENCE && !(alloc.was_initialized() && alloc.get_initial_value()))
+    {
+        throw error::compiler_exception("References must be initialized when they are allocated", error_code::REFERENCE_ALLOCATION_ERROR, line);
+    }
+
+    // constant strings initialized with a literal are never written, so they use the pooled literal rather than a copy of it
+    const bool is_string = t.get_primary() == primitive_type::STRING;
+    const expression::expression_base* init = alloc.was_initialized() ? alloc.get_initial_value() : nullptr;
+    const bool is_pooled = is_string && t.get_qualities().is_const() && !t.get_qualities().is_dynamic() &&
+        init && init->get_expression_type() == enumerations::expression_type::LITERAL;
+
+    // local managed resources are released when their scope exits, unless the optimizer found they are only borrowed
+    const bool must_release = !is_static && (t.get_qualities().is_dynamic() ?
+        _allocation_mode == enumerations::allocation_mode::POOLED_ALLOCATION && alloc.needs_release() :
+        (is_string && !is_pooled) || (is_counted(t) && alloc.needs_release()));
+    const bool adds_ref = !is_static && is_counted(t) && !t.get_qualities().is_dynamic() && init && alloc.needs_add_ref();
+
+    // the data as it is used, through its pointer if it is dynamic
+    data_type value_type = t;
+    value_type.get_qualities().remove_quality(enumerations::symbol_quality::DYNAMIC);
+    const std::string target = t.get_qualities().is_dynamic() ? "(*" + alloc.get_name() + ")" : alloc.get_name();
+
+    // the initial value is generated before the name is in scope, so that it refers to any data the name shadows
+    std::string initial_value;
+    std::string initialization;
+    const bool is_scalar = t.get_primary() == primitive_type::INT || t.get_primary() == primitive_type::FLOAT ||
+        t.get_primary() == primitive_type::BOOL || t.get_primary() == primitive_type::CHAR ||
+        t.get_primary() == primitive_type::PTR || t.get_primary() == primitive_type::RAW;
+    bool is_call = false;
+    if (init && !is_pooled)
+    {
+        is_call = init->get_expression_type() == enumerations::expression_type::CALL_EXP ||
+            init->get_expression_type() == enumerations::expression_type::PROC_EXP;
+        if (is_counted(t) && !is_static)
+        {
+            check_counted_value(*init, line);
+        }
+
+        if (is_static || t.get_qualities().is_const())
+        {
+            initial_value = gen_constant_initializer(*init, value_type, line);
+        }
+        else if (t.get_primary() == primitive_type::REFERENCE)
+        {
+            // references are bound to lvalues, or to the data a pointer points to
+            const bool is_address = init->get_expression_type() == enumerations::expression_type::UNARY &&
+                static_cast<const expression::unary&>(*init).get_operator() == enumerations::exp_operator::ADDRESS;
+            const data_type referent = is_address ?
+                get_expression_type(static_cast<const expression::unary&>(*init).get_operand(), line) :
+                get_expression_type(*init, line);
+            if (!t.get_subtype().is_compatible(referent))
+            {
+                throw error::type_error(line);
+            }
+
+            initial_value = is_address ? gen_expression(*init, line) : gen_address(*init, line);
+        }
+        else if ((is_scalar && init->is_const()) || (is_string && init->get_expression_type() == enumerations::expression_type::LITERAL))
+        {
+            initial_value = gen_constant_initializer(*init, value_type, line);
+        }
+        else if (!t.get_qualities().is_dynamic() && (is_scalar || (is_string && is_call)))
+        {
+            if (!t.is_compatible(get_expression_type(*init, line)))
+            {
+                throw error::compiler_exception("The value's type is not compatible with the data it is stored in", error_code::TYPE_ERROR, line);
+            }
+
+            initial_value = gen_expression(*init, line);
+        }
+        else
+        {
+            initialization = gen_store(value_type, target, *init, line, true, !t.get_qualities().is_dynamic());
+        }
+    }
+
+    symbol sym {
+        alloc.get_name(),
+        _scope,
+        t,
+        alloc.was_initialized(),
+        line
+    };
+
+    if (is_pooled)
+    {
+        const auto& literal = static_cast<const expression::literal&>(*init);
+        _includes.insert("sinl_string.h");
+        _pooled_symbols[sym.get_decorated_name()] = _literals.get_string(literal.get_value());
+    }
+
+    // when compiling a whole program, globals declared by an earlier unit's include are defined by their own unit
+    if (!(_scope.empty() && _whole_program && _symbols.contains(alloc.get_name(), _scope, t)))
+    {
+        _symbols.add_symbol(std::move(sym), must_release);
+    }
 
+    // named constants are only evaluated if they are used in a constexpr
+    if (t.get_qualities().is_const() && init && !_constants.is_constant(alloc.get_name(), _scope))
+    {
+        _constants.add_constant(alloc.get_name(), _scope, t, init);
+    }
+
+    if (is_pooled)
+    {
+        return "";
+    }
+
+    if (!_scope.empty() && t.get_qualities().is_static())
+    {
+        code << "static ";
+    }
+
+    // arrays of structs split into parallel arrays of their members have a storage type of their own
+    if (t.get_qualities().is_soa())
+    {
+        code << gen_soa_type(t, line) << " " << alloc.get_name() << " = " << gen_zero_value(t, line) << ";\n";
+        return code.str();
+    }
+
+    std::string allocator;
     if (t.get_qualities().is_dynamic())
     {
-        code << " = malloc(" << t.get_width() << ")";
+        allocator = gen_dynamic_allocation(t, code, line);
+    }
+
+    // automatic and static arrays hold their own storage, so their lengths must be known
+    const bool is_array = t.get_primary() == primitive_type::ARRAY;
+    if (is_array && !t.get_qualities().is_dynamic() && t.get_array_length() == 0)
+    {
+        throw error::variable_array_length(line);
     }
 
-    code << ";\n";
+    if (is_string)
+    {
+        _includes.insert("sinl_string.h");
+    }
 
-    if (alloc.was_initialized())
+    code << gen_c_type(t, line) << " " << alloc.get_name();
+    if (t.get_qualities().is_dynamic())
     {
-        // todo: alloc-init
+        code << " = " << allocator << ";\n";
+
+        // dynamic memory isn't zeroed when it is obtained; the string initializers are brace-enclosed, so they must be
+        // assigned as compound literals
+        const std::string zero = gen_zero_value(value_type, line);
+        if (is_array)
+        {
+            code << gen_dynamic_array_init(value_type, alloc.get_name(), initial_value.empty() ? zero : initial_value, line);
+        }
+        else if (!initial_value.empty())
+        {
+            code << target << " = " << (is_scalar ? "" : "(" + gen_c_type(value_type, line) + ")") << initial_value << ";\n";
+        }
+        else if (!is_scalar || initialization.empty())
+        {
+            code << target << " = (" << gen_c_type(value_type, line) << ")" << (zero.empty() ? "{ 0 }" : zero) << ";\n";
+        }
+    }
+    else
+    {
+        // data without an initial value starts out zeroed, as static data would, with the lengths of its arrays set
+        if (initial_value.empty())
+        {
+            initial_value = gen_zero_value(t, line);
+        }
+        if (initial_value.empty() && !is_static)
+        {
+            initial_value = is_scalar ? "0" : "{ 0 }";
+        }
+
+        if (!initial_value.empty())
+        {
+            code << " = " << initial_value;
+        }
+        code << ";\n";
+
+        // a call's result already holds a reference, which the pointer adopts, as does a pointer the optimizer found
+        // only borrows its value's reference
+        if (adds_ref && !is_call)
+        {
+            code << gen_add_ref(alloc.get_name(), line);
+        }
+    }
+
+    code << initialization;
+    return code.str();
+}
+
+/**
+ * Generates the expression that obtains memory for dynamic data of type `t`.
+ *
+ * Any setup the allocation needs is written to `code` first.
+ */
+std::string cgen::gen_dynamic_allocation(const data_type& t, std::stringstream& code, unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    // the widths of structs are only known once they have been laid out
+    if (t.get_primary() == enumerations::primitive_type::STRUCT)
+    {
+        _structs.find(t.get_struct_name(), line);
+    }
+    const std::string width = std::to_string(_structs.get_width(t));
+
+    if (_allocation_mode == enumerations::allocation_mode::REGION_ALLOCATION)
+    {
+        _includes.insert("sinl_region.h");
+
+        // the first region allocation in a scope records where the region was, so the scope can release everything it allocated on exit
+        if (!_scope.empty() && _region_scopes.insert(_scope).second)
+        {
+            code << "size_t " << get_region_mark(_scope) << " = sinl_region_mark(&" << CONSTANT_BASE << "region);\n";
+        }
+
+        return "sinl_check_alloc(sinl_region_alloc(&" + CONSTANT_BASE + "region, " + width + "), " + width + ", " +
+            gen_error_site(line) + ")";
+    }
+    else if (_micro)
+    {
+        throw error::compiler_exception(
+            "Dynamic memory is not available in uSIN unless region allocation is enabled",
+            error_code::UNSUPPORTED_FEATURE,
+            line
+        );
+    }
+
+    // managed resources come from the runtime's pooled allocator, with a header for the reference count
+    _includes.insert("sinl_refcount.h");
+    const std::string memory = _refcount_mode == enumerations::refcount_mode::BIASED_REFCOUNT ?
+        "sinl_rc_alloc_biased(" + width + ")" :
+        "sinl_rc_alloc(" + width + ")";
+
+    // running out of memory stops the program
+    const std::string allocator = "sinl_check_alloc(" + memory + ", " + width + ", " + gen_error_site(line) + ")";
+
+    if (_profile_allocations)
+    {
+        // each allocation site has its own counts in the profile
+        const std::string site = CONSTANT_BASE + "alloc_site_" + std::to_string(_site_count++);
+        _struct_definitions << "static struct sinl_alloc_site " << site << " = SINL_ALLOC_SITE(" <<
+            general_utilities::quote(_source_filename) << ", " << line << ");\n";
+        return "sinl_rc_track(" + allocator + ", &" + site + ")";
+    }
+
+    return allocator;
+}
+
+/**
+ * Generates the code that sets up a newly allocated dynamic array, `name`, of type `t`, from `value`, its brace-enclosed
+ * initializer.
+ *
+ * Dynamic memory only has the allocator's alignment, which may be less strict than the array's storage type, so the
+ * storage type is never stored through; the length is set and the elements are written where `sinl_array_data` finds
+ * them. Elements that are zero when they are empty are cleared directly, and anything else is copied from a compound
+ * literal, which is aligned as automatic data is.
+ */
+std::string cgen::gen_dynamic_array_init(const data_type& t, const std::string& name, const std::string& value, unsigned int line)
+{
+    _includes.insert("sinl_array.h");
+
+    std::stringstream code;
+    const std::string length = std::to_string(t.get_array_length());
+    const std::string element = gen_c_type(t.get_subtype(), line);
+    code << "sinl_array_set_length(" << name << ", " << length << ");\n";
+    if (value == gen_zero_value(t, line) && gen_zero_value(t.get_subtype(), line).empty())
+    {
+        code << "memset(sinl_array_data(" << name << "), 0, " << length << " * sizeof(" << element << "));\n";
+    }
+    else
+    {
+        code << "sinl_array_copy(" << name << ", &(" << gen_c_type(t, line) << ")" << value << ", sizeof(" << element << "));\n";
+    }
+
+    return code.str();
+}
+
+/**
+ * Generates a statement that adds a reference to a managed resource.
+ *
+ * The count is updated inline; see `sinl_refcount.h`.
+ */
+std::string cgen::gen_add_ref(const std::string& resource, unsigned int line)
+{
+    _includes.insert("sinl_refcount.h");
+    return as_statement(gen_cost_counter("SINL_COUNT_RETAIN", line)) +
+        std::string("sinl_rc_retain_") + get_refcount_suffix(_refcount_mode) + "(" + resource + ");\n";
+}
+
+/**
+ * Generates a statement that removes a reference to a managed resource, freeing it if it was the last.
+ */
+std::string cgen::gen_release(const std::string& resource, unsigned int line)
+{
+    _includes.insert("sinl_refcount.h");
+    return as_statement(gen_cost_counter("SINL_COUNT_RELEASE", line)) +
+        std::string("sinl_rc_release_") + get_refcount_suffix(_refcount_mode) + "(" + resource + ");\n";
+}
+
+/**
+ * Checks whether data of type `t` holds a reference counted by the MAM, which it adds when it is given a resource and
+ * removes when it is reseated or goes out of scope.
+ *
+ * Only managed pointers hold counts, and only when resources come from the pooled allocator. References are bound to
+ * data that outlives them, so they never hold a count of their own.
+ */
+bool cgen::is_counted(const data_type& t) const
+{
+    return t.get_primary() == enumerations::primitive_type::PTR && t.get_qualities().is_managed() && !_micro &&
+        _allocation_mode == enumerations::allocation_mode::POOLED_ALLOCATION;
+}
+
+/**
+ * Checks that a value may be held by a counted pointer.
+ *
+ * The count is kept in front of the resource, so a counted pointer may only be given the address of dynamic data,
+ * not of automatic or static data or of part of a resource; those must be held by `unmanaged` pointers.
+ */
+void cgen::check_counted_value(const expression::expression_base& value, unsigned int line)
+{
+    if (value.get_expression_type() != enumerations::expression_type::UNARY ||
+        static_cast<const expression::unary&>(value).get_operator() != enumerations::exp_operator::ADDRESS)
+    {
+        return;
+    }
+
+    const expression::expression_base& operand = static_cast<const expression::unary&>(value).get_operand();
+    if (operand.get_expression_type() != enumerations::expression_type::IDENTIFIER ||
+        !find_symbol(static_cast<const expression::identifier&>(operand).getValue(), line).get_type().get_qualities().is_dynamic())
+    {
+        throw error::compiler_exception(
+            "Managed pointers may only hold the addresses of dynamic data; use an 'unmanaged' pointer instead",
+            error_code::TYPE_ERROR,
+            line
+        );
+    }
+}
+
+/**
+ * Generates the code that releases the given locals.
+ */
+std::string cgen::gen_release_locals(const std::vector<const symbol*>& locals, unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    std::stringstream code;
+
+    // strings own their buffers directly, so they are released individually
+    std::vector<const symbol*> resources;
+    for (const symbol* local : locals)
+    {
+        if (local->get_type().get_primary() == enumerations::primitive_type::STRING && !local->get_type().get_qualities().is_dynamic())
+        {
+            code << "sinl_string_release(&" << get_c_name(*local) << ");\n";
+        }
+        else
+        {
+            resources.push_back(local);
+        }
+    }
+
+    // release the managed resources with a single call
+    if (resources.size() == 1)
+    {
+        code << gen_release(get_c_name(*resources.front()), line);
+    }
+    else if (!resources.empty())
+    {
+        const std::string released = CONSTANT_BASE + "released";
+        code << "{\n";
+        code << "void *" << released << "[] = { ";
+        for (size_t i = 0; i < resources.size(); i++)
+        {
+            if (i > 0)
+                code << ", ";
+            code << get_c_name(*resources[i]);
+        }
+        code << " };\n";
+        code << as_statement(gen_cost_counter("SINL_COUNT_RELEASE", line, std::to_string(resources.size())));
+        code << "sinl_rc_release_batch_" << get_refcount_suffix(_refcount_mode) << "(" << released << ", " << resources.size() << ");\n";
+        code << "}\n";
     }
 
     return code.str();
 }
+
+/**
+ * Generates the code to run when the current scope exits, at the given line.
+ */
+std::string cgen::gen_scope_exit(unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    std::string code = gen_release_locals(_symbols.pop_locals(_scope), line);
+    if (_region_scopes.erase(_scope))
+    {
+        code += "sinl_region_reset(&" + CONSTANT_BASE + "region, " + get_region_mark(_scope) + ");\n";
+    }
+
+    return code;
+}
+
+/**
+ * Generates the code to run when a `return` at the given line leaves the function being generated.
+ *
+ * Every scope from the current one out to the function's exits, but their locals stay in scope, since the code that
+ * follows the return is still in them.
+ */
+std::string cgen::gen_function_exit(unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    const std::vector<std::string> function_scope(_scope.begin(), _scope.begin() + 1);
+    std::string code = gen_release_locals(_symbols.get_locals(function_scope), line);
+
+    // resetting the region to the outermost mark releases everything the function has allocated in it
+    for (size_t depth = 1; depth <= _scope.size(); depth++)
+    {
+        const std::vector<std::string> enclosing(_scope.begin(), _scope.begin() + depth);
+        if (_region_scopes.count(enclosing))
+        {
+            code += "sinl_region_reset(&" + CONSTANT_BASE + "region, " + get_region_mark(enclosing) + ");\n";
+            break;
+        }
+    }
+
+    return code;
+}
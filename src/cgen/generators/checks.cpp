@@ -0,0 +1,74 @@
+#include "../cgen.hpp"
+#include "../../parser/expression/indexed.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/general_utilities.hpp"
+
+using expression::indexed;
+
+/**
+ * Gets the address of the error site for checks made at `line`, defining it the first time the line needs one.
+ *
+ * A failed check passes its site to one of the runtime's shared error routines (see `sinl_error.h`), so that the check
+ * itself only needs to load one address on its failure path.
+ */
+std::string cgen::gen_error_site(unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    _includes.insert("sinl_error.h");
+
+    // checks on the same line share a site
+    auto it = _error_sites.find(std::make_pair<>(_source_filename, line));
+    if (it == _error_sites.end())
+    {
+        const std::string site = CONSTANT_BASE + "error_site_" + std::to_string(_error_sites.size());
+        _struct_definitions << "static const struct sinl_error_site " << site << " = SINL_ERROR_SITE(" <<
+            general_utilities::quote(_source_filename) << ", " << line << ");\n";
+        it = _error_sites.insert(std::make_pair<>(std::make_pair<>(_source_filename, line), "&" + site)).first;
+    }
+
+    return it->second;
+}
+
+/**
+ * Generates the index for an access to an array, checking it against the array's length at runtime if it must be.
+ *
+ * `array` is the address of the array, and `index` the index being accessed. Accesses the optimizer has proven to be
+ * in range use the index as it is; guarded accesses only check it if their guard, computed before the loop, is false,
+ * which it seldom is.
+ */
+std::string cgen::gen_bounds_check(const indexed& idx, const std::string& array, const std::string& index, unsigned int line)
+{
+    if (!idx.is_bounds_checked())
+    {
+        return index;
+    }
+
+    _includes.insert("sinl_array.h");
+
+    std::string check = "sinl_array_check(" + array + ", " + index + ", " + gen_error_site(line) + ")";
+
+    // only the checks that are made are counted, so guarded checks are counted inside the guard
+    const std::string counter = gen_cost_counter("SINL_COUNT_BOUNDS_CHECK", line);
+    if (!counter.empty())
+    {
+        check = "(" + counter + ", " + check + ")";
+    }
+
+    if (!idx.get_bounds_guard().empty())
+    {
+        return "(SINL_LIKELY(" + idx.get_bounds_guard() + ") ? (" + index + ") : " + check + ")";
+    }
+
+    return check;
+}
+
+/**
+ * Generates a pointer to be dereferenced, checking that it isn't null at runtime.
+ *
+ * The result has the type `const void *`, and must be cast back to the type of the pointer.
+ */
+std::string cgen::gen_null_check(const std::string& pointer, unsigned int line)
+{
+    return "sinl_check_null(" + pointer + ", " + gen_error_site(line) + ")";
+}
@@ -0,0 +1,762 @@
+#include "../cgen.hpp"
+#include "../../parser/expressions.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/data_widths.hpp"
+
+using namespace expression;
+
+/**
+ * Gets the C operator for a SIN binary operator that C has an equivalent for, or nullptr if it doesn't.
+ */
+const char* cgen::get_c_operator(enumerations::exp_operator op)
+{
+    using enumerations::exp_operator;
+
+    switch (op)
+    {
+    case exp_operator::PLUS:
+        return "+";
+    case exp_operator::MINUS:
+        return "-";
+    case exp_operator::MULT:
+        return "*";
+    case exp_operator::DIV:
+        return "/";
+    case exp_operator::MODULO:
+        return "%";
+    case exp_operator::EQUAL:
+        return "==";
+    case exp_operator::NOT_EQUAL:
+        return "!=";
+    case exp_operator::GREATER:
+        return ">";
+    case exp_operator::LESS:
+        return "<";
+    case exp_operator::GREATER_OR_EQUAL:
+        return ">=";
+    case exp_operator::LESS_OR_EQUAL:
+        return "<=";
+    case exp_operator::AND:
+        return "&&";
+    case exp_operator::OR:
+        return "||";
+    case exp_operator::BIT_AND:
+        return "&";
+    case exp_operator::BIT_OR:
+        return "|";
+    case exp_operator::BIT_XOR:
+        return "^";
+    case exp_operator::LEFT_SHIFT:
+        return "<<";
+    case exp_operator::RIGHT_SHIFT:
+        return ">>";
+    default:
+        return nullptr;
+    }
+}
+
+static bool is_comparison(enumerations::exp_operator op)
+{
+    using enumerations::exp_operator;
+
+    return op == exp_operator::EQUAL || op == exp_operator::NOT_EQUAL ||
+        op == exp_operator::GREATER || op == exp_operator::LESS ||
+        op == exp_operator::GREATER_OR_EQUAL || op == exp_operator::LESS_OR_EQUAL ||
+        op == exp_operator::AND || op == exp_operator::OR || op == exp_operator::XOR;
+}
+
+/**
+ * Gets the type of the value held by data of type `t`; references and dynamic data are used through their pointers.
+ */
+static data_type get_value_type(const data_type& t)
+{
+    data_type value = t.get_primary() == enumerations::primitive_type::REFERENCE ? t.get_subtype() : t;
+    value.get_qualities().remove_quality(enumerations::symbol_quality::DYNAMIC);
+    value.get_qualities().remove_quality(enumerations::symbol_quality::STATIC);
+    value.get_qualities().remove_quality(enumerations::symbol_quality::EXTERN);
+    return value;
+}
+
+/**
+ * Finds the symbol a name refers to from the current scope.
+ */
+const symbol& cgen::find_symbol(const std::string& name, unsigned int line) const
+{
+    const symbol* sym = _symbols.find(name, _scope);
+    if (!sym)
+    {
+        throw error::compiler_exception("Could not find symbol '" + name + "'", error_code::SYMBOL_NOT_FOUND_ERROR, line);
+    }
+
+    return *sym;
+}
+
+/**
+ * Finds the function called by a call expression.
+ */
+const function_symbol& cgen::find_function(const expression_base& name, unsigned int line) const
+{
+    if (name.get_expression_type() != enumerations::expression_type::IDENTIFIER)
+    {
+        throw error::compiler_exception("Only functions may be called by name", error_code::UNSUPPORTED_FEATURE, line);
+    }
+
+    const symbol& sym = find_symbol(static_cast<const identifier&>(name).getValue(), line);
+    if (sym.get_symbol_type() != enumerations::symbol_type::FUNCTION_SYMBOL)
+    {
+        throw error::invalid_symbol(line);
+    }
+
+    return static_cast<const function_symbol&>(sym);
+}
+
+/**
+ * Gets the type of the value an expression yields.
+ *
+ * References and dynamic data yield the data they refer to.
+ */
+data_type cgen::get_expression_type(const expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+    using enumerations::exp_operator;
+    using enumerations::primitive_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return static_cast<const literal&>(exp).get_data_type();
+    case expression_type::IDENTIFIER:
+    {
+        const symbol& sym = find_symbol(static_cast<const identifier&>(exp).getValue(), line);
+        if (sym.get_symbol_type() == enumerations::symbol_type::FUNCTION_SYMBOL)
+        {
+            throw error::invalid_symbol(line);
+        }
+
+        return get_value_type(sym.get_type());
+    }
+    case expression_type::KEYWORD_EXP:
+        return static_cast<const keyword&>(exp).get_type();
+    case expression_type::UNARY:
+    {
+        auto& u = static_cast<const unary&>(exp);
+        switch (u.get_operator())
+        {
+        case exp_operator::ADDRESS:
+            return data_type(primitive_type::PTR, get_expression_type(u.get_operand(), line), symbol_qualities());
+        case exp_operator::DEREFERENCE:
+        {
+            const data_type pointer = get_expression_type(u.get_operand(), line);
+            if (pointer.get_primary() != primitive_type::PTR)
+            {
+                throw error::illegal_indirection(line);
+            }
+
+            return get_value_type(pointer.get_subtype());
+        }
+        case exp_operator::NOT:
+            return data_type(primitive_type::BOOL);
+        default:
+            return get_expression_type(u.get_operand(), line);
+        }
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const binary&>(exp);
+        if (b.get_operator() == exp_operator::DOT)
+        {
+            const data_type left = get_expression_type(b.get_left(), line);
+            if (left.get_primary() == primitive_type::TUPLE)
+            {
+                const auto& index = static_cast<const literal&>(b.get_right());
+                return get_value_type(left.get_contained_types().at(std::stoul(index.get_value())));
+            }
+
+            const auto& member = static_cast<const identifier&>(b.get_right());
+            return get_value_type(_structs.find(left.get_struct_name(), line).find_member(member.getValue())->type);
+        }
+        else if (is_comparison(b.get_operator()))
+        {
+            return data_type(primitive_type::BOOL);
+        }
+
+        const data_type left = get_expression_type(b.get_left(), line);
+        const data_type right = get_expression_type(b.get_right(), line);
+        if (left.get_primary() == primitive_type::STRING || right.get_primary() == primitive_type::STRING)
+        {
+            return data_type(primitive_type::STRING);
+        }
+        else if (left.get_primary() == primitive_type::FLOAT || right.get_primary() == primitive_type::FLOAT)
+        {
+            const bool is_long = (left.get_primary() == primitive_type::FLOAT && left.get_qualities().is_long()) ||
+                (right.get_primary() == primitive_type::FLOAT && right.get_qualities().is_long());
+            data_type result(primitive_type::FLOAT);
+            if (is_long)
+                result.add_quality(enumerations::symbol_quality::LONG);
+            return result;
+        }
+
+        // integers are promoted to the wider of the two types, as they are in C
+        const data_type& wider = left.get_width() >= right.get_width() ? left : right;
+        return wider.get_primary() == primitive_type::INT ? wider : data_type(primitive_type::INT);
+    }
+    case expression_type::INDEXED:
+    {
+        const data_type array = get_expression_type(static_cast<const indexed&>(exp).get_to_index(), line);
+        if (array.get_primary() == primitive_type::STRING)
+        {
+            return data_type(primitive_type::CHAR);
+        }
+        else if (array.get_primary() != primitive_type::ARRAY)
+        {
+            throw error::type_not_subscriptable(line);
+        }
+
+        return get_value_type(array.get_subtype());
+    }
+    case expression_type::CALL_EXP:
+    case expression_type::PROC_EXP:
+        return find_function(static_cast<const procedure&>(exp).get_func_name(), line).get_type();
+    case expression_type::CAST:
+        return static_cast<const typecast&>(exp).get_new_type();
+    case expression_type::ATTRIBUTE:
+        return static_cast<const attribute_selection&>(exp).get_data_type();
+    default:
+        throw error::compiler_exception("Expected a value", error_code::INVALID_EXPRESSION_TYPE_ERROR, line);
+    }
+}
+
+/**
+ * Generates a C expression that evaluates a SIN expression.
+ *
+ * Data referred to by references and dynamic data are used through their pointers, so that the expression is an
+ * lvalue whenever the SIN expression is one.
+ */
+std::string cgen::gen_expression(const expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return gen_literal(static_cast<const literal&>(exp), line);
+    case expression_type::IDENTIFIER:
+        return gen_identifier(static_cast<const identifier&>(exp), line);
+    case expression_type::UNARY:
+        return gen_unary(static_cast<const unary&>(exp), line);
+    case expression_type::BINARY:
+        return gen_binary(static_cast<const binary&>(exp), line);
+    case expression_type::INDEXED:
+        return gen_indexed(static_cast<const indexed&>(exp), line);
+    case expression_type::ATTRIBUTE:
+        return gen_attribute(static_cast<const attribute_selection&>(exp), line);
+    case expression_type::CAST:
+        return gen_typecast(static_cast<const typecast&>(exp), line);
+    case expression_type::CALL_EXP:
+    case expression_type::PROC_EXP:
+        return gen_call(static_cast<const procedure&>(exp), line);
+    case expression_type::LIST:
+        throw error::compiler_exception(
+            "Lists may only be used to initialize or assign arrays and tuples",
+            error_code::INVALID_EXPRESSION_TYPE_ERROR,
+            line
+        );
+    default:
+        throw error::compiler_exception("Unsupported expression type", error_code::UNSUPPORTED_FEATURE, line);
+    }
+}
+
+/**
+ * Generates a literal; strings use their pooled object, and other literals are written as C literals of their type.
+ */
+std::string cgen::gen_literal(const literal& lit, unsigned int line)
+{
+    if (lit.get_data_type().get_primary() == enumerations::primitive_type::STRING)
+    {
+        _includes.insert("sinl_string.h");
+        return _literals.get_string(lit.get_value());
+    }
+
+    return _constants.evaluate(lit, _scope, line).to_c_literal();
+}
+
+std::string cgen::gen_identifier(const identifier& ident, unsigned int line)
+{
+    const symbol& sym = find_symbol(ident.getValue(), line);
+    if (sym.get_symbol_type() == enumerations::symbol_type::FUNCTION_SYMBOL)
+    {
+        throw error::invalid_symbol(line);
+    }
+
+    // references and dynamic data are pointers to the data they hold
+    const data_type& t = sym.get_type();
+    if (t.get_qualities().is_dynamic() || t.get_primary() == enumerations::primitive_type::REFERENCE)
+    {
+        return "(*" + get_c_name(sym) + ")";
+    }
+
+    return get_c_name(sym);
+}
+
+std::string cgen::gen_unary(const unary& u, unsigned int line)
+{
+    using enumerations::exp_operator;
+
+    switch (u.get_operator())
+    {
+    case exp_operator::UNARY_PLUS:
+        return "(+" + gen_expression(u.get_operand(), line) + ")";
+    case exp_operator::UNARY_MINUS:
+        return "(-" + gen_expression(u.get_operand(), line) + ")";
+    case exp_operator::NOT:
+        return "(!" + gen_expression(u.get_operand(), line) + ")";
+    case exp_operator::BIT_NOT:
+        return "(~" + gen_expression(u.get_operand(), line) + ")";
+    case exp_operator::ADDRESS:
+    {
+        // pointers to arrays don't know their lengths, which are read from the arrays themselves
+        const data_type t = get_expression_type(u.get_operand(), line);
+        if (t.get_primary() == enumerations::primitive_type::ARRAY && !t.get_qualities().is_soa())
+        {
+            data_type any_length = t;
+            any_length.set_array_length(0);
+            return "((" + gen_array_type(any_length, line) + " *)" + gen_address(u.get_operand(), line) + ")";
+        }
+
+        return gen_address(u.get_operand(), line);
+    }
+    case exp_operator::DEREFERENCE:
+    {
+        const data_type t = get_expression_type(u.get_operand(), line);
+        if (t.get_primary() != enumerations::primitive_type::PTR)
+        {
+            throw error::illegal_indirection(line);
+        }
+
+        // pointers may be null, so they are checked before they are followed
+        const std::string pointer = gen_null_check(gen_expression(u.get_operand(), line), line);
+        return "(*(" + gen_c_type(t.get_subtype(), line) + " *)" + pointer + ")";
+    }
+    default:
+        throw error::illegal_unary_operator(line);
+    }
+}
+
+std::string cgen::gen_binary(const binary& b, unsigned int line)
+{
+    using enumerations::exp_operator;
+    using enumerations::primitive_type;
+
+    if (b.get_operator() == exp_operator::DOT)
+    {
+        return gen_member(b, line);
+    }
+
+    const data_type left = get_expression_type(b.get_left(), line);
+    const data_type right = get_expression_type(b.get_right(), line);
+    const std::string left_exp = gen_expression(b.get_left(), line);
+    const std::string right_exp = gen_expression(b.get_right(), line);
+
+    if (left.get_primary() == primitive_type::STRING || right.get_primary() == primitive_type::STRING)
+    {
+        if (left.get_primary() != right.get_primary() ||
+            (b.get_operator() != exp_operator::EQUAL && b.get_operator() != exp_operator::NOT_EQUAL))
+        {
+            throw error::compiler_exception(
+                "Strings may only be compared for equality here; concatenations must be assigned to a string",
+                error_code::OPERATOR_TYPE_ERROR,
+                line
+            );
+        }
+
+        return std::string(b.get_operator() == exp_operator::NOT_EQUAL ? "!" : "") +
+            "sinl_string_equal(&" + left_exp + ", &" + right_exp + ")";
+    }
+    else if (b.get_operator() == exp_operator::XOR)
+    {
+        return "(!" + left_exp + " != !" + right_exp + ")";
+    }
+
+    const char* op = get_c_operator(b.get_operator());
+    if (!op)
+    {
+        throw error::undefined_operator("binary", line);
+    }
+
+    return "(" + left_exp + " " + op + " " + right_exp + ")";
+}
+
+/**
+ * Generates an access to a member of a struct or tuple.
+ */
+std::string cgen::gen_member(const binary& b, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    const data_type left = get_expression_type(b.get_left(), line);
+    if (left.get_primary() == primitive_type::TUPLE)
+    {
+        if (b.get_right().get_expression_type() != enumerations::expression_type::LITERAL ||
+            static_cast<const literal&>(b.get_right()).get_data_type().get_primary() != primitive_type::INT)
+        {
+            throw error::compiler_exception(
+                "Tuple members must be selected with an integer literal",
+                error_code::TUPLE_MEMBER_SELECTION_ERROR,
+                line
+            );
+        }
+
+        const std::string& index = static_cast<const literal&>(b.get_right()).get_value();
+        if (std::stoul(index) >= left.get_contained_types().size())
+        {
+            throw error::compiler_exception("Tuple has no member " + index, error_code::TUPLE_MEMBER_SELECTION_ERROR, line);
+        }
+
+        return gen_expression(b.get_left(), line) + "._" + index;
+    }
+    else if (left.get_primary() != primitive_type::STRUCT)
+    {
+        throw error::compiler_exception(
+            "The left-hand side of the dot operator must be a struct or tuple",
+            error_code::STRUCT_TYPE_EXPECTED_ERROR,
+            line
+        );
+    }
+    else if (b.get_right().get_expression_type() != enumerations::expression_type::IDENTIFIER)
+    {
+        throw error::invalid_member_selection(line);
+    }
+
+    const std::string& member = static_cast<const identifier&>(b.get_right()).getValue();
+    const utility::struct_member* m = _structs.find(left.get_struct_name(), line).find_member(member);
+    if (!m)
+    {
+        throw error::compiler_exception(
+            "Struct '" + left.get_struct_name() + "' has no member '" + member + "'",
+            error_code::STRUCT_MEMBER_SELECTION_ERROR,
+            line
+        );
+    }
+
+    // the elements of `soa` arrays are spread across a column for each member, so they are reached through the member
+    std::string access;
+    const data_type array = b.get_left().get_expression_type() == enumerations::expression_type::INDEXED ?
+        get_expression_type(static_cast<const indexed&>(b.get_left()).get_to_index(), line) :
+        data_type();
+    if (array.get_qualities().is_soa())
+    {
+        auto& idx = static_cast<const indexed&>(b.get_left());
+        const std::string index = gen_expression(idx.get_index_value(), line);
+        const std::string checked = idx.is_bounds_checked() ? gen_bounds_check(idx, gen_address(idx.get_to_index(), line), index, line) : index;
+        access = gen_indexed_member(gen_expression(idx.get_to_index(), line), array, checked, member);
+    }
+    else
+    {
+        access = gen_expression(b.get_left(), line) + "." + member;
+    }
+
+    // dynamic members are pointers to their data
+    return m->type.get_qualities().is_dynamic() ? "(*" + access + ")" : access;
+}
+
+std::string cgen::gen_indexed(const indexed& idx, unsigned int line)
+{
+    const data_type t = get_expression_type(idx.get_to_index(), line);
+    const std::string index = gen_expression(idx.get_index_value(), line);
+
+    if (t.get_primary() == enumerations::primitive_type::STRING)
+    {
+        // strings begin with their lengths, as arrays do, so they are checked the same way
+        const std::string str = "&" + gen_expression(idx.get_to_index(), line);
+        return "sinl_string_at(" + str + ", " + gen_bounds_check(idx, str, index, line) + ")";
+    }
+    else if (t.get_primary() != enumerations::primitive_type::ARRAY)
+    {
+        throw error::type_not_subscriptable(line);
+    }
+    else if (t.get_qualities().is_soa())
+    {
+        throw error::compiler_exception(
+            "The elements of 'soa' arrays may only be used to select their members",
+            error_code::UNSUPPORTED_FEATURE,
+            line
+        );
+    }
+
+    // element-wise loops reach their arrays' elements through pointers hoisted out of the loop
+    if (!_element_pointers.empty() && idx.get_to_index().get_expression_type() == enumerations::expression_type::IDENTIFIER)
+    {
+        const std::string& name = static_cast<const identifier&>(idx.get_to_index()).getValue();
+        if (_element_pointers.count(name))
+        {
+            return gen_element_access(name, index);
+        }
+    }
+
+    const std::string checked = idx.is_bounds_checked() ? gen_bounds_check(idx, gen_address(idx.get_to_index(), line), index, line) : index;
+    return gen_array_element(idx.get_to_index(), t, checked, line);
+}
+
+/**
+ * Checks whether an expression designates data that may be assigned to or have its address taken.
+ */
+bool cgen::is_lvalue(const expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::IDENTIFIER:
+        return find_symbol(static_cast<const identifier&>(exp).getValue(), line).get_symbol_type() == enumerations::symbol_type::VARIABLE;
+    case expression_type::BINARY:
+        return static_cast<const binary&>(exp).get_operator() == enumerations::exp_operator::DOT;
+    case expression_type::INDEXED:
+        // characters are read out of strings by value
+        return get_expression_type(static_cast<const indexed&>(exp).get_to_index(), line).get_primary() != enumerations::primitive_type::STRING;
+    case expression_type::UNARY:
+        return static_cast<const unary&>(exp).get_operator() == enumerations::exp_operator::DEREFERENCE;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Checks whether an lvalue holds its data in place, rather than through a pointer; references and dynamic data, and
+ * anything reached by dereferencing a pointer, are held elsewhere.
+ */
+bool cgen::holds_storage(const expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::IDENTIFIER:
+    {
+        const data_type& t = find_symbol(static_cast<const identifier&>(exp).getValue(), line).get_type();
+        return !t.get_qualities().is_dynamic() && t.get_primary() != enumerations::primitive_type::REFERENCE;
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const binary&>(exp);
+        const data_type left = get_expression_type(b.get_left(), line);
+        if (left.get_primary() != enumerations::primitive_type::STRUCT)
+        {
+            return true;
+        }
+
+        const auto& member = static_cast<const identifier&>(b.get_right());
+        const utility::struct_member* m = _structs.find(left.get_struct_name(), line).find_member(member.getValue());
+        return !m || !m->type.get_qualities().is_dynamic();
+    }
+    case expression_type::INDEXED:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * Generates the address of an lvalue.
+ *
+ * References and dynamic data are already pointers to their data.
+ */
+std::string cgen::gen_address(const expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    if (!is_lvalue(exp, line))
+    {
+        throw error::compiler_exception(
+            "Only lvalues have addresses",
+            error_code::ILLEGAL_ADDRESS_OF_ARGUMENT,
+            line
+        );
+    }
+    else if (exp.get_expression_type() == expression_type::IDENTIFIER && !holds_storage(exp, line))
+    {
+        return get_c_name(find_symbol(static_cast<const identifier&>(exp).getValue(), line));
+    }
+    else if (exp.get_expression_type() == expression_type::UNARY)
+    {
+        return gen_expression(static_cast<const unary&>(exp).get_operand(), line);
+    }
+
+    return "&" + gen_expression(exp, line);
+}
+
+/**
+ * Generates an access to the element of an array, of type `t`, at `index`.
+ *
+ * Arrays held in place are accessed through their storage types. Any other array is behind a pointer, and its elements
+ * are found at runtime; see `SINL_ARRAY_DATA`.
+ */
+std::string cgen::gen_array_element(const expression_base& array, const data_type& t, const std::string& index, unsigned int line)
+{
+    if (holds_storage(array, line))
+    {
+        return gen_expression(array, line) + ".data[" + index + "]";
+    }
+
+    _includes.insert("sinl_array.h");
+    return "SINL_ARRAY_DATA(" + gen_address(array, line) + ", " + gen_c_type(t.get_subtype(), line) + ")[" + index + "]";
+}
+
+/**
+ * Generates the length of a string or array.
+ */
+std::string cgen::gen_array_length(const expression_base& array, const data_type& t, unsigned int line)
+{
+    if (t.get_primary() == enumerations::primitive_type::STRING)
+    {
+        return "sinl_string_length(&" + gen_expression(array, line) + ")";
+    }
+    else if (holds_storage(array, line))
+    {
+        return gen_expression(array, line) + ".len";
+    }
+
+    _includes.insert("sinl_array.h");
+    return "sinl_array_length(" + gen_address(array, line) + ")";
+}
+
+std::string cgen::gen_attribute(const attribute_selection& attr, unsigned int line)
+{
+    using enumerations::attribute;
+    using enumerations::primitive_type;
+
+    const data_type t = get_expression_type(attr.get_selected(), line);
+    switch (attr.get_attribute())
+    {
+    case attribute::LENGTH:
+    {
+        if (t.get_primary() == primitive_type::STRING || t.get_primary() == primitive_type::ARRAY)
+        {
+            return gen_array_length(attr.get_selected(), t, line);
+        }
+        else if (t.get_primary() == primitive_type::STRUCT)
+        {
+            return std::to_string(_structs.find(t.get_struct_name(), line).get_members().size()) + "U";
+        }
+        else if (t.get_primary() == primitive_type::TUPLE)
+        {
+            return std::to_string(t.get_contained_types().size()) + "U";
+        }
+
+        return "1U";
+    }
+    case attribute::SIZE:
+    {
+        if (t.get_primary() == primitive_type::STRING)
+        {
+            return "(" + std::to_string(sin_widths::INT_WIDTH) + "U + " + gen_array_length(attr.get_selected(), t, line) + ")";
+        }
+        else if (t.get_primary() == primitive_type::ARRAY && !holds_storage(attr.get_selected(), line))
+        {
+            // arrays behind pointers may have any length
+            return "(uint32_t)(SINL_ARRAY_HEADER_SIZE + " + gen_array_length(attr.get_selected(), t, line) + " * " +
+                std::to_string(_structs.get_width(t.get_subtype())) + ")";
+        }
+
+        return std::to_string(_structs.get_width(t)) + "U";
+    }
+    case attribute::VARIABILITY:
+    {
+        const data_type declared = attr.get_selected().get_expression_type() == enumerations::expression_type::IDENTIFIER ?
+            find_symbol(static_cast<const identifier&>(attr.get_selected()).getValue(), line).get_type() : t;
+        return declared.get_qualities().is_const() ? "0U" : (declared.get_qualities().is_final() ? "1U" : "2U");
+    }
+    default:
+        throw error::compiler_exception("Unknown attribute", error_code::UNKNOWN_ATTRIBUTE, line);
+    }
+}
+
+std::string cgen::gen_typecast(const typecast& cast, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    const data_type from = get_expression_type(cast.get_exp(), line);
+    const data_type& to = cast.get_new_type();
+
+    // only scalars may be converted
+    auto is_scalar = [](const data_type& t) {
+        return t.get_primary() == primitive_type::INT || t.get_primary() == primitive_type::FLOAT ||
+            t.get_primary() == primitive_type::BOOL || t.get_primary() == primitive_type::CHAR ||
+            t.get_primary() == primitive_type::PTR;
+    };
+    if (!is_scalar(from) || !is_scalar(to))
+    {
+        throw error::illegal_typecast(line);
+    }
+
+    return "((" + gen_c_type(to, line) + ")" + gen_expression(cast.get_exp(), line) + ")";
+}
+
+/**
+ * Generates a call to a function, passing the default values of any parameters the call leaves out.
+ *
+ * Strings are passed by value, so each argument is copied for the callee, which owns it; a string returned by a call
+ * is already a copy, and is passed as it is.
+ */
+std::string cgen::gen_call(const procedure& call, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    const function_symbol& func = find_function(call.get_func_name(), line);
+    const std::vector<function_parameter>& parameters = func.get_parameters();
+    if (call.get_num_args() < func.get_required_arguments() || call.get_num_args() > parameters.size())
+    {
+        throw error::signature_mismatch(line);
+    }
+
+    std::string code = func.get_name() + "(";
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        const function_parameter& param = parameters[i];
+        const expression_base& arg = i < call.get_num_args() ? call.get_arg(i) : *param.default_value;
+        const data_type arg_type = get_expression_type(arg, line);
+        if (!param.type.is_compatible(arg_type))
+        {
+            throw error::compiler_exception(
+                "Argument " + std::to_string(i + 1) + " to '" + func.get_name() + "' has the wrong type",
+                error_code::SIGNATURE_MISMATCH,
+                line
+            );
+        }
+
+        if (is_counted(param.type))
+        {
+            check_counted_value(arg, line);
+        }
+
+        if (i > 0)
+            code += ", ";
+
+        const bool is_call = arg.get_expression_type() == enumerations::expression_type::CALL_EXP ||
+            arg.get_expression_type() == enumerations::expression_type::PROC_EXP;
+        if (param.type.get_primary() == primitive_type::STRING && !is_call)
+        {
+            code += "sinl_string_copy(&" + gen_expression(arg, line) + ", " + gen_error_site(line) + ")";
+        }
+        else if (param.type.get_primary() == primitive_type::REFERENCE &&
+            !(arg.get_expression_type() == enumerations::expression_type::UNARY &&
+                static_cast<const unary&>(arg).get_operator() == enumerations::exp_operator::ADDRESS))
+        {
+            // references may be bound to lvalues directly; arrays of any length bind to a reference to an array
+            const data_type referenced = param.type.get_subtype();
+            if (referenced.get_primary() == primitive_type::ARRAY && !referenced.get_qualities().is_soa())
+            {
+                code += "(" + gen_c_type(param.type, line) + ")" + gen_address(arg, line);
+            }
+            else
+            {
+                code += gen_address(arg, line);
+            }
+        }
+        else
+        {
+            code += gen_expression(arg, line);
+        }
+    }
+
+    return code + ")";
+}
@@ -0,0 +1,289 @@
+#include "../cgen.hpp"
+#include "../../util/trace.hpp"
+
+using statement::function_definition;
+
+/**
+ * Counts the statements in a block, including those nested in its blocks, branches, and loops.
+ */
+static size_t count_statements(const statement::statement_block& block)
+{
+    using enumerations::statement_type;
+
+    size_t count = 0;
+    for (const auto& s: block.statements_list)
+    {
+        count++;
+        switch (s->get_statement_type())
+        {
+        case statement_type::SCOPED_BLOCK:
+            count += count_statements(static_cast<const statement::scoped_block&>(*s).get_statements());
+            break;
+        case statement_type::IF_THEN_ELSE:
+        {
+            const auto& ite = static_cast<const statement::if_else&>(*s);
+            for (const statement::statement_base* branch: { ite.get_if_branch(), ite.get_else_branch() })
+            {
+                if (branch && branch->get_statement_type() == statement_type::SCOPED_BLOCK)
+                    count += count_statements(static_cast<const statement::scoped_block&>(*branch).get_statements());
+                else if (branch)
+                    count++;
+            }
+            break;
+        }
+        case statement_type::WHILE_LOOP:
+        {
+            const statement::statement_base* branch = static_cast<const statement::while_loop&>(*s).get_branch();
+            if (branch && branch->get_statement_type() == statement_type::SCOPED_BLOCK)
+                count += count_statements(static_cast<const statement::scoped_block&>(*branch).get_statements());
+            else if (branch)
+                count++;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Generates the storage class of a function.
+ *
+ * When the whole program is in one translation unit, nothing outside it can call a function unless it is `extern` or
+ * the entry point, so the others are made `static`, and those small enough are made `static inline` so that the C
+ * compiler may inline them into callers from any unit. Otherwise, functions keep the default linkage.
+ */
+std::string cgen::gen_function_linkage(const function_definition& def) const
+{
+    if (!_whole_program || def.get_type_information().get_qualities().is_extern() || def.get_name() == "main")
+    {
+        return "";
+    }
+
+    return count_statements(def.get_procedure()) <= INLINE_STATEMENT_LIMIT ? "static inline " : "static ";
+}
+
+/**
+ * Adds a function to the symbol table, or checks a function that is already there against a new declaration of it.
+ *
+ * The parameters are the allocations of a definition or the declarations of a `decl`. Strings are passed by value,
+ * and the function owns its copies; dynamic and static data can't be passed.
+ */
+const function_symbol& cgen::add_function(const std::string& name,
+                                          const data_type& return_type,
+                                          const std::vector<const statement::statement_base*>& parameters,
+                                          bool defined,
+                                          unsigned int line)
+{
+    using enumerations::statement_type;
+
+    std::vector<function_parameter> formal_parameters;
+    for (const statement::statement_base* p: parameters)
+    {
+        function_parameter param;
+        if (p->get_statement_type() == statement_type::ALLOCATION)
+        {
+            const auto& alloc = static_cast<const statement::allocation&>(*p);
+            param = { alloc.get_name(), alloc.get_type_information(), alloc.was_initialized() ? alloc.get_initial_value() : nullptr };
+        }
+        else if (p->get_statement_type() == statement_type::DECLARATION)
+        {
+            const auto& decl = static_cast<const statement::declaration&>(*p);
+            param = { decl.get_name(), decl.get_type_information(), decl.get_initial_value() };
+        }
+        else
+        {
+            throw error::compiler_exception("Invalid formal parameter", error_code::SIGNATURE_ERROR, line);
+        }
+
+        if (param.type.get_qualities().is_dynamic() || param.type.get_qualities().is_static())
+        {
+            throw error::compiler_exception(
+                "Parameters may not be 'dynamic' or 'static'; pass a pointer or reference instead",
+                error_code::UNSUPPORTED_FEATURE,
+                line
+            );
+        }
+
+        evaluate_array_length(param.type, line);
+        formal_parameters.push_back(param);
+    }
+
+    symbol* existing = _symbols.find(name, { });
+    if (!existing)
+    {
+        auto func = std::make_unique<function_symbol>(name, return_type, formal_parameters, defined, line);
+        const function_symbol& added = *func;
+        _symbols.add_symbol(std::move(func));
+        return added;
+    }
+    else if (existing->get_symbol_type() != enumerations::symbol_type::FUNCTION_SYMBOL)
+    {
+        throw error::duplicate_symbol(line);
+    }
+
+    auto& func = static_cast<function_symbol&>(*existing);
+    if (func.is_defined() && defined)
+    {
+        throw error::compiler_exception(
+            "Function '" + name + "' was already defined",
+            error_code::DUPLICATE_DEFINITION_ERROR,
+            line
+        );
+    }
+
+    // every declaration of a function must agree with the others
+    bool matches = func.get_type() == return_type && func.get_parameters().size() == formal_parameters.size();
+    for (size_t i = 0; matches && i < formal_parameters.size(); i++)
+    {
+        matches = func.get_parameters()[i].type == formal_parameters[i].type;
+    }
+
+    if (!matches)
+    {
+        throw error::signature_mismatch(line);
+    }
+    else if (defined)
+    {
+        func.set_defined();
+    }
+
+    return func;
+}
+
+/**
+ * Generates the signature of a function, without its storage class.
+ *
+ * The entry point takes no arguments and returns the program's exit status.
+ */
+std::string cgen::gen_function_signature(const function_symbol& func, unsigned int line)
+{
+    const bool is_void = func.get_type().get_primary() == enumerations::primitive_type::VOID;
+    if (func.get_name() == "main")
+    {
+        if (!func.get_parameters().empty())
+        {
+            throw error::compiler_exception("'main' may not take arguments", error_code::UNSUPPORTED_FEATURE, line);
+        }
+        else if (func.get_type().get_primary() != enumerations::primitive_type::INT)
+        {
+            throw error::compiler_exception("'main' must return 'int'", error_code::SIGNATURE_ERROR, line);
+        }
+
+        return "int main(void)";
+    }
+
+    std::string signature = (is_void ? "void" : gen_c_type(func.get_type(), line)) + " " + func.get_name() + "(";
+    for (size_t i = 0; i < func.get_parameters().size(); i++)
+    {
+        const function_parameter& param = func.get_parameters()[i];
+        signature += (i ? ", " : "") + gen_c_type(param.type, line) + " " + param.name;
+    }
+
+    return signature + (func.get_parameters().empty() ? "void)" : ")");
+}
+
+/**
+ * Declares a function defined in the unit, whose body is generated once the rest of the unit has been, so that it may
+ * use anything at file scope.
+ */
+void cgen::declare_function(const function_definition& def, bool defined)
+{
+    const function_symbol& func = add_function(
+        def.get_name(),
+        def.get_type_information(),
+        def.get_formal_parameters(),
+        defined,
+        def.get_line_number()
+    );
+
+    // a definition's prototype carries its storage class, which every declaration of it must share, and the prototype
+    // of one defined in this unit carries its attributes, so that calls to cold functions are treated as unlikely
+    const std::string attributes = defined ? gen_function_attributes(def) : "";
+    _prototypes[def.get_name()] = attributes + gen_function_linkage(def) + gen_function_signature(func, def.get_line_number()) + ";\n";
+}
+
+/**
+ * Declares a function or data defined elsewhere.
+ */
+void cgen::gen_declaration(const statement::declaration& decl)
+{
+    const unsigned int line = decl.get_line_number();
+    if (decl.is_struct())
+    {
+        // structs must be defined before they are used, so a declaration adds nothing
+        return;
+    }
+    else if (decl.is_function())
+    {
+        const function_symbol& func = add_function(decl.get_name(), decl.get_type_information(), decl.get_formal_parameters(), false, line);
+        if (!_prototypes.count(decl.get_name()))
+        {
+            _prototypes[decl.get_name()] = gen_function_signature(func, line) + ";\n";
+        }
+
+        return;
+    }
+
+    data_type t = decl.get_type_information();
+    evaluate_array_length(t, line);
+    if (!_symbols.contains(decl.get_name(), _scope, t))
+    {
+        _symbols.add_symbol(symbol{ decl.get_name(), _scope, t, false, line });
+        if (t.get_primary() == enumerations::primitive_type::STRING)
+        {
+            _includes.insert("sinl_string.h");
+        }
+        _declarations << "extern " << gen_c_type(t, line) << " " << decl.get_name() << ";\n";
+    }
+}
+
+/**
+ * Generates the definition of a function declared by `declare_function`.
+ *
+ * The function's parameters and locals are in a scope named for it, and each of its blocks has a scope of its own.
+ */
+std::string cgen::gen_function_definition(const function_definition& def)
+{
+    const unsigned int line = def.get_line_number();
+    const function_symbol& func = static_cast<const function_symbol&>(*_symbols.find(def.get_name(), { }));
+    general_utilities::trace::span generating("function", "generate", def.get_name());
+
+    _function = &func;
+    _scope = { def.get_name() };
+    _block_count = 0;
+
+    std::stringstream code;
+    code << gen_function_attributes(def) << gen_function_linkage(def) << gen_function_signature(func, line) << "\n{\n";
+    code << gen_profile_enter(def);
+
+    // string arguments are copies, which the function releases; counted pointers take a reference of their own,
+    // unless the optimizer found the function only borrows the caller's
+    const std::vector<function_parameter>& parameters = func.get_parameters();
+    const std::vector<const statement::statement_base*> formal_parameters = def.get_formal_parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+    {
+        const function_parameter& param = parameters[i];
+        const auto& alloc = static_cast<const statement::allocation&>(*formal_parameters[i]);
+        const bool counted = is_counted(param.type);
+        symbol sym{ param.name, _scope, param.type, true, line };
+        sym.set_as_parameter();
+        _symbols.add_symbol(std::move(sym), param.type.get_primary() == enumerations::primitive_type::STRING ||
+            (counted && alloc.needs_release()));
+        if (counted && alloc.needs_add_ref())
+        {
+            code << gen_add_ref(param.name, line);
+        }
+    }
+
+    // every function ends by returning, which releases its locals, so its scope is only removed here
+    code << gen_block(def.get_procedure());
+    gen_scope_exit(line);
+    code << "}\n";
+
+    _scope.clear();
+    _function = nullptr;
+    return code.str();
+}
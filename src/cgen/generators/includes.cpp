@@ -0,0 +1,131 @@
+#include "../cgen.hpp"
+#include "../../parser/parser.hpp"
+#include "../../parser/statements.hpp"
+#include "../../parser/expression/literal.hpp"
+#include "../../util/phase_report.hpp"
+
+#include <filesystem>
+
+/**
+ * Gets the name of an included file, which is relative to the directory of the file that includes it.
+ */
+static std::string get_include_path(const std::string& filename, const std::string& from)
+{
+    return (std::filesystem::path(from).parent_path() / filename).lexically_normal().string();
+}
+
+/**
+ * Includes a file, declaring everything it defines at file scope so that the unit including it may use it.
+ *
+ * Each file is only included once, however many times it is named; see docs/Includes.md.
+ */
+void cgen::gen_include(const statement::include& inc, const std::string& from)
+{
+    // files are included while symbols are collected, so their lexing and parsing is nested in this phase
+    general_utilities::phase_report::scope including("include", inc.get_filename());
+
+    std::string filename;
+    {
+        general_utilities::trace::span resolving("resolve include", "generate", inc.get_filename());
+        filename = get_include_path(inc.get_filename(), from);
+        if (!std::filesystem::exists(filename))
+        {
+            throw error::compiler_exception(
+                "Could not find included file '" + filename + "'",
+                error_code::FILE_NOT_FOUND_ERROR,
+                inc.get_line_number()
+            );
+        }
+    }
+
+    if (!_included.insert(filename).second)
+    {
+        return;
+    }
+
+    // the units of a whole program have already been parsed
+    auto unit = _program_units.find(filename);
+    if (unit != _program_units.end())
+    {
+        declare_unit(*unit->second, filename);
+        return;
+    }
+
+    parser p(filename);
+    {
+        general_utilities::phase_report::scope parsing("parse", filename);
+        _included_units.push_back(p.create_ast());
+    }
+    declare_unit(_included_units.back(), filename);
+}
+
+/**
+ * Declares the structs, functions, and data an included unit defines at file scope.
+ *
+ * Structs are defined again, as C requires, but functions and data are only declared; they are defined when their
+ * own unit is compiled. Constant strings initialized with literals are pooled, as they are in their own unit.
+ */
+void cgen::declare_unit(const statement::statement_block& unit, const std::string& filename)
+{
+    using s_type = enumerations::statement_type;
+
+    for (const auto& s: unit.statements_list)
+    {
+        switch (s->get_statement_type())
+        {
+        case s_type::INCLUDE:
+            gen_include(static_cast<const statement::include&>(*s), filename);
+            break;
+        case s_type::STRUCT_DEFINITION:
+        {
+            const auto& def = static_cast<const statement::struct_definition&>(*s);
+            if (!_structs.contains(def.get_name()))
+            {
+                _struct_definitions << gen_struct_definition(def);
+            }
+            break;
+        }
+        case s_type::FUNCTION_DEFINITION:
+            declare_function(static_cast<const statement::function_definition&>(*s), false);
+            break;
+        case s_type::DECLARATION:
+            gen_declaration(static_cast<const statement::declaration&>(*s));
+            break;
+        case s_type::ALLOCATION:
+        {
+            const auto& alloc = static_cast<const statement::allocation&>(*s);
+            data_type t = alloc.get_type_information();
+            evaluate_array_length(t, alloc.get_line_number());
+            if (_symbols.contains(alloc.get_name(), _scope, t))
+            {
+                break;
+            }
+
+            const expression::expression_base* init = alloc.was_initialized() ? alloc.get_initial_value() : nullptr;
+            symbol sym{ alloc.get_name(), _scope, t, false, alloc.get_line_number() };
+            if (t.get_qualities().is_const() && init)
+            {
+                _constants.add_constant(alloc.get_name(), _scope, t, init);
+                if (t.get_primary() == enumerations::primitive_type::STRING &&
+                    init->get_expression_type() == enumerations::expression_type::LITERAL)
+                {
+                    _includes.insert("sinl_string.h");
+                    _pooled_symbols[sym.get_decorated_name()] = _literals.get_string(static_cast<const expression::literal&>(*init).get_value());
+                    _symbols.add_symbol(std::move(sym));
+                    break;
+                }
+            }
+
+            if (t.get_primary() == enumerations::primitive_type::STRING)
+            {
+                _includes.insert("sinl_string.h");
+            }
+            _declarations << "extern " << gen_c_type(t, alloc.get_line_number()) << " " << alloc.get_name() << ";\n";
+            _symbols.add_symbol(std::move(sym));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
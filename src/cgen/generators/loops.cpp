@@ -0,0 +1,78 @@
+#include "../cgen.hpp"
+#include "../../util/constants.hpp"
+
+using statement::while_loop;
+
+/**
+ * Generates the code that runs before an element-wise loop, hoisting a `restrict` pointer to each array's elements out of it.
+ *
+ * Until `gen_element_loop` is called, element accesses in the loop body should be generated with `gen_element_access`.
+ */
+std::string cgen::gen_element_loop_preheader(const while_loop& loop)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    std::stringstream code;
+    const std::string id = std::to_string(_element_loop_count);
+
+    _includes.insert("sinl_array.h");
+    for (const auto& array: loop.get_element_arrays())
+    {
+        const std::string element = gen_c_type(array.second.get_subtype(), loop.get_line_number());
+        const std::string pointer = CONSTANT_BASE + "elements_" + id + "_" + array.first;
+
+        // dynamic arrays are already pointers to their storage
+        code << element << " *restrict " << pointer << " = SINL_ARRAY_DATA(" <<
+            (array.second.get_qualities().is_dynamic() ? "" : "&") << array.first << ", " << element << ");\n";
+        _element_pointers[array.first] = pointer;
+    }
+
+    return code.str();
+}
+
+/**
+ * Generates an element-wise loop that runs `body` until the loop's index reaches `bound`.
+ *
+ * The iterations are run in blocks of a fixed size so that the C compiler can vectorize them; any left over run one at a time.
+ */
+std::string cgen::gen_element_loop(const while_loop& loop, const std::string& bound, const std::string& body)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    std::stringstream code;
+    const std::string id = std::to_string(_element_loop_count++);
+    const std::string trip = CONSTANT_BASE + "trip_" + id;
+    const std::string blocks = CONSTANT_BASE + "blocks_" + id;
+    const std::string lane = CONSTANT_BASE + "lane_" + id;
+    const std::string& index = loop.get_induction_variable();
+
+    code << "const int64_t " << trip << " = " << bound << ";\n";
+    code << "for (int64_t " << blocks << " = sinl_array_blocks(" << index << ", " << trip << "); " <<
+        blocks << " > 0; " << blocks << "--)\n";
+    code << "{\n";
+    code << "SINL_ARRAY_IVDEP\n";
+    code << "for (int " << lane << " = 0; " << lane << " < SINL_ARRAY_VECTOR_BLOCK; " << lane << "++)\n";
+    code << "{\n" << body << "}\n";
+    code << "}\n";
+    code << "while (" << index << " < " << trip << ")\n";
+    code << "{\n" << body << "}\n";
+
+    _element_pointers.clear();
+    return code.str();
+}
+
+/**
+ * Generates an access to an element of an array, through its hoisted pointer if it has one.
+ *
+ * Accesses in element-wise loops have already had their bounds checks removed by the optimizer.
+ */
+std::string cgen::gen_element_access(const std::string& array, const std::string& index) const
+{
+    auto it = _element_pointers.find(array);
+    if (it == _element_pointers.end())
+    {
+        return array + "[" + index + "]";
+    }
+
+    return it->second + "[" + index + "]";
+}
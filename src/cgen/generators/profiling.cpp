@@ -0,0 +1,130 @@
+#include "../cgen.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/general_utilities.hpp"
+
+#include <algorithm>
+
+using general_utilities::quote;
+using statement::function_definition;
+
+/**
+ * Generates the code that begins a function's body when instrumenting, which records the call in the profile.
+ *
+ * The function's site is a static local, so it needs no name of its own; it holds the function's name as it appears
+ * in the SIN source, so that the profile may be read without knowing how symbols are decorated.
+ */
+std::string cgen::gen_profile_enter(const function_definition& def)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    if (!_instrument)
+    {
+        return "";
+    }
+
+    _includes.insert("sinl_profile.h");
+
+    const std::string site = CONSTANT_BASE + "profile_site";
+    std::stringstream code;
+    code << "static struct sinl_profile_site " << site << " = { " << quote(def.get_name()) << ", " <<
+        quote(_source_filename) << ", " << def.get_line_number() << ", 0 };\n";
+    code << "sinl_profile_enter(&" << site << ");\n";
+
+    return code.str();
+}
+
+/**
+ * Generates the code that records a function's return when instrumenting.
+ *
+ * This must be on every path out of the function, after the return value has been evaluated (so that any calls made
+ * to evaluate it are counted as the function's callees) but before the function's scope exits.
+ */
+std::string cgen::gen_profile_exit() const
+{
+    return _instrument ? "sinl_profile_exit();\n" : "";
+}
+
+/**
+ * Generates a call that counts `count` operations of the given kind (one of the `sinl_counter_kind` values) at `line`,
+ * when counting costs.
+ *
+ * The call is an expression, so that operations made within an expression may be counted too; statements must add
+ * their own terminator.
+ */
+std::string cgen::gen_cost_counter(const std::string& kind, unsigned int line, const std::string& count)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    if (!_count_costs)
+    {
+        return "";
+    }
+
+    _includes.insert("sinl_counters.h");
+
+    // sites are static so that each is counted wherever it is, and they are file-scope so that they may be used anywhere
+    const std::string site = CONSTANT_BASE + "count_site_" + std::to_string(_site_count++);
+    _struct_definitions << "static struct sinl_counter_site " << site << " = SINL_COUNTER_SITE(" <<
+        quote(_source_filename) << ", " << line << ", " << kind << ");\n";
+
+    return "sinl_counter_add(&" + site + ", " + count + ")";
+}
+
+/**
+ * Generates the attributes that mark a function hot or cold, according to the profile given with `--pgo-use`.
+ *
+ * The C compiler optimizes hot functions more aggressively and places them together, and optimizes cold ones for size
+ * and moves them out of the way; without a profile, or for functions in files it doesn't cover, nothing is emitted.
+ */
+std::string cgen::gen_function_attributes(const function_definition& def)
+{
+    using temperature = utility::profile_feedback::temperature;
+
+    switch (_profile.get_temperature(_source_filename, def.get_name()))
+    {
+    case temperature::HOT:
+        _includes.insert("sinl_common.h");
+        return "SINL_HOT ";
+    case temperature::COLD:
+        _includes.insert("sinl_common.h");
+        return "SINL_COLD ";
+    default:
+        return "";
+    }
+}
+
+/**
+ * Orders function definitions for output so that the hot functions come first, busiest first, and the cold ones last.
+ *
+ * Functions are otherwise left in the order they were given, so that output without a profile is unchanged.
+ */
+void cgen::order_functions(std::vector<const function_definition*>& functions) const
+{
+    using temperature = utility::profile_feedback::temperature;
+
+    if (!_profile.is_loaded())
+    {
+        return;
+    }
+
+    auto rank = [this](const function_definition* def)
+    {
+        switch (_profile.get_temperature(_source_filename, def->get_name()))
+        {
+        case temperature::HOT:
+            return 0;
+        case temperature::COLD:
+            return 2;
+        default:
+            return 1;
+        }
+    };
+
+    std::stable_sort(functions.begin(), functions.end(), [&](const function_definition* left, const function_definition* right) {
+        const int l = rank(left), r = rank(right);
+        if (l != r)
+            return l < r;
+
+        return l == 0 && _profile.get_weight(_source_filename, left->get_name()) > _profile.get_weight(_source_filename, right->get_name());
+    });
+}
@@ -0,0 +1,55 @@
+#include "../cgen.hpp"
+#include "../../util/constants.hpp"
+#include "../../util/data_widths.hpp"
+
+/**
+ * Gets the C type of a `soa` array of structs, defining it if this is the first array of its struct and length.
+ *
+ * The type holds the array's length, so that `len` and bounds checks work as they do for any other array, followed by
+ * one array for each of the struct's members.
+ */
+std::string cgen::gen_soa_type(const data_type& t, unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    const utility::struct_info& info = _structs.find(t.get_subtype().get_struct_name(), line);
+    const std::string length = std::to_string(t.get_array_length());
+    const std::string name = CONSTANT_BASE + "soa_" + info.get_name() + "_" + length;
+    if (!_soa_types.insert(name).second)
+    {
+        return name;
+    }
+
+    const bool aligned = data_type::get_array_header_size() > sin_widths::ARRAY_LENGTH_SIZE;
+    _includes.insert("sinl_array.h");
+
+    // the types of the columns are defined first, if they need to be
+    std::stringstream definition;
+    definition << "typedef struct " << name << "\n{\n";
+    definition << "uint32_t len;\n";
+    for (const auto& member: info.get_members())
+    {
+        definition << (aligned ? "SINL_ARRAY_ALIGNED " : "") << gen_c_type(member.type, line) << " " <<
+            member.name << "[" << length << "];\n";
+    }
+    definition << "} " << name << ";\n";
+    _struct_definitions << definition.str();
+
+    return name;
+}
+
+/**
+ * Generates an access to a member of an element of an array of structs, as in `a[i].x`.
+ *
+ * The access is rewritten to select the member's column when the array is `soa`; either way, the index must already
+ * have been checked against the array's length, which is at the head of both layouts.
+ */
+std::string cgen::gen_indexed_member(const std::string& array, const data_type& t, const std::string& index, const std::string& member) const
+{
+    if (t.get_qualities().is_soa())
+    {
+        return array + "." + member + "[" + index + "]";
+    }
+
+    return gen_element_access(array, index) + "." + member;
+}
@@ -0,0 +1,583 @@
+#include "../cgen.hpp"
+#include "../../parser/statements.hpp"
+#include "../../parser/expressions.hpp"
+#include "../../util/constants.hpp"
+
+using namespace statement;
+
+/**
+ * Checks whether an expression is a call, whose result is a new value the caller owns.
+ */
+static bool is_call(const expression::expression_base& exp)
+{
+    return exp.get_expression_type() == enumerations::expression_type::CALL_EXP ||
+        exp.get_expression_type() == enumerations::expression_type::PROC_EXP;
+}
+
+/**
+ * Gets the name at the root of an lvalue, such as `a` in `a.b[i]`, or nullptr if the lvalue is reached through a
+ * pointer.
+ */
+static const expression::identifier* get_root_identifier(const expression::expression_base& exp)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::IDENTIFIER:
+        return &static_cast<const expression::identifier&>(exp);
+    case expression_type::BINARY:
+        return get_root_identifier(static_cast<const expression::binary&>(exp).get_left());
+    case expression_type::INDEXED:
+        return get_root_identifier(static_cast<const expression::indexed&>(exp).get_to_index());
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * Collects the operands of a chain of string concatenations, such as `a + b + c`, in order.
+ */
+static void get_concatenated(const expression::expression_base& exp, std::vector<const expression::expression_base*>& operands)
+{
+    if (exp.get_expression_type() == enumerations::expression_type::BINARY &&
+        static_cast<const expression::binary&>(exp).get_operator() == enumerations::exp_operator::PLUS)
+    {
+        const auto& b = static_cast<const expression::binary&>(exp);
+        get_concatenated(b.get_left(), operands);
+        get_concatenated(b.get_right(), operands);
+    }
+    else
+    {
+        operands.push_back(&exp);
+    }
+}
+
+/**
+ * Checks whether a block ends by returning, after which the code to exit its scope would never run.
+ */
+static bool ends_in_return(const statement_block& block)
+{
+    return !block.statements_list.empty() &&
+        block.statements_list.back()->get_statement_type() == enumerations::statement_type::RETURN_STATEMENT;
+}
+
+std::string cgen::gen_statement(const statement_base& s)
+{
+    using s_type = enumerations::statement_type;
+
+    switch (s.get_statement_type())
+    {
+    case s_type::ALLOCATION:
+        return gen_allocation(static_cast<const allocation&>(s));
+    case s_type::ASSIGNMENT:
+        return gen_assignment(static_cast<const assignment&>(s));
+    case s_type::COMPOUND_ASSIGNMENT:
+        return gen_compound_assignment(static_cast<const compound_assignment&>(s));
+    case s_type::MOVEMENT:
+        return gen_movement(static_cast<const movement&>(s));
+    case s_type::CALL:
+    {
+        const expression::procedure& call = static_cast<const statement::call&>(s);
+        const data_type result = find_function(call.get_func_name(), s.get_line_number()).get_type();
+        const std::string discarded = general_utilities::constants::CONSTANT_BASE + "discarded";
+        if (result.get_primary() == enumerations::primitive_type::STRING)
+        {
+            // the string returned is the caller's, so it must be released even though it isn't used
+            return "{\nsinl_string " + discarded + " = " + gen_call(call, s.get_line_number()) + ";\n" +
+                "sinl_string_release(&" + discarded + ");\n}\n";
+        }
+        else if (is_counted(result))
+        {
+            // as must the reference a returned pointer holds
+            return "{\n" + gen_c_type(result, s.get_line_number()) + " " + discarded + " = " + gen_call(call, s.get_line_number()) +
+                ";\n" + gen_release(discarded, s.get_line_number()) + "}\n";
+        }
+
+        return gen_call(call, s.get_line_number()) + ";\n";
+    }
+    case s_type::RETURN_STATEMENT:
+        return gen_return(static_cast<const return_statement&>(s));
+    case s_type::IF_THEN_ELSE:
+        return gen_if_else(static_cast<const if_else&>(s));
+    case s_type::WHILE_LOOP:
+        return gen_while_loop(static_cast<const while_loop&>(s));
+    case s_type::SCOPED_BLOCK:
+        return gen_branch(s);
+    case s_type::DECLARATION:
+    case s_type::FUNCTION_DEFINITION:
+    case s_type::STRUCT_DEFINITION:
+        throw error::compiler_exception(
+            "Declarations and definitions must be at file scope",
+            error_code::ILLEGAL_OPERATION_ERROR,
+            s.get_line_number()
+        );
+    case s_type::INCLUDE:
+        throw error::compiler_exception(
+            "Files may only be included at file scope",
+            error_code::INCLUDE_SCOPE_ERROR,
+            s.get_line_number()
+        );
+    default:
+        throw error::compiler_exception("Unsupported statement type", error_code::UNSUPPORTED_FEATURE, s.get_line_number());
+    }
+}
+
+/**
+ * Generates the statements of a block in the current scope.
+ */
+std::string cgen::gen_block(const statement_block& block)
+{
+    std::string code;
+    for (const auto& s: block.statements_list)
+    {
+        code += gen_statement(*s);
+    }
+
+    return code;
+}
+
+/**
+ * Generates a branch of an `if` or `while`, or a scoped block, in a scope of its own.
+ *
+ * The scope is named for its position in the function so that its symbols are distinct from those of other blocks.
+ */
+std::string cgen::gen_branch(const statement_base& branch)
+{
+    _scope.push_back("block_" + std::to_string(_block_count++));
+
+    std::string code = "{\n";
+    bool returns = branch.get_statement_type() == enumerations::statement_type::RETURN_STATEMENT;
+    if (branch.get_statement_type() == enumerations::statement_type::SCOPED_BLOCK)
+    {
+        const statement_block& block = static_cast<const scoped_block&>(branch).get_statements();
+        code += gen_block(block);
+        returns = ends_in_return(block);
+    }
+    else
+    {
+        code += gen_statement(branch);
+    }
+
+    // the scope's locals are always removed, even if the block returns and its exit is never reached
+    const std::string exit = gen_scope_exit(branch.get_line_number());
+    if (!returns)
+    {
+        code += exit;
+    }
+    code += "}\n";
+
+    _scope.pop_back();
+    return code;
+}
+
+/**
+ * Checks that an lvalue may be assigned to.
+ *
+ * The qualities of data are those of the name it is reached through.
+ */
+void cgen::check_assignment(const expression::expression_base& lvalue, unsigned int line)
+{
+    if (!is_lvalue(lvalue, line))
+    {
+        throw error::not_an_lvalue(line);
+    }
+
+    const expression::identifier* root = get_root_identifier(lvalue);
+    if (root)
+    {
+        const data_type& t = find_symbol(root->getValue(), line).get_type();
+        if (t.get_qualities().is_const())
+        {
+            throw error::const_assignment(line);
+        }
+        else if (t.get_qualities().is_final())
+        {
+            throw error::final_assignment(line);
+        }
+    }
+}
+
+std::string cgen::gen_assignment(const assignment& assign)
+{
+    const unsigned int line = assign.get_line_number();
+    check_assignment(assign.get_lvalue(), line);
+    return gen_store(get_expression_type(assign.get_lvalue(), line), gen_expression(assign.get_lvalue(), line), assign.get_rvalue(), line,
+        assign.needs_add_ref(), holds_storage(assign.get_lvalue(), line));
+}
+
+/**
+ * Generates a compound assignment, such as `let a += b`, which is parsed as `let a = a + b`.
+ *
+ * The lvalue is only evaluated once, except for strings, which are appended to in place.
+ */
+std::string cgen::gen_compound_assignment(const compound_assignment& assign)
+{
+    const unsigned int line = assign.get_line_number();
+    const data_type t = get_expression_type(assign.get_lvalue(), line);
+    if (t.get_primary() == enumerations::primitive_type::STRING)
+    {
+        return gen_assignment(assign);
+    }
+
+    const char* op = get_c_operator(assign.get_operator());
+    if (!op)
+    {
+        throw error::undefined_operator("compound assignment", line);
+    }
+
+    check_assignment(assign.get_lvalue(), line);
+    if (!t.is_compatible(get_expression_type(assign.get_rvalue(), line)))
+    {
+        throw error::compiler_exception("The value's type is not compatible with the data it is stored in", error_code::TYPE_ERROR, line);
+    }
+
+    const auto& rvalue = static_cast<const expression::binary&>(assign.get_rvalue());
+    return gen_expression(assign.get_lvalue(), line) + " " + op + "= " + gen_expression(rvalue.get_right(), line) + ";\n";
+}
+
+/**
+ * Generates a movement; dynamic data moves by handing its memory to the destination, and anything else is copied as
+ * it would be by an assignment.
+ *
+ * See docs/Assignment and Movement.md.
+ */
+std::string cgen::gen_movement(const movement& move)
+{
+    using enumerations::expression_type;
+
+    const unsigned int line = move.get_line_number();
+    const expression::expression_base& source = move.get_rvalue();
+    if (!is_lvalue(source, line))
+    {
+        throw error::compiler_exception(
+            "Only modifiable lvalues may be moved",
+            error_code::ILLEGAL_MOVE_ASSIGNMENT_EXPRESSION,
+            line
+        );
+    }
+
+    const expression::expression_base& destination = move.get_lvalue();
+    if (destination.get_expression_type() == expression_type::IDENTIFIER)
+    {
+        const symbol& sym = find_symbol(static_cast<const expression::identifier&>(destination).getValue(), line);
+        if (sym.get_type().get_primary() == enumerations::primitive_type::REFERENCE)
+        {
+            throw error::compiler_exception("The referent of a reference may not be changed", error_code::MOVE_TO_REFERENCE_ERROR, line);
+        }
+        else if (sym.get_type().get_qualities().is_dynamic())
+        {
+            if (source.get_expression_type() != expression_type::IDENTIFIER ||
+                !find_symbol(static_cast<const expression::identifier&>(source).getValue(), line).get_type().get_qualities().is_dynamic())
+            {
+                throw error::compiler_exception(
+                    "Only dynamic data may be moved into dynamic data",
+                    error_code::ILLEGAL_MOVE_ASSIGNMENT_EXPRESSION,
+                    line
+                );
+            }
+            else if (!get_expression_type(destination, line).is_compatible(get_expression_type(source, line)))
+            {
+                throw error::type_error(line);
+            }
+
+            // both names then refer to the same resource, which they hold a reference to each, unless the optimizer
+            // found the source is never used again, in which case its reference is transferred
+            const std::string name = get_c_name(sym);
+            if (_allocation_mode != enumerations::allocation_mode::POOLED_ALLOCATION)
+            {
+                return name + " = " + gen_address(source, line) + ";\n";
+            }
+
+            const std::string moved = gen_address(source, line);
+            return (move.needs_add_ref() ? gen_add_ref(moved, line) : "") + gen_release(name, line) + name + " = " + moved + ";\n";
+        }
+    }
+
+    return gen_assignment(move);
+}
+
+/**
+ * Generates the code that stores `value` in `target`, an lvalue holding data of type `t`.
+ *
+ * Lists are stored element by element. Strings and arrays are copied, so that the target never shares memory with the
+ * value. Counted pointers add a reference to the resource they are given, unless `add_ref` is cleared. An array target
+ * that is not held in place, such as dynamic data, has its elements found at runtime, as in `gen_array_element`.
+ */
+std::string cgen::gen_store(const data_type& t, const std::string& target, const expression::expression_base& value, unsigned int line, bool add_ref,
+    bool in_place)
+{
+    using enumerations::primitive_type;
+
+    std::stringstream code;
+    if (value.get_expression_type() == enumerations::expression_type::LIST)
+    {
+        const auto& list = static_cast<const expression::list_expression&>(value);
+        const std::vector<const expression::expression_base*> elements = list.get_list();
+        if (t.get_primary() == primitive_type::ARRAY && !t.get_qualities().is_soa())
+        {
+            if (t.get_array_length() && elements.size() > t.get_array_length())
+            {
+                throw error::compiler_exception(
+                    "The list has more elements than the array has room for",
+                    error_code::OUT_OF_BOUNDS,
+                    line
+                );
+            }
+
+            std::string data = target + ".data";
+            if (!in_place)
+            {
+                _includes.insert("sinl_array.h");
+                data = "SINL_ARRAY_DATA(&" + target + ", " + gen_c_type(t.get_subtype(), line) + ")";
+            }
+
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                code << gen_store(t.get_subtype(), data + "[" + std::to_string(i) + "]", *elements[i], line);
+            }
+        }
+        else if (t.get_primary() == primitive_type::TUPLE)
+        {
+            if (elements.size() != t.get_contained_types().size())
+            {
+                throw error::compiler_exception(
+                    "The list must have one element for each member of the tuple",
+                    error_code::LIST_TYPE_MISMATCH,
+                    line
+                );
+            }
+
+            for (size_t i = 0; i < elements.size(); i++)
+            {
+                code << gen_store(t.get_contained_types()[i], target + "._" + std::to_string(i), *elements[i], line);
+            }
+        }
+        else
+        {
+            throw error::compiler_exception(
+                "Lists may only be used to initialize or assign arrays and tuples",
+                error_code::LIST_TYPE_MISMATCH,
+                line
+            );
+        }
+
+        return code.str();
+    }
+
+    const data_type value_type = get_expression_type(value, line);
+    if (!t.is_compatible(value_type))
+    {
+        throw error::compiler_exception("The value's type is not compatible with the data it is stored in", error_code::TYPE_ERROR, line);
+    }
+
+    if (t.get_primary() == primitive_type::STRING)
+    {
+        std::vector<const expression::expression_base*> operands;
+        get_concatenated(value, operands);
+        if (operands.size() == 1 && is_call(value))
+        {
+            // the string returned is already a copy, so it replaces the target's
+            const std::string result = general_utilities::constants::CONSTANT_BASE + "result";
+            code << "{\nsinl_string " << result << " = " << gen_expression(value, line) << ";\n";
+            code << "sinl_string_release(&" << target << ");\n";
+            code << target << " = " << result << ";\n}\n";
+            return code.str();
+        }
+
+        for (const auto* operand: operands)
+        {
+            if (is_call(*operand) || get_expression_type(*operand, line).get_primary() != primitive_type::STRING)
+            {
+                throw error::compiler_exception(
+                    "Only strings held in data or literals may be concatenated",
+                    error_code::UNSUPPORTED_FEATURE,
+                    line
+                );
+            }
+        }
+
+        const std::string site = gen_error_site(line);
+        if (operands.size() == 1)
+        {
+            code << "sinl_string_set(&" << target << ", &" << gen_expression(value, line) << ", " << site << ");\n";
+        }
+        else if (operands.size() == 2)
+        {
+            code << "sinl_string_append(&" << target << ", &" << gen_expression(*operands[0], line) << ", &" <<
+                gen_expression(*operands[1], line) << ", " << site << ");\n";
+        }
+        else
+        {
+            // the target may be any of the operands, so it is only replaced once the whole string has been built
+            const std::string joined = general_utilities::constants::CONSTANT_BASE + "joined";
+            code << "{\nsinl_string " << joined << " = SINL_STRING_EMPTY;\n";
+            code << "sinl_string_append(&" << joined << ", &" << gen_expression(*operands[0], line) << ", &" <<
+                gen_expression(*operands[1], line) << ", " << site << ");\n";
+            for (size_t i = 2; i < operands.size(); i++)
+            {
+                code << "sinl_string_append(&" << joined << ", &" << joined << ", &" << gen_expression(*operands[i], line) <<
+                    ", " << site << ");\n";
+            }
+            code << "sinl_string_release(&" << target << ");\n";
+            code << target << " = " << joined << ";\n}\n";
+        }
+
+        return code.str();
+    }
+    else if (t.get_primary() == primitive_type::ARRAY && !t.get_qualities().is_soa())
+    {
+        if (t.get_subtype().get_primary() == primitive_type::STRING || is_call(value))
+        {
+            throw error::compiler_exception(
+                "Arrays may only be copied from other arrays of values",
+                error_code::UNSUPPORTED_FEATURE,
+                line
+            );
+        }
+
+        // arrays of different lengths copy as many elements as fit
+        _includes.insert("sinl_array.h");
+        code << "sinl_array_copy(&" << target << ", " << gen_address(value, line) << ", sizeof " << target << ".data[0]);\n";
+        return code.str();
+    }
+
+    else if (is_counted(t))
+    {
+        // the new resource is retained before the old one is released, in case they are the same; a call's result
+        // already holds a reference, which the target adopts, as does a movement the optimizer found transfers one
+        check_counted_value(value, line);
+        const std::string stored = general_utilities::constants::CONSTANT_BASE + "stored";
+        code << "{\n" << gen_c_type(t, line) << " " << stored << " = " << gen_expression(value, line) << ";\n";
+        if (add_ref && !is_call(value))
+        {
+            code << gen_add_ref(stored, line);
+        }
+        code << gen_release(target, line);
+        code << target << " = " << stored << ";\n}\n";
+        return code.str();
+    }
+
+    code << target << " = " << gen_expression(value, line) << ";\n";
+    return code.str();
+}
+
+std::string cgen::gen_if_else(const if_else& ite)
+{
+    std::string code = "if (" + gen_expression(ite.get_condition(), ite.get_line_number()) + ")\n";
+    code += gen_branch(*ite.get_if_branch());
+    if (ite.get_else_branch())
+    {
+        code += "else\n" + gen_branch(*ite.get_else_branch());
+    }
+
+    return code;
+}
+
+/**
+ * Generates a `while` loop.
+ *
+ * Loops the optimizer marked element-wise only assign to scalars and to array elements at their index, so they are run
+ * in blocks the C compiler can vectorize, through element pointers and a bound hoisted out of the loop; see
+ * `gen_element_loop`. Those whose index or arrays are held through pointers are generated as they are written.
+ */
+std::string cgen::gen_while_loop(const while_loop& loop)
+{
+    const unsigned int line = loop.get_line_number();
+
+    bool element_wise = loop.is_element_wise();
+    if (element_wise)
+    {
+        const data_type& index = find_symbol(loop.get_induction_variable(), line).get_type();
+        element_wise = !index.get_qualities().is_dynamic();
+        for (const auto& array: loop.get_element_arrays())
+        {
+            const data_type& t = find_symbol(array.first, line).get_type();
+            element_wise = element_wise && t.get_primary() == enumerations::primitive_type::ARRAY && !t.get_qualities().is_soa();
+        }
+    }
+
+    if (!element_wise)
+    {
+        return "while (" + gen_expression(loop.get_condition(), line) + ")\n" + gen_branch(*loop.get_branch());
+    }
+
+    // the condition is `i < bound` or `bound > i`, and the bound doesn't change in the loop
+    const auto& condition = static_cast<const expression::binary&>(loop.get_condition());
+    const expression::expression_base& bound = condition.get_operator() == enumerations::exp_operator::LESS ?
+        condition.get_right() :
+        condition.get_left();
+
+    std::string code = "{\n" + gen_element_loop_preheader(loop);
+    const std::string trip = gen_expression(bound, line);
+
+    // the body only assigns, so it has no locals, and the same code runs in the blocks and in the remainder
+    std::string body;
+    const statement_base& branch = *loop.get_branch();
+    if (branch.get_statement_type() == enumerations::statement_type::SCOPED_BLOCK)
+    {
+        body = gen_block(static_cast<const scoped_block&>(branch).get_statements());
+    }
+    else
+    {
+        body = gen_statement(branch);
+    }
+
+    return code + gen_element_loop(loop, trip, body) + "}\n";
+}
+
+/**
+ * Generates a return from the function being generated.
+ *
+ * Strings are returned by value, so the caller receives a copy of its own.
+ */
+std::string cgen::gen_return(const return_statement& ret)
+{
+    using enumerations::primitive_type;
+
+    const unsigned int line = ret.get_line_number();
+    if (!_function)
+    {
+        throw error::illegal_return(line);
+    }
+
+    const data_type& return_type = _function->get_type();
+    const expression::expression_base& value = ret.get_return_exp();
+    const data_type value_type = get_expression_type(value, line);
+    if (return_type.get_primary() == primitive_type::VOID || value_type.get_primary() == primitive_type::VOID)
+    {
+        if (return_type.get_primary() != value_type.get_primary())
+        {
+            throw error::compiler_exception("The return value does not match the function's type", error_code::RETURN_MISMATCH_ERROR, line);
+        }
+
+        return gen_profile_exit() + gen_function_exit(line) + "return;\n";
+    }
+    else if (!return_type.is_compatible(value_type))
+    {
+        throw error::compiler_exception("The return value does not match the function's type", error_code::RETURN_MISMATCH_ERROR, line);
+    }
+
+    if (is_counted(return_type))
+    {
+        check_counted_value(value, line);
+    }
+
+    std::string returned = gen_expression(value, line);
+    if (return_type.get_primary() == primitive_type::STRING && !is_call(value))
+    {
+        returned = "sinl_string_copy(&" + returned + ", " + gen_error_site(line) + ")";
+    }
+
+    // the value is evaluated before the function's exit is recorded, so that any calls it makes are its callees, and
+    // before its scopes exit, so that it may use their locals; a returned pointer holds a reference for the caller
+    const std::string temp = general_utilities::constants::CONSTANT_BASE + "returned";
+    const std::string retained = is_counted(return_type) && !is_call(value) ? gen_add_ref(temp, line) : "";
+    const std::string exit = retained + gen_profile_exit() + gen_function_exit(line);
+    if (exit.empty())
+    {
+        return "return " + returned + ";\n";
+    }
+
+    return "{\n" + gen_c_type(return_type, line) + " " + temp + " = " + returned + ";\n" + exit + "return " + temp + ";\n}\n";
+}
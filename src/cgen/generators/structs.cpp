@@ -0,0 +1,79 @@
+#include "../cgen.hpp"
+#include "../../parser/statement/allocation.hpp"
+#include "../../util/data_widths.hpp"
+
+using statement::struct_definition;
+
+/**
+ * Lays out a struct and generates its C definition.
+ *
+ * Only data members are part of the struct's objects; static members and methods are left out of the layout.
+ */
+std::string cgen::gen_struct_definition(const struct_definition& def)
+{
+    std::vector<std::pair<std::string, data_type>> members;
+    for (const auto& s: def.get_procedure().statements_list)
+    {
+        if (s->get_statement_type() != enumerations::statement_type::ALLOCATION)
+        {
+            continue;
+        }
+
+        auto& alloc = static_cast<const statement::allocation&>(*s);
+        data_type t = alloc.get_type_information();
+        if (!t.get_qualities().is_static())
+        {
+            evaluate_array_length(t, alloc.get_line_number());
+            members.push_back(std::make_pair<>(alloc.get_name(), t));
+        }
+    }
+
+    const bool reorder = _struct_layout == enumerations::struct_layout::ALIGNED_LAYOUT;
+    const utility::struct_info& info = _structs.define(def.get_name(), members, reorder, def.get_line_number());
+    if (reorder)
+    {
+        const size_t declared_width = _structs.get_declared_width(members, def.get_line_number());
+        error::compiler_note(
+            "Struct '" + def.get_name() + "' is laid out in " + std::to_string(info.get_width()) + " bytes, saving " +
+                std::to_string(declared_width - info.get_width()) + " over declaration order",
+            def.get_line_number()
+        );
+    }
+
+    std::stringstream code;
+    code << "typedef struct " << def.get_name() << " " << def.get_name() << ";\n";
+
+    // SIN's own layout has no padding, so the C compiler mustn't add any either
+    if (info.is_packed())
+    {
+        code << "#pragma pack(push, 1)\n";
+    }
+
+    code << "struct " << def.get_name() << "\n{\n";
+    for (const auto& member: info.get_members())
+    {
+        const data_type& t = member.type;
+        if (t.get_primary() == enumerations::primitive_type::STRING && !t.get_qualities().is_dynamic())
+        {
+            _includes.insert("sinl_string.h");
+        }
+
+        code << gen_c_type(t, def.get_line_number()) << " " << member.name;
+
+        // array storage is packed, so it must be placed where the layout padded it to
+        if (t.get_primary() == enumerations::primitive_type::ARRAY && !t.get_qualities().is_dynamic() && !info.is_packed())
+        {
+            code << " SINL_ALIGNED(" << member.alignment << ")";
+        }
+
+        code << ";\n";
+    }
+    code << "};\n";
+
+    if (info.is_packed())
+    {
+        code << "#pragma pack(pop)\n";
+    }
+
+    return code.str();
+}
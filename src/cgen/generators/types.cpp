@@ -0,0 +1,210 @@
+#include "../cgen.hpp"
+#include "../../util/constants.hpp"
+
+/**
+ * Gets the C type of data of type `t`, defining the storage types of any arrays it involves.
+ */
+std::string cgen::gen_c_type(const data_type& t, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    std::string type_string;
+    switch (t.get_primary())
+    {
+    case primitive_type::ARRAY:
+    {
+        type_string = t.get_qualities().is_soa() ? gen_soa_type(t, line) : gen_array_type(t, line);
+        break;
+    }
+    case primitive_type::PTR:
+    case primitive_type::REFERENCE:
+    {
+        // the lengths of arrays behind pointers are ignored; they are read from the arrays themselves
+        data_type pointed = t.get_subtype();
+        if (pointed.get_primary() == primitive_type::ARRAY && !pointed.get_qualities().is_soa())
+        {
+            pointed.set_array_length(0);
+        }
+
+        type_string = gen_c_type(pointed, line) + "*";
+        break;
+    }
+    case primitive_type::TUPLE:
+    {
+        type_string = gen_tuple_type(t, line);
+        break;
+    }
+    default:
+        return t.get_c_typename();
+    }
+
+    if (t.get_qualities().is_const() || t.get_qualities().is_final())
+    {
+        type_string += " const";
+    }
+
+    if (t.get_qualities().is_dynamic())
+    {
+        type_string += " *";
+    }
+
+    return type_string;
+}
+
+/**
+ * Gets the storage type of an array, defining it if this is the first array of its element type and length.
+ *
+ * The type holds the array's length followed by its elements (see `SINL_ARRAY_STORAGE`). Arrays whose lengths aren't
+ * known at compile time, which are always behind a pointer, share a type with no length.
+ */
+std::string cgen::gen_array_type(const data_type& t, unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    const data_type& element = t.get_subtype();
+    if (element.get_primary() == enumerations::primitive_type::ARRAY && !element.get_qualities().is_dynamic())
+    {
+        throw error::compiler_exception(
+            "Arrays may not contain other arrays; use 'ptr<array>' instead",
+            error_code::TYPE_ERROR,
+            line
+        );
+    }
+    else if (element.get_primary() == enumerations::primitive_type::STRUCT)
+    {
+        _structs.find(element.get_struct_name(), line);
+    }
+
+    const std::pair<std::string, size_t> key(gen_c_type(element, line), t.get_array_length());
+    auto it = _array_types.find(key);
+    if (it != _array_types.end())
+    {
+        return it->second;
+    }
+
+    const std::string name = CONSTANT_BASE + "array_" + std::to_string(_array_types.size());
+    _includes.insert("sinl_array.h");
+    _struct_definitions << "typedef SINL_ARRAY_STORAGE(" << key.first << ", " <<
+        (key.second ? std::to_string(key.second) : "") << ") " << name << ";\n";
+
+    return _array_types.insert(std::make_pair<>(key, name)).first->second;
+}
+
+/**
+ * Gets the storage type of a tuple, defining it if this is the first tuple of its element types.
+ *
+ * The type is a struct whose members are named for their indices, as in `_0`, `_1`, and so on.
+ */
+std::string cgen::gen_tuple_type(const data_type& t, unsigned int line)
+{
+    using general_utilities::constants::CONSTANT_BASE;
+
+    std::vector<std::string> key;
+    for (const auto& element: t.get_contained_types())
+    {
+        if (element.get_primary() == enumerations::primitive_type::STRUCT)
+        {
+            _structs.find(element.get_struct_name(), line);
+        }
+        else if (element.get_primary() == enumerations::primitive_type::STRING && !element.get_qualities().is_dynamic())
+        {
+            _includes.insert("sinl_string.h");
+        }
+
+        key.push_back(gen_c_type(element, line));
+    }
+
+    auto it = _tuple_types.find(key);
+    if (it != _tuple_types.end())
+    {
+        return it->second;
+    }
+
+    const std::string name = CONSTANT_BASE + "tuple_" + std::to_string(_tuple_types.size());
+    _struct_definitions << "typedef struct " << name << "\n{\n";
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        _struct_definitions << key[i] << " _" << i << ";\n";
+    }
+    _struct_definitions << "} " << name << ";\n";
+
+    return _tuple_types.insert(std::make_pair<>(key, name)).first->second;
+}
+
+/**
+ * Gets the initializer for data of type `t` that starts out without a value.
+ *
+ * Such data is zeroed, as static data would be, except that the lengths of arrays are set; an empty string is returned
+ * if the data is all zeroes.
+ */
+std::string cgen::gen_zero_value(const data_type& t, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    if (t.get_qualities().is_dynamic())
+    {
+        return "";
+    }
+
+    std::vector<std::string> members;
+    switch (t.get_primary())
+    {
+    case primitive_type::ARRAY:
+    {
+        if (t.get_qualities().is_soa())
+        {
+            return "{ .len = " + std::to_string(t.get_array_length()) + " }";
+        }
+
+        // the lengths of any arrays in the elements must be set in every element
+        const std::string element = gen_zero_value(t.get_subtype(), line);
+        const std::string length = std::to_string(t.get_array_length());
+        if (element.empty() || t.get_array_length() == 0)
+        {
+            return "{ .len = " + length + " }";
+        }
+
+        return "{ .len = " + length + ", .data = { [0 ... " + std::to_string(t.get_array_length() - 1) + "] = " + element + " } }";
+    }
+    case primitive_type::STRUCT:
+    {
+        for (const auto& member: _structs.find(t.get_struct_name(), line).get_members())
+        {
+            const std::string value = gen_zero_value(member.type, line);
+            if (!value.empty())
+            {
+                members.push_back("." + member.name + " = " + value);
+            }
+        }
+        break;
+    }
+    case primitive_type::TUPLE:
+    {
+        const std::vector<data_type>& elements = t.get_contained_types();
+        for (size_t i = 0; i < elements.size(); i++)
+        {
+            const std::string value = gen_zero_value(elements[i], line);
+            if (!value.empty())
+            {
+                members.push_back("._" + std::to_string(i) + " = " + value);
+            }
+        }
+        break;
+    }
+    default:
+        return "";
+    }
+
+    if (members.empty())
+    {
+        return "";
+    }
+
+    std::string value = "{ ";
+    for (size_t i = 0; i < members.size(); i++)
+    {
+        value += (i ? ", " : "") + members[i];
+    }
+
+    return value + " }";
+}
@@ -0,0 +1,615 @@
+#include "optimizer.hpp"
+#include "../util/exceptions.hpp"
+#include "../util/constants.hpp"
+
+#include <algorithm>
+
+/**
+ * The value `collect_writes` records for names that are written with anything other than a constant increment.
+ */
+static constexpr int64_t ARBITRARY_WRITE = -1;
+
+static void record_write(std::unordered_map<std::string, int64_t>& writes, const std::string& name, int64_t step)
+{
+    auto it = writes.find(name);
+    if (it == writes.end())
+        writes[name] = step;
+    else if (it->second != ARBITRARY_WRITE)
+        it->second = step == ARBITRARY_WRITE ? ARBITRARY_WRITE : std::max(it->second, step);
+}
+
+bool optimizer::literal_value(const expression::expression_base& exp, int64_t& value, unsigned int line)
+{
+    if (exp.get_expression_type() != enumerations::expression_type::LITERAL ||
+        static_cast<const expression::literal&>(exp).get_data_type().get_primary() != enumerations::primitive_type::INT)
+    {
+        return false;
+    }
+
+    try
+    {
+        value = _constants.evaluate(exp, _scope, line).as_signed();
+        _constants.forget(exp);
+        return true;
+    }
+    catch (error::compiler_exception& e)
+    {
+        _constants.forget(exp);
+        return false;
+    }
+}
+
+bool optimizer::contains_call(const expression::expression_base& exp)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::CALL_EXP:
+    case expression_type::PROC_EXP:
+    case expression_type::CONSTRUCTION_EXP:
+        return true;
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        return contains_call(b.get_left()) || contains_call(b.get_right());
+    }
+    case expression_type::UNARY:
+        return contains_call(static_cast<const expression::unary&>(exp).get_operand());
+    case expression_type::CAST:
+        return contains_call(static_cast<const expression::typecast&>(exp).get_exp());
+    case expression_type::ATTRIBUTE:
+        return contains_call(static_cast<const expression::attribute_selection&>(exp).get_selected());
+    case expression_type::INDEXED:
+    {
+        auto& i = static_cast<const expression::indexed&>(exp);
+        return contains_call(i.get_to_index()) || contains_call(i.get_index_value());
+    }
+    case expression_type::LIST:
+    {
+        for (auto member: static_cast<const expression::list_expression&>(exp).get_list())
+        {
+            if (contains_call(*member))
+                return true;
+        }
+        return false;
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * Collects the names written by a statement.
+ *
+ * Names that are only ever incremented by a non-negative constant map to the largest step; anything else maps to `ARBITRARY_WRITE`.
+ * Statements whose effects we can't see (calls, writes through pointers and references, etc.) set `opaque`.
+ */
+void optimizer::collect_writes( const statement::statement_base& s,
+                                std::unordered_map<std::string, int64_t>& writes,
+                                bool& opaque )
+{
+    using enumerations::statement_type;
+    using enumerations::expression_type;
+    using enumerations::primitive_type;
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        // a new allocation shadows anything we knew about the name
+        auto& alloc = static_cast<const statement::allocation&>(s);
+        const primitive_type p = alloc.get_type_information().get_primary();
+        record_write(writes, alloc.get_name(), ARBITRARY_WRITE);
+        if ((alloc.get_initial_value() && contains_call(*alloc.get_initial_value())) ||
+            p == primitive_type::REFERENCE ||
+            p == primitive_type::PTR)
+        {
+            opaque = true;
+        }
+        break;
+    }
+    case statement_type::DECLARATION:
+        record_write(writes, static_cast<const statement::declaration&>(s).get_name(), ARBITRARY_WRITE);
+        break;
+    case statement_type::ASSIGNMENT:
+    case statement_type::MOVEMENT:
+    case statement_type::COMPOUND_ASSIGNMENT:
+    {
+        auto& assign = static_cast<const statement::assignment&>(s);
+        if (contains_call(assign.get_lvalue()) || contains_call(assign.get_rvalue()))
+            opaque = true;
+
+        // find the name being written; writing to an element doesn't change a container's length
+        const expression::expression_base* lvalue = &assign.get_lvalue();
+        bool element = false;
+        while (lvalue->get_expression_type() == expression_type::INDEXED)
+        {
+            lvalue = &static_cast<const expression::indexed*>(lvalue)->get_to_index();
+            element = true;
+        }
+
+        if (lvalue->get_expression_type() != expression_type::IDENTIFIER)
+        {
+            opaque = true;
+            break;
+        }
+
+        const std::string& name = static_cast<const expression::identifier*>(lvalue)->getValue();
+        const data_type* t = find_name(name);
+        if (t && t->get_primary() == primitive_type::REFERENCE)
+        {
+            opaque = true;
+            break;
+        }
+        else if (!t)
+        {
+            // allocated in the statement we are looking at
+            record_write(writes, name, ARBITRARY_WRITE);
+            break;
+        }
+        else if (element)
+        {
+            // todo: writes to string elements should be fine, too
+            if (t->get_primary() != primitive_type::ARRAY)
+                record_write(writes, name, ARBITRARY_WRITE);
+            break;
+        }
+
+        // look for `let i = i + c`; note `let i += c` is stored in the same form
+        int64_t step = ARBITRARY_WRITE;
+        const expression::expression_base& rvalue = assign.get_rvalue();
+        if (s.get_statement_type() != statement_type::MOVEMENT &&
+            rvalue.get_expression_type() == expression_type::BINARY &&
+            static_cast<const expression::binary&>(rvalue).get_operator() == enumerations::exp_operator::PLUS)
+        {
+            auto& b = static_cast<const expression::binary&>(rvalue);
+            auto is_self = [&name](const expression::expression_base& e) {
+                return e.get_expression_type() == expression_type::IDENTIFIER &&
+                    static_cast<const expression::identifier&>(e).getValue() == name;
+            };
+
+            if (!(is_self(b.get_left()) && literal_value(b.get_right(), step, s.get_line_number())) &&
+                !(is_self(b.get_right()) && literal_value(b.get_left(), step, s.get_line_number())))
+            {
+                step = ARBITRARY_WRITE;
+            }
+        }
+
+        record_write(writes, name, step < 0 ? ARBITRARY_WRITE : step);
+        break;
+    }
+    case statement_type::RETURN_STATEMENT:
+        if (contains_call(static_cast<const statement::return_statement&>(s).get_return_exp()))
+            opaque = true;
+        break;
+    case statement_type::IF_THEN_ELSE:
+    {
+        auto& ite = static_cast<const statement::if_else&>(s);
+        if (contains_call(ite.get_condition()))
+            opaque = true;
+        if (ite.get_if_branch())
+            collect_writes(*ite.get_if_branch(), writes, opaque);
+        if (ite.get_else_branch())
+            collect_writes(*ite.get_else_branch(), writes, opaque);
+        break;
+    }
+    case statement_type::WHILE_LOOP:
+    {
+        auto& loop = static_cast<const statement::while_loop&>(s);
+        if (contains_call(loop.get_condition()))
+            opaque = true;
+        if (loop.get_branch())
+            collect_writes(*loop.get_branch(), writes, opaque);
+        break;
+    }
+    case statement_type::SCOPED_BLOCK:
+    {
+        for (auto& inner: static_cast<const statement::scoped_block&>(s).get_statements().statements_list)
+            collect_writes(*inner, writes, opaque);
+        break;
+    }
+    default:
+        // calls, inline assembly, frees, etc.
+        opaque = true;
+        break;
+    }
+}
+
+/**
+ * Checks whether `index` is known to be non-negative immediately before `preceding[position]`.
+ */
+bool optimizer::is_non_negative_before(  const std::string& index,
+                                        const std::vector<std::shared_ptr<statement::statement_base>>& preceding,
+                                        size_t position )
+{
+    using enumerations::statement_type;
+
+    const data_type* t = find_name(index);
+    if (t && t->get_qualities().is_unsigned())
+        return true;
+
+    // walk back to the last time the index was set
+    for (size_t i = position; i > 0; i--)
+    {
+        const statement::statement_base& s = *preceding[i - 1];
+        int64_t value;
+
+        if (s.get_statement_type() == statement_type::ALLOCATION)
+        {
+            auto& alloc = static_cast<const statement::allocation&>(s);
+            if (alloc.get_name() == index)
+                return alloc.get_initial_value() &&
+                    literal_value(*alloc.get_initial_value(), value, s.get_line_number()) &&
+                    value >= 0;
+        }
+        else if (s.get_statement_type() == statement_type::ASSIGNMENT)
+        {
+            auto& assign = static_cast<const statement::assignment&>(s);
+            if (assign.get_lvalue().get_expression_type() == enumerations::expression_type::IDENTIFIER &&
+                static_cast<const expression::identifier&>(assign.get_lvalue()).getValue() == index)
+            {
+                return literal_value(assign.get_rvalue(), value, s.get_line_number()) && value >= 0;
+            }
+        }
+
+        std::unordered_map<std::string, int64_t> writes;
+        bool opaque = false;
+        collect_writes(s, writes, opaque);
+        if (opaque || writes.count(index))
+            return false;
+    }
+
+    return false;
+}
+
+bool optimizer::is_loop_invariant(  const expression::expression_base& exp,
+                                    const std::unordered_map<std::string, int64_t>& writes ) const
+{
+    using enumerations::expression_type;
+    using enumerations::primitive_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return true;
+    case expression_type::IDENTIFIER:
+    {
+        // pointers and references may change without being named
+        auto& name = static_cast<const expression::identifier&>(exp).getValue();
+        const data_type* t = find_name(name);
+        return t &&
+            !writes.count(name) &&
+            t->get_primary() != primitive_type::PTR &&
+            t->get_primary() != primitive_type::REFERENCE;
+    }
+    case expression_type::ATTRIBUTE:
+    {
+        auto& a = static_cast<const expression::attribute_selection&>(exp);
+        return a.get_attribute() == enumerations::attribute::LENGTH && is_loop_invariant(a.get_selected(), writes);
+    }
+    case expression_type::UNARY:
+    case expression_type::BINARY:
+    case expression_type::CAST:
+    {
+        if (has_side_effects(exp))
+            return false;
+
+        if (exp.get_expression_type() == expression_type::UNARY)
+            return is_loop_invariant(static_cast<const expression::unary&>(exp).get_operand(), writes);
+        else if (exp.get_expression_type() == expression_type::CAST)
+            return is_loop_invariant(static_cast<const expression::typecast&>(exp).get_exp(), writes);
+
+        auto& b = static_cast<const expression::binary&>(exp);
+        return is_loop_invariant(b.get_left(), writes) && is_loop_invariant(b.get_right(), writes);
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * Adds a range for every conjunct of a loop condition of the form `i < bound` where:
+ *  - `i` is non-negative when the loop is entered and only ever increases in the loop; and
+ *  - `bound` doesn't change in the loop.
+ */
+void optimizer::add_ranges( const expression::expression_base& condition,
+                            const std::unordered_map<std::string, int64_t>& writes,
+                            const std::vector<std::shared_ptr<statement::statement_base>>* preceding,
+                            size_t position,
+                            unsigned int line )
+{
+    using enumerations::expression_type;
+    using enumerations::exp_operator;
+
+    if (condition.get_expression_type() != expression_type::BINARY)
+        return;
+
+    auto& b = static_cast<const expression::binary&>(condition);
+    if (b.get_operator() == exp_operator::AND)
+    {
+        add_ranges(b.get_left(), writes, preceding, position, line);
+        add_ranges(b.get_right(), writes, preceding, position, line);
+        return;
+    }
+
+    const expression::expression_base* index;
+    const expression::expression_base* bound;
+    if (b.get_operator() == exp_operator::LESS)
+    {
+        index = &b.get_left();
+        bound = &b.get_right();
+    }
+    else if (b.get_operator() == exp_operator::GREATER)
+    {
+        index = &b.get_right();
+        bound = &b.get_left();
+    }
+    else
+    {
+        return;
+    }
+
+    if (index->get_expression_type() != expression_type::IDENTIFIER || !is_loop_invariant(*bound, writes))
+        return;
+
+    const std::string& name = static_cast<const expression::identifier*>(index)->getValue();
+    const data_type* t = find_name(name);
+    if (!t || t->get_primary() != enumerations::primitive_type::INT)
+        return;
+
+    // the index may only be incremented, and never by enough to overflow past the bound
+    auto write = writes.find(name);
+    if (write != writes.end())
+    {
+        int64_t limit;
+        if (write->second == ARBITRARY_WRITE)
+        {
+            return;
+        }
+        else if (t->get_qualities().is_signed() && !t->get_qualities().is_long() && write->second > 1)
+        {
+            const int64_t max = (int64_t(1) << (t->get_width() * 8 - 1)) - 1;
+            if (!constant_bound(*bound, limit, line) || limit - 1 > max - write->second)
+                return;
+        }
+    }
+
+    if (!t->get_qualities().is_unsigned() && (!preceding || !is_non_negative_before(name, *preceding, position)))
+        return;
+
+    index_range r;
+    r.index = name;
+    r.bound = bound;
+    r.can_guard = preceding != nullptr;
+    r.valid = true;
+
+    if (bound->get_expression_type() == expression_type::ATTRIBUTE)
+    {
+        auto& a = static_cast<const expression::attribute_selection&>(*bound);
+        if (a.get_selected().get_expression_type() == expression_type::IDENTIFIER)
+            r.container = static_cast<const expression::identifier&>(a.get_selected()).getValue();
+    }
+
+    _ranges.push_back(r);
+}
+
+void optimizer::kill_ranges(const std::unordered_map<std::string, int64_t>& writes)
+{
+    for (auto& r: _ranges)
+    {
+        if (r.valid && (writes.count(r.index) || !is_loop_invariant(*r.bound, writes)))
+            r.valid = false;
+    }
+}
+
+bool optimizer::is_indexable(const std::string& name) const
+{
+    const data_type* t = find_name(name);
+    return t && (t->get_primary() == enumerations::primitive_type::ARRAY || t->get_primary() == enumerations::primitive_type::STRING);
+}
+
+bool optimizer::get_fixed_length(const std::string& name, size_t& length, unsigned int line)
+{
+    const data_type* t = find_name(name);
+    if (!t ||
+        t->get_primary() != enumerations::primitive_type::ARRAY ||
+        t->get_qualities().is_dynamic() ||
+        !t->get_array_length_expression() ||
+        !t->get_array_length_expression()->is_const())
+    {
+        return false;
+    }
+
+    const expression::expression_base& length_exp = *t->get_array_length_expression();
+    try
+    {
+        const utility::constant_value& v = _constants.evaluate(length_exp, _scope, line);
+        const bool valid = v.is_integral() && !v.is_negative();
+        length = v.integer;
+
+        _constants.forget(length_exp);
+        return valid;
+    }
+    catch (error::compiler_exception& e)
+    {
+        _constants.forget(length_exp);
+        return false;
+    }
+}
+
+/**
+ * Gets the value of a bound that is known at compile time; either a literal or the length of a fixed-length array.
+ */
+bool optimizer::constant_bound(const expression::expression_base& exp, int64_t& value, unsigned int line)
+{
+    if (exp.get_expression_type() == enumerations::expression_type::ATTRIBUTE)
+    {
+        auto& a = static_cast<const expression::attribute_selection&>(exp);
+        size_t length;
+        if (a.get_attribute() == enumerations::attribute::LENGTH &&
+            a.get_selected().get_expression_type() == enumerations::expression_type::IDENTIFIER &&
+            get_fixed_length(static_cast<const expression::identifier&>(a.get_selected()).getValue(), length, line))
+        {
+            value = static_cast<int64_t>(length);
+            return true;
+        }
+
+        return false;
+    }
+
+    return literal_value(exp, value, line);
+}
+
+void optimizer::mark_bounds_checks(expression::expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<expression::binary&>(exp);
+        mark_bounds_checks(b.get_left(), line);
+        mark_bounds_checks(b.get_right(), line);
+        break;
+    }
+    case expression_type::UNARY:
+        mark_bounds_checks(static_cast<expression::unary&>(exp).get_operand(), line);
+        break;
+    case expression_type::CAST:
+        mark_bounds_checks(static_cast<expression::typecast&>(exp).get_exp(), line);
+        break;
+    case expression_type::ATTRIBUTE:
+        mark_bounds_checks(static_cast<expression::attribute_selection&>(exp).get_selected(), line);
+        break;
+    case expression_type::LIST:
+    {
+        for (auto member: static_cast<expression::list_expression&>(exp).get_list())
+            mark_bounds_checks(*member, line);
+        break;
+    }
+    case expression_type::INDEXED:
+    {
+        auto& idx = static_cast<expression::indexed&>(exp);
+        mark_bounds_checks(idx.get_to_index(), line);
+        mark_bounds_checks(idx.get_index_value(), line);
+
+        _checks_seen++;
+        if (idx.get_to_index().get_expression_type() != expression_type::IDENTIFIER)
+            break;
+
+        const std::string& container = static_cast<const expression::identifier&>(idx.get_to_index()).getValue();
+        if (!is_indexable(container))
+            break;
+
+        const expression::expression_base& index = idx.get_index_value();
+        size_t length;
+        int64_t value;
+
+        if (literal_value(index, value, line))
+        {
+            // constant indices into fixed-length arrays can be checked now
+            if (get_fixed_length(container, length, line))
+            {
+                if (value >= 0 && static_cast<uint64_t>(value) < length)
+                {
+                    idx.remove_bounds_check();
+                    _checks_removed++;
+                }
+                else
+                {
+                    error::compiler_warning(
+                        "Index " + std::to_string(value) + " is out of bounds for '" + container + "' (length " + std::to_string(length) + ")",
+                        error_code::OUT_OF_BOUNDS,
+                        line
+                    );
+                }
+            }
+        }
+        else if (index.get_expression_type() == expression_type::IDENTIFIER)
+        {
+            const std::string& name = static_cast<const expression::identifier&>(index).getValue();
+            for (auto r = _ranges.rbegin(); r != _ranges.rend(); r++)
+            {
+                if (!r->valid || r->index != name)
+                    continue;
+
+                const bool fixed = get_fixed_length(container, length, line) && constant_bound(*r->bound, value, line);
+                if (r->container == container || (fixed && value <= static_cast<int64_t>(length)))
+                {
+                    idx.remove_bounds_check();
+                    _checks_removed++;
+                    break;
+                }
+                else if (r->can_guard && !fixed)
+                {
+                    // check `bound <= container:len` once before the loop instead
+                    auto guard = r->guards.find(container);
+                    if (guard == r->guards.end())
+                    {
+                        guard = r->guards.insert(
+                            std::make_pair<>(
+                                container,
+                                general_utilities::constants::CONSTANT_BASE + "bounds_guard_" + std::to_string(_guard_count++)
+                            )
+                        ).first;
+                    }
+
+                    idx.set_bounds_guard(guard->second);
+                    _checks_guarded++;
+                    break;
+                }
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void optimizer::mark_bounds_checks(statement::statement_base& s)
+{
+    using enumerations::statement_type;
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        auto& alloc = static_cast<statement::allocation&>(s);
+        if (alloc.get_initial_value())
+            mark_bounds_checks(*alloc.get_initial_value(), s.get_line_number());
+        break;
+    }
+    case statement_type::ASSIGNMENT:
+    case statement_type::MOVEMENT:
+    case statement_type::COMPOUND_ASSIGNMENT:
+    {
+        auto& assign = static_cast<statement::assignment&>(s);
+        mark_bounds_checks(assign.get_lvalue(), s.get_line_number());
+        mark_bounds_checks(assign.get_rvalue(), s.get_line_number());
+        break;
+    }
+    case statement_type::RETURN_STATEMENT:
+        mark_bounds_checks(static_cast<statement::return_statement&>(s).get_return_exp(), s.get_line_number());
+        break;
+    default:
+        // conditions are marked as they are visited, and branches are handled by their own statements
+        return;
+    }
+
+    // anything this statement wrote is no longer known to be in range
+    std::unordered_map<std::string, int64_t> writes;
+    bool opaque = false;
+    collect_writes(s, writes, opaque);
+    if (opaque)
+    {
+        for (auto& r: _ranges)
+            r.valid = false;
+    }
+    else
+    {
+        kill_ranges(writes);
+    }
+}
@@ -0,0 +1,383 @@
+#include "optimizer.hpp"
+#include "../util/exceptions.hpp"
+
+bool optimizer::is_foldable_type(const data_type& t)
+{
+    using enumerations::primitive_type;
+
+    switch (t.get_primary())
+    {
+    case primitive_type::INT:
+    case primitive_type::FLOAT:
+    case primitive_type::BOOL:
+    case primitive_type::CHAR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool optimizer::is_foldable(const expression::expression_base& exp) const
+{
+    using enumerations::expression_type;
+    using enumerations::exp_operator;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return is_foldable_type(static_cast<const expression::literal&>(exp).get_data_type());
+    case expression_type::IDENTIFIER:
+    {
+        // only fold names whose innermost declaration is a const we know the value of
+        auto& name = static_cast<const expression::identifier&>(exp).getValue();
+        const data_type* t = find_name(name);
+        return t &&
+            t->get_qualities().is_const() &&
+            is_foldable_type(*t) &&
+            _constants.is_constant(name, _scope);
+    }
+    case expression_type::UNARY:
+    {
+        auto& u = static_cast<const expression::unary&>(exp);
+        switch (u.get_operator())
+        {
+        case exp_operator::UNARY_PLUS:
+        case exp_operator::UNARY_MINUS:
+        case exp_operator::NOT:
+        case exp_operator::BIT_NOT:
+            return is_foldable(u.get_operand());
+        default:
+            return false;
+        }
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        return is_foldable(b.get_left()) && is_foldable(b.get_right());
+    }
+    case expression_type::CAST:
+    {
+        auto& c = static_cast<const expression::typecast&>(exp);
+        return is_foldable_type(c.get_new_type()) && is_foldable(c.get_exp());
+    }
+    default:
+        return false;
+    }
+}
+
+bool optimizer::has_side_effects(const expression::expression_base& exp)
+{
+    using enumerations::expression_type;
+    using enumerations::exp_operator;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+    case expression_type::IDENTIFIER:
+    case expression_type::KEYWORD_EXP:
+        return false;
+    case expression_type::UNARY:
+    {
+        auto& u = static_cast<const expression::unary&>(exp);
+        return u.get_operator() == exp_operator::DEREFERENCE || has_side_effects(u.get_operand());
+    }
+    case expression_type::BINARY:
+    {
+        // division may trap, so it can't be discarded either
+        auto& b = static_cast<const expression::binary&>(exp);
+        return b.get_operator() == exp_operator::DIV ||
+            b.get_operator() == exp_operator::MODULO ||
+            has_side_effects(b.get_left()) ||
+            has_side_effects(b.get_right());
+    }
+    case expression_type::CAST:
+        return has_side_effects(static_cast<const expression::typecast&>(exp).get_exp());
+    case expression_type::ATTRIBUTE:
+        return has_side_effects(static_cast<const expression::attribute_selection&>(exp).get_selected());
+    default:
+        // calls, indexing (which is bounds checked), lists, constructions
+        return true;
+    }
+}
+
+const data_type* optimizer::get_type(const expression::expression_base& exp) const
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return &static_cast<const expression::literal&>(exp).get_data_type();
+    case expression_type::IDENTIFIER:
+        return find_name(static_cast<const expression::identifier&>(exp).getValue());
+    case expression_type::CAST:
+        return &static_cast<const expression::typecast&>(exp).get_new_type();
+    default:
+        return nullptr;
+    }
+}
+
+bool optimizer::literal_equals(const expression::expression_base& exp, int64_t value, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    if (exp.get_expression_type() != enumerations::expression_type::LITERAL)
+        return false;
+
+    auto& lit = static_cast<const expression::literal&>(exp);
+    const data_type& t = lit.get_data_type();
+    if (!is_foldable_type(t))
+        return false;
+
+    try
+    {
+        const utility::constant_value& v = _constants.evaluate(lit, _scope, line);
+        bool equal = false;
+        if (v.is_integral())
+            equal = v.as_signed() == value;
+        else if (t.get_primary() == primitive_type::FLOAT)
+            equal = v.floating == static_cast<double>(value);
+        else if (t.get_primary() == primitive_type::BOOL)
+            equal = v.boolean == (value != 0);
+
+        _constants.forget(lit);
+        return equal;
+    }
+    catch (error::compiler_exception& e)
+    {
+        _constants.forget(lit);
+        return false;
+    }
+}
+
+/**
+ * Checks whether the type of `operand` is the result type of a binary expression with `other`.
+ *
+ * Identities like `x + 0` may only be removed if doing so doesn't change the type of the expression;
+ * for example, `s + 0` where `s` is a `short int` has type `int`.
+ */
+static bool preserves_type(const data_type* operand, const data_type* other)
+{
+    if (!operand || !other)
+        return false;
+
+    if (operand->get_primary() != other->get_primary() || operand->get_width() != other->get_width())
+        return false;
+
+    return operand->get_primary() != enumerations::primitive_type::INT ||
+        operand->get_qualities().is_signed() == other->get_qualities().is_signed();
+}
+
+std::unique_ptr<expression::expression_base> optimizer::simplify(const expression::binary& exp, unsigned int line)
+{
+    using enumerations::exp_operator;
+    using enumerations::primitive_type;
+
+    const expression::expression_base& left = exp.get_left();
+    const expression::expression_base& right = exp.get_right();
+    const data_type* lt = get_type(left);
+    const data_type* rt = get_type(right);
+
+    if (!preserves_type(lt, rt))
+        return nullptr;
+
+    const bool is_int = lt->get_primary() == primitive_type::INT;
+    const bool is_float = lt->get_primary() == primitive_type::FLOAT;
+    const bool is_bool = lt->get_primary() == primitive_type::BOOL;
+
+    switch (exp.get_operator())
+    {
+    case exp_operator::PLUS:
+        // x + 0, 0 + x
+        if (is_int && literal_equals(right, 0, line))
+            return left.clone();
+        else if (is_int && literal_equals(left, 0, line))
+            return right.clone();
+        break;
+    case exp_operator::MINUS:
+        // x - 0; note 0.0 is not an identity for float addition because of -0.0, but it is for subtraction
+        if ((is_int || is_float) && literal_equals(right, 0, line))
+            return left.clone();
+        break;
+    case exp_operator::MULT:
+        // x * 1, 1 * x
+        if ((is_int || is_float) && literal_equals(right, 1, line))
+            return left.clone();
+        else if ((is_int || is_float) && literal_equals(left, 1, line))
+            return right.clone();
+        // x * 0, 0 * x -- only for integers, and only if x may be discarded
+        else if (is_int && literal_equals(right, 0, line) && !has_side_effects(left))
+            return right.clone();
+        else if (is_int && literal_equals(left, 0, line) && !has_side_effects(right))
+            return left.clone();
+        break;
+    case exp_operator::DIV:
+        // x / 1
+        if ((is_int || is_float) && literal_equals(right, 1, line))
+            return left.clone();
+        break;
+    case exp_operator::BIT_OR:
+    case exp_operator::BIT_XOR:
+        // x | 0, x ^ 0
+        if (is_int && literal_equals(right, 0, line))
+            return left.clone();
+        else if (is_int && literal_equals(left, 0, line))
+            return right.clone();
+        break;
+    case exp_operator::BIT_AND:
+        // x & 0
+        if (is_int && literal_equals(right, 0, line) && !has_side_effects(left))
+            return right.clone();
+        else if (is_int && literal_equals(left, 0, line) && !has_side_effects(right))
+            return left.clone();
+        break;
+    case exp_operator::LEFT_SHIFT:
+    case exp_operator::RIGHT_SHIFT:
+        // x << 0, x >> 0
+        if (is_int && literal_equals(right, 0, line))
+            return left.clone();
+        break;
+    case exp_operator::AND:
+        // x and true; x and false
+        if (is_bool && literal_equals(right, 1, line))
+            return left.clone();
+        else if (is_bool && literal_equals(left, 1, line))
+            return right.clone();
+        else if (is_bool && literal_equals(right, 0, line) && !has_side_effects(left))
+            return right.clone();
+        else if (is_bool && literal_equals(left, 0, line))
+            return left.clone();    // short-circuited; the right side is never evaluated
+        break;
+    case exp_operator::OR:
+        // x or false; x or true
+        if (is_bool && literal_equals(right, 0, line))
+            return left.clone();
+        else if (is_bool && literal_equals(left, 0, line))
+            return right.clone();
+        else if (is_bool && literal_equals(right, 1, line) && !has_side_effects(left))
+            return right.clone();
+        else if (is_bool && literal_equals(left, 1, line))
+            return left.clone();    // short-circuited
+        break;
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<expression::expression_base> optimizer::fold(const expression::expression_base& exp, unsigned int line)
+{
+    using enumerations::expression_type;
+
+    // if the whole expression is constant, replace it with a literal
+    if (exp.get_expression_type() != expression_type::LITERAL && is_foldable(exp))
+    {
+        try
+        {
+            utility::constant_value v = _constants.evaluate(exp, _scope, line);
+            _constants.forget(exp);
+
+            if (is_foldable_type(v.type))
+                return v.to_literal();
+        }
+        catch (error::compiler_exception& e)
+        {
+            // leave it to the code generator to report the error
+            _constants.forget(exp);
+            return nullptr;
+        }
+    }
+
+    // otherwise, rebuild the node with any folded children
+    std::unique_ptr<expression::expression_base> rebuilt = nullptr;
+    switch (exp.get_expression_type())
+    {
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        auto left = fold(b.get_left(), line);
+        auto right = fold(b.get_right(), line);
+        if (left || right)
+        {
+            rebuilt = std::make_unique<expression::binary>(
+                left ? std::move(left) : b.get_left().clone(),
+                right ? std::move(right) : b.get_right().clone(),
+                b.get_operator()
+            );
+        }
+
+        if (_level >= 2)
+        {
+            auto simplified = simplify(
+                rebuilt ? static_cast<const expression::binary&>(*rebuilt) : b,
+                line
+            );
+            if (simplified)
+                rebuilt = std::move(simplified);
+        }
+        break;
+    }
+    case expression_type::UNARY:
+    {
+        auto& u = static_cast<const expression::unary&>(exp);
+        auto operand = fold(u.get_operand(), line);
+        if (operand)
+            rebuilt = std::make_unique<expression::unary>(std::move(operand), u.get_operator());
+        break;
+    }
+    case expression_type::CAST:
+    {
+        auto& c = static_cast<const expression::typecast&>(exp);
+        auto to_cast = fold(c.get_exp(), line);
+        if (to_cast)
+            rebuilt = std::make_unique<expression::typecast>(std::move(to_cast), c.get_new_type());
+        break;
+    }
+    case expression_type::INDEXED:
+    {
+        auto& i = static_cast<const expression::indexed&>(exp);
+        auto index = fold(i.get_index_value(), line);
+        if (index)
+            rebuilt = std::make_unique<expression::indexed>(i.get_to_index().clone(), std::move(index));
+        break;
+    }
+    case expression_type::ATTRIBUTE:
+    {
+        auto& a = static_cast<const expression::attribute_selection&>(exp);
+        auto selected = fold(a.get_selected(), line);
+        if (selected)
+        {
+            rebuilt = std::make_unique<expression::attribute_selection>(
+                std::move(selected),
+                a.get_attribute(),
+                a.get_data_type()
+            );
+        }
+        break;
+    }
+    case expression_type::LIST:
+    {
+        auto& l = static_cast<const expression::list_expression&>(exp);
+        std::vector<std::unique_ptr<expression::expression_base>> members;
+        bool changed = false;
+        for (auto member: l.get_list())
+        {
+            auto folded = fold(*member, line);
+            changed = changed || folded;
+            members.push_back(folded ? std::move(folded) : member->clone());
+        }
+
+        if (changed)
+            rebuilt = std::make_unique<expression::list_expression>(members, l.get_list_type());
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (rebuilt && exp.is_const())
+        rebuilt->set_const();
+
+    return rebuilt;
+}
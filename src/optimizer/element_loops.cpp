@@ -0,0 +1,151 @@
+#include "optimizer.hpp"
+
+#include <algorithm>
+
+/**
+ * Checks whether array elements of the given type can be loaded into vector registers.
+ */
+static bool is_vector_element(const data_type& t)
+{
+    using enumerations::primitive_type;
+
+    const primitive_type p = t.get_primary();
+    return (p == primitive_type::INT || p == primitive_type::FLOAT || p == primitive_type::BOOL || p == primitive_type::CHAR) &&
+        !t.get_qualities().is_dynamic();
+}
+
+/**
+ * Checks that an expression in an element-wise loop only touches arrays at `index`, adding each array it indexes to `arrays`.
+ *
+ * Every access must have had its bounds check removed, as a check would be a branch out of the middle of the loop.
+ */
+bool optimizer::find_element_arrays(const expression::expression_base& exp,
+                                    const std::string& index,
+                                    std::vector<std::pair<std::string, data_type>>& arrays) const
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+        return true;
+    case expression_type::IDENTIFIER:
+    {
+        // whole arrays can't be used in the loop, only their elements
+        const data_type* t = find_name(static_cast<const expression::identifier&>(exp).getValue());
+        return t && is_vector_element(*t);
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        return find_element_arrays(b.get_left(), index, arrays) && find_element_arrays(b.get_right(), index, arrays);
+    }
+    case expression_type::UNARY:
+    {
+        // the address of an element could be used to reach the others
+        auto& u = static_cast<const expression::unary&>(exp);
+        return u.get_operator() != enumerations::exp_operator::ADDRESS &&
+            find_element_arrays(u.get_operand(), index, arrays);
+    }
+    case expression_type::CAST:
+        return find_element_arrays(static_cast<const expression::typecast&>(exp).get_exp(), index, arrays);
+    case expression_type::ATTRIBUTE:
+    {
+        auto& a = static_cast<const expression::attribute_selection&>(exp);
+        return a.get_attribute() == enumerations::attribute::LENGTH &&
+            a.get_selected().get_expression_type() == expression_type::IDENTIFIER;
+    }
+    case expression_type::INDEXED:
+    {
+        auto& idx = static_cast<const expression::indexed&>(exp);
+        if (idx.is_bounds_checked() ||
+            idx.get_to_index().get_expression_type() != expression_type::IDENTIFIER ||
+            idx.get_index_value().get_expression_type() != expression_type::IDENTIFIER ||
+            static_cast<const expression::identifier&>(idx.get_index_value()).getValue() != index)
+        {
+            return false;
+        }
+
+        const std::string& name = static_cast<const expression::identifier&>(idx.get_to_index()).getValue();
+        const data_type* t = find_name(name);
+        if (!t || t->get_primary() != enumerations::primitive_type::ARRAY || !is_vector_element(t->get_subtype()))
+            return false;
+
+        auto found = std::find_if(arrays.begin(), arrays.end(), [&name](const std::pair<std::string, data_type>& a) {
+            return a.first == name;
+        });
+        if (found == arrays.end())
+            arrays.push_back(std::make_pair<>(name, *t));
+
+        return true;
+    }
+    default:
+        // calls, lists, etc.
+        return false;
+    }
+}
+
+/**
+ * Marks a loop as element-wise if its body consists only of assignments to scalars and to array elements at the loop's index,
+ * ending with the index being incremented by one.
+ *
+ * `index` is the name the loop condition compares against its bound, and `writes` holds the names written in the body.
+ */
+void optimizer::mark_element_wise(  statement::while_loop& loop,
+                                    const std::string& index,
+                                    const std::unordered_map<std::string, int64_t>& writes )
+{
+    using enumerations::statement_type;
+    using enumerations::expression_type;
+
+    auto step = writes.find(index);
+    if (!loop.get_branch() || step == writes.end() || step->second != 1)
+        return;
+
+    std::vector<const statement::statement_base*> body;
+    if (loop.get_branch()->get_statement_type() == statement_type::SCOPED_BLOCK)
+    {
+        for (auto& s: static_cast<const statement::scoped_block*>(loop.get_branch())->get_statements().statements_list)
+            body.push_back(s.get());
+    }
+    else
+    {
+        body.push_back(loop.get_branch());
+    }
+
+    std::vector<std::pair<std::string, data_type>> arrays;
+    for (size_t i = 0; i < body.size(); i++)
+    {
+        const statement::statement_base& s = *body[i];
+        if (s.get_statement_type() != statement_type::ASSIGNMENT && s.get_statement_type() != statement_type::COMPOUND_ASSIGNMENT)
+            return;
+
+        auto& assign = static_cast<const statement::assignment&>(s);
+        const expression::expression_base& lvalue = assign.get_lvalue();
+        if (lvalue.get_expression_type() == expression_type::IDENTIFIER)
+        {
+            // the increment must come last, so that every access in an iteration is at the same index
+            if (static_cast<const expression::identifier&>(lvalue).getValue() == index && i + 1 != body.size())
+                return;
+        }
+        else if (lvalue.get_expression_type() != expression_type::INDEXED)
+        {
+            return;
+        }
+
+        if (!find_element_arrays(lvalue, index, arrays) || !find_element_arrays(assign.get_rvalue(), index, arrays))
+            return;
+    }
+
+    // the last statement is the only write to the index, as the index is only ever incremented by one
+    auto& last = static_cast<const statement::assignment&>(*body.back());
+    if (arrays.empty() ||
+        last.get_lvalue().get_expression_type() != expression_type::IDENTIFIER ||
+        static_cast<const expression::identifier&>(last.get_lvalue()).getValue() != index)
+    {
+        return;
+    }
+
+    loop.set_element_wise(index, std::move(arrays));
+    _element_loops++;
+}
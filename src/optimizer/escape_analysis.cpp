@@ -0,0 +1,368 @@
+#include "optimizer.hpp"
+#include "../util/exceptions.hpp"
+#include "../util/data_widths.hpp"
+
+void optimizer::add_function(const std::string& name, const std::vector<const statement::statement_base*>& formal_parameters)
+{
+    std::vector<data_type> parameters;
+    for (auto param: formal_parameters)
+    {
+        if (param->get_statement_type() == enumerations::statement_type::ALLOCATION)
+            parameters.push_back(static_cast<const statement::allocation*>(param)->get_type_information());
+        else if (param->get_statement_type() == enumerations::statement_type::DECLARATION)
+            parameters.push_back(static_cast<const statement::declaration*>(param)->get_type_information());
+        else
+            parameters.push_back(data_type(enumerations::primitive_type::REFERENCE));   // assume the worst
+    }
+
+    _functions[name] = parameters;
+}
+
+/**
+ * Collects the allocations made in a function body, along with the number of times each name is allocated.
+ *
+ * Nested function definitions are not included.
+ */
+void optimizer::collect_allocations(statement::statement_base& s,
+                                    std::vector<statement::allocation*>& allocations,
+                                    std::unordered_map<std::string, size_t>& counts)
+{
+    using enumerations::statement_type;
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        auto& alloc = static_cast<statement::allocation&>(s);
+        allocations.push_back(&alloc);
+        counts[alloc.get_name()]++;
+        break;
+    }
+    case statement_type::IF_THEN_ELSE:
+    {
+        auto& ite = static_cast<statement::if_else&>(s);
+        if (ite.get_if_branch())
+            collect_allocations(*ite.get_if_branch(), allocations, counts);
+        if (ite.get_else_branch())
+            collect_allocations(*ite.get_else_branch(), allocations, counts);
+        break;
+    }
+    case statement_type::WHILE_LOOP:
+    {
+        auto& loop = static_cast<statement::while_loop&>(s);
+        if (loop.get_branch())
+            collect_allocations(*loop.get_branch(), allocations, counts);
+        break;
+    }
+    case statement_type::SCOPED_BLOCK:
+    {
+        for (auto& inner: static_cast<statement::scoped_block&>(s).get_statements().statements_list)
+            collect_allocations(*inner, allocations, counts);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+/**
+ * Gets the name of the data an lvalue-like expression refers to, if any.
+ */
+static const std::string* get_root_name(const expression::expression_base& exp)
+{
+    using enumerations::expression_type;
+
+    const expression::expression_base* current = &exp;
+    while (true)
+    {
+        if (current->get_expression_type() == expression_type::IDENTIFIER)
+        {
+            return &static_cast<const expression::identifier*>(current)->getValue();
+        }
+        else if (current->get_expression_type() == expression_type::INDEXED)
+        {
+            current = &static_cast<const expression::indexed*>(current)->get_to_index();
+        }
+        else if (current->get_expression_type() == expression_type::BINARY &&
+            static_cast<const expression::binary*>(current)->get_operator() == enumerations::exp_operator::DOT)
+        {
+            current = &static_cast<const expression::binary*>(current)->get_left();
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+}
+
+void optimizer::find_escapes(const expression::expression_base& exp, std::unordered_set<std::string>& escapes, bool& opaque) const
+{
+    using enumerations::expression_type;
+    using enumerations::primitive_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::UNARY:
+    {
+        auto& u = static_cast<const expression::unary&>(exp);
+        if (u.get_operator() == enumerations::exp_operator::ADDRESS)
+        {
+            // once its address is taken, we can't know where it goes
+            const std::string* name = get_root_name(u.get_operand());
+            if (name)
+                escapes.insert(*name);
+            else
+                opaque = true;
+        }
+
+        find_escapes(u.get_operand(), escapes, opaque);
+        break;
+    }
+    case expression_type::CALL_EXP:
+    case expression_type::PROC_EXP:
+    {
+        auto& proc = static_cast<const expression::procedure&>(exp);
+        const std::vector<data_type>* parameters = nullptr;
+        if (proc.get_func_name().get_expression_type() == expression_type::IDENTIFIER)
+        {
+            auto it = _functions.find(static_cast<const expression::identifier&>(proc.get_func_name()).getValue());
+            if (it != _functions.end())
+                parameters = &it->second;
+        }
+
+        // data passed by reference escapes, as does anything passed to a function we don't know
+        for (size_t i = 0; i < proc.get_num_args(); i++)
+        {
+            const expression::expression_base& arg = proc.get_arg(i);
+            const std::string* name = get_root_name(arg);
+            if (name &&
+                (!parameters ||
+                    i >= parameters->size() ||
+                    parameters->at(i).get_primary() == primitive_type::REFERENCE))
+            {
+                escapes.insert(*name);
+            }
+
+            find_escapes(arg, escapes, opaque);
+        }
+        break;
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        find_escapes(b.get_left(), escapes, opaque);
+        find_escapes(b.get_right(), escapes, opaque);
+        break;
+    }
+    case expression_type::CAST:
+        find_escapes(static_cast<const expression::typecast&>(exp).get_exp(), escapes, opaque);
+        break;
+    case expression_type::ATTRIBUTE:
+        find_escapes(static_cast<const expression::attribute_selection&>(exp).get_selected(), escapes, opaque);
+        break;
+    case expression_type::INDEXED:
+    {
+        auto& i = static_cast<const expression::indexed&>(exp);
+        find_escapes(i.get_to_index(), escapes, opaque);
+        find_escapes(i.get_index_value(), escapes, opaque);
+        break;
+    }
+    case expression_type::LIST:
+    {
+        for (auto member: static_cast<const expression::list_expression&>(exp).get_list())
+            find_escapes(*member, escapes, opaque);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void optimizer::find_escapes(const statement::statement_base& s, std::unordered_set<std::string>& escapes, bool& opaque) const
+{
+    using enumerations::statement_type;
+    using enumerations::primitive_type;
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        auto& alloc = static_cast<const statement::allocation&>(s);
+        if (alloc.get_initial_value())
+        {
+            // binding a reference
+            const std::string* name = get_root_name(*alloc.get_initial_value());
+            if (name && alloc.get_type_information().get_primary() == primitive_type::REFERENCE)
+                escapes.insert(*name);
+
+            find_escapes(*alloc.get_initial_value(), escapes, opaque);
+        }
+        break;
+    }
+    case statement_type::ASSIGNMENT:
+    case statement_type::COMPOUND_ASSIGNMENT:
+    {
+        auto& assign = static_cast<const statement::assignment&>(s);
+        find_escapes(assign.get_lvalue(), escapes, opaque);
+        find_escapes(assign.get_rvalue(), escapes, opaque);
+        break;
+    }
+    case statement_type::MOVEMENT:
+    {
+        // ownership is transferred
+        auto& move = static_cast<const statement::assignment&>(s);
+        for (auto exp: { &move.get_lvalue(), &move.get_rvalue() })
+        {
+            const std::string* name = get_root_name(*exp);
+            if (name)
+                escapes.insert(*name);
+
+            find_escapes(*exp, escapes, opaque);
+        }
+        break;
+    }
+    case statement_type::RETURN_STATEMENT:
+    {
+        auto& ret = static_cast<const statement::return_statement&>(s);
+        const std::string* name = get_root_name(ret.get_return_exp());
+        if (name)
+            escapes.insert(*name);
+
+        find_escapes(ret.get_return_exp(), escapes, opaque);
+        break;
+    }
+    case statement_type::CALL:
+        find_escapes(static_cast<const expression::procedure&>(static_cast<const statement::call&>(s)), escapes, opaque);
+        break;
+    case statement_type::IF_THEN_ELSE:
+    {
+        auto& ite = static_cast<const statement::if_else&>(s);
+        find_escapes(ite.get_condition(), escapes, opaque);
+        if (ite.get_if_branch())
+            find_escapes(*ite.get_if_branch(), escapes, opaque);
+        if (ite.get_else_branch())
+            find_escapes(*ite.get_else_branch(), escapes, opaque);
+        break;
+    }
+    case statement_type::WHILE_LOOP:
+    {
+        auto& loop = static_cast<const statement::while_loop&>(s);
+        find_escapes(loop.get_condition(), escapes, opaque);
+        if (loop.get_branch())
+            find_escapes(*loop.get_branch(), escapes, opaque);
+        break;
+    }
+    case statement_type::SCOPED_BLOCK:
+    {
+        for (auto& inner: static_cast<const statement::scoped_block&>(s).get_statements().statements_list)
+            find_escapes(*inner, escapes, opaque);
+        break;
+    }
+    case statement_type::DECLARATION:
+    case statement_type::FUNCTION_DEFINITION:
+    case statement_type::STRUCT_DEFINITION:
+        break;
+    default:
+        // inline assembly, frees, constructions, etc.
+        opaque = true;
+        break;
+    }
+}
+
+/**
+ * Gets the width of a type that may be allocated automatically.
+ *
+ * The type must have a size known at compile time that is small enough to reasonably put on the stack.
+ */
+bool optimizer::get_demoted_width(const data_type& t, size_t& width, unsigned int line)
+{
+    using enumerations::primitive_type;
+
+    switch (t.get_primary())
+    {
+    case primitive_type::INT:
+    case primitive_type::FLOAT:
+    case primitive_type::BOOL:
+    case primitive_type::CHAR:
+    case primitive_type::PTR:
+        width = t.get_width();
+        break;
+    case primitive_type::ARRAY:
+    {
+        if (!t.get_array_length_expression() || !t.get_array_length_expression()->is_const() || t.get_subtype().get_width() == 0)
+            return false;
+
+        const expression::expression_base& length_exp = *t.get_array_length_expression();
+        try
+        {
+            const utility::constant_value& length = _constants.evaluate(length_exp, _scope, line);
+            const bool valid = length.is_integral() && !length.is_negative();
+            width = data_type::get_array_width(length.integer, t.get_subtype().get_width());
+
+            _constants.forget(length_exp);
+            if (!valid)
+                return false;
+        }
+        catch (error::compiler_exception& e)
+        {
+            _constants.forget(length_exp);
+            return false;
+        }
+        break;
+    }
+    default:
+        // strings and references must stay on the heap; structs and tuples need a struct table to be sized
+        return false;
+    }
+
+    return width > 0 && width <= MAX_DEMOTED_WIDTH;
+}
+
+/**
+ * Moves dynamic allocations that never leave the function onto the stack.
+ *
+ * An allocation escapes if it is returned, moved, bound to a reference, has its address taken, or is passed to a function by reference.
+ * Names allocated more than once in the same function are left alone, as we track escapes by name.
+ */
+void optimizer::demote_allocations(statement::function_definition& def)
+{
+    std::vector<statement::allocation*> allocations;
+    std::unordered_map<std::string, size_t> counts;
+    for (auto param: def.get_formal_parameters())
+    {
+        if (param->get_statement_type() == enumerations::statement_type::ALLOCATION)
+            counts[static_cast<const statement::allocation*>(param)->get_name()]++;
+    }
+    for (auto& s: def.get_procedure().statements_list)
+        collect_allocations(*s, allocations, counts);
+
+    std::unordered_set<std::string> escapes;
+    bool opaque = false;
+    for (auto& s: def.get_procedure().statements_list)
+        find_escapes(*s, escapes, opaque);
+
+    if (opaque)
+        return;
+
+    for (auto alloc: allocations)
+    {
+        data_type& t = alloc->get_type_information();
+        size_t width;
+        if (!t.get_qualities().is_dynamic() ||
+            counts[alloc->get_name()] > 1 ||
+            escapes.count(alloc->get_name()) ||
+            !get_demoted_width(t, width, alloc->get_line_number()))
+        {
+            continue;
+        }
+
+        t.get_qualities().remove_quality(enumerations::symbol_quality::DYNAMIC);
+        _allocations_demoted++;
+
+        error::compiler_note(
+            "'" + alloc->get_name() + "' does not escape '" + def.get_name() + "'; allocating " +
+                std::to_string(width) + " bytes in automatic memory instead of dynamic memory",
+            alloc->get_line_number()
+        );
+    }
+}
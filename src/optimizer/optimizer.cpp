@@ -0,0 +1,364 @@
+#include "optimizer.hpp"
+#include "../util/phase_report.hpp"
+
+void optimizer::enter_scope(const std::string& name)
+{
+    _scope.push_back(name);
+    _names.emplace_back();
+}
+
+void optimizer::leave_scope()
+{
+    _scope.pop_back();
+    _names.pop_back();
+}
+
+const data_type* optimizer::find_name(const std::string& name) const
+{
+    // search from the innermost scope out so that shadowed names resolve correctly
+    for (auto it = _names.rbegin(); it != _names.rend(); it++)
+    {
+        auto found = it->find(name);
+        if (found != it->end())
+            return &found->second;
+    }
+
+    return nullptr;
+}
+
+void optimizer::add_name(const std::string& name, const data_type& type)
+{
+    _names.back()[name] = type;
+}
+
+void optimizer::optimize_block(statement::statement_block& block)
+{
+    auto& statements = block.statements_list;
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        if (statements[i]->get_statement_type() == enumerations::statement_type::WHILE_LOOP)
+        {
+            // loops may need guards allocated immediately before them
+            optimize_loop(static_cast<statement::while_loop&>(*statements[i]), &statements, i);
+            statements.insert(statements.begin() + i, _guards.begin(), _guards.end());
+            i += _guards.size();
+            _guards.clear();
+        }
+        else
+        {
+            optimize_statement(*statements[i]);
+        }
+    }
+
+    // names are still in scope here, so we know what the statements refer to
+    if (_level >= 2)
+    {
+        general_utilities::phase_report::scope refcount_elision("refcount elision");
+        elide_refcounts(block);
+    }
+}
+
+void optimizer::optimize_loop(  statement::while_loop& loop,
+                                const std::vector<std::shared_ptr<statement::statement_base>>* preceding,
+                                size_t position )
+{
+    {
+        general_utilities::phase_report::scope folding("constant folding");
+        auto folded = fold(loop.get_condition(), loop.get_line_number());
+        if (folded)
+            loop.set_condition(std::move(folded));
+    }
+
+    if (_level < 2)
+    {
+        optimize_branch(loop.get_branch());
+        return;
+    }
+
+    // the condition and body are evaluated repeatedly, so anything written in the loop invalidates what we knew before it
+    std::unordered_map<std::string, int64_t> writes;
+    bool opaque = false;
+    const size_t outer_ranges = _ranges.size();
+    {
+        general_utilities::phase_report::scope bounds_checks("bounds checks");
+        if (loop.get_branch())
+            collect_writes(*loop.get_branch(), writes, opaque);
+
+        if (opaque)
+        {
+            for (auto& r: _ranges)
+                r.valid = false;
+        }
+        else
+        {
+            kill_ranges(writes);
+        }
+
+        mark_bounds_checks(loop.get_condition(), loop.get_line_number());
+        if (!opaque)
+            add_ranges(loop.get_condition(), writes, preceding, position, loop.get_line_number());
+    }
+
+    optimize_branch(loop.get_branch());
+
+    // a loop whose only condition is `i < bound` may be element-wise; this relies on the checks removed from its body
+    if (!opaque && _ranges.size() == outer_ranges + 1 &&
+        static_cast<const expression::binary&>(loop.get_condition()).get_operator() != enumerations::exp_operator::AND)
+    {
+        general_utilities::phase_report::scope element_loops("element loops");
+        mark_element_wise(loop, _ranges.back().index, writes);
+    }
+
+    // collect the guards this loop needs
+    general_utilities::phase_report::scope bounds_checks("bounds checks");
+    for (size_t i = outer_ranges; i < _ranges.size(); i++)
+    {
+        for (auto& g: _ranges[i].guards)
+        {
+            auto len = std::make_unique<expression::attribute_selection>(
+                std::make_unique<expression::identifier>(g.first),
+                "len"
+            );
+            auto check = std::make_unique<expression::binary>(
+                _ranges[i].bound->clone(),
+                std::move(len),
+                enumerations::exp_operator::LESS_OR_EQUAL
+            );
+            auto guard = std::make_shared<statement::allocation>(
+                data_type(enumerations::primitive_type::BOOL),
+                g.second,
+                true,
+                std::move(check)
+            );
+            guard->set_line_number(loop.get_line_number());
+            _guards.push_back(guard);
+        }
+    }
+    _ranges.resize(outer_ranges);
+}
+
+void optimizer::optimize_branch(statement::statement_base* branch)
+{
+    if (!branch)
+        return;
+
+    // every branch gets its own scope, even if it is a single statement
+    enter_scope("__block_" + std::to_string(_block_count++));
+    if (branch->get_statement_type() == enumerations::statement_type::SCOPED_BLOCK)
+    {
+        optimize_block(static_cast<statement::scoped_block*>(branch)->get_statements());
+    }
+    else
+    {
+        optimize_statement(*branch);
+    }
+    leave_scope();
+}
+
+void optimizer::optimize_statement(statement::statement_base& s)
+{
+    using enumerations::statement_type;
+    using enumerations::expression_type;
+
+    const unsigned int line = s.get_line_number();
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        auto& alloc = static_cast<statement::allocation&>(s);
+        const data_type& t = alloc.get_type_information();
+        const expression::expression_base* init = alloc.get_initial_value();
+
+        // a const must be initialized with a constexpr; don't fold a non-const initializer into one,
+        // or we would accept code the code generator should reject
+        if (init && (!t.get_qualities().is_const() || init->is_const()))
+        {
+            general_utilities::phase_report::scope folding("constant folding");
+            auto folded = fold(*init, line);
+            if (folded)
+            {
+                if (init->is_const())
+                    folded->set_const();
+
+                alloc.set_initial_value(std::move(folded));
+            }
+        }
+
+        add_name(alloc.get_name(), t);
+        if (t.get_qualities().is_const() && alloc.get_initial_value())
+        {
+            _constants.add_constant(alloc.get_name(), _scope, t, alloc.get_initial_value());
+        }
+        break;
+    }
+    case statement_type::DECLARATION:
+    {
+        auto& decl = static_cast<statement::declaration&>(s);
+        add_name(decl.get_name(), decl.get_type_information());
+        if (decl.is_function())
+            add_function(decl.get_name(), static_cast<const statement::declaration&>(decl).get_formal_parameters());
+        break;
+    }
+    case statement_type::ASSIGNMENT:
+    case statement_type::MOVEMENT:
+    case statement_type::COMPOUND_ASSIGNMENT:
+    {
+        auto& assign = static_cast<statement::assignment&>(s);
+        general_utilities::phase_report::scope folding("constant folding");
+
+        // only the index in an lvalue may be folded; the lvalue itself must stay addressable
+        const expression::expression_base& lvalue = assign.get_lvalue();
+        if (lvalue.get_expression_type() == expression_type::INDEXED)
+        {
+            auto& idx = static_cast<const expression::indexed&>(lvalue);
+            auto folded = fold(idx.get_index_value(), line);
+            if (folded)
+            {
+                assign.set_lvalue(
+                    std::make_unique<expression::indexed>(idx.get_to_index().clone(), std::move(folded))
+                );
+            }
+        }
+
+        auto folded = fold(assign.get_rvalue(), line);
+        if (folded)
+            assign.set_rvalue(std::move(folded));
+        break;
+    }
+    case statement_type::RETURN_STATEMENT:
+    {
+        auto& ret = static_cast<statement::return_statement&>(s);
+        general_utilities::phase_report::scope folding("constant folding");
+        auto folded = fold(ret.get_return_exp(), line);
+        if (folded)
+            ret.set_return_exp(std::move(folded));
+        break;
+    }
+    case statement_type::IF_THEN_ELSE:
+    {
+        auto& ite = static_cast<statement::if_else&>(s);
+        {
+            general_utilities::phase_report::scope folding("constant folding");
+            auto folded = fold(ite.get_condition(), line);
+            if (folded)
+                ite.set_condition(std::move(folded));
+        }
+
+        if (_level >= 2)
+        {
+            general_utilities::phase_report::scope bounds_checks("bounds checks");
+            mark_bounds_checks(ite.get_condition(), line);
+        }
+
+        optimize_branch(ite.get_if_branch());
+        optimize_branch(ite.get_else_branch());
+        break;
+    }
+    case statement_type::WHILE_LOOP:
+    {
+        // without an enclosing block, there is nowhere to put any guards
+        optimize_loop(static_cast<statement::while_loop&>(s), nullptr, 0);
+        _guards.clear();
+        break;
+    }
+    case statement_type::SCOPED_BLOCK:
+    {
+        optimize_branch(&s);
+        break;
+    }
+    case statement_type::FUNCTION_DEFINITION:
+    {
+        auto& def = static_cast<statement::function_definition&>(s);
+        general_utilities::trace::span function("function", "optimize", def.get_name());
+        add_name(def.get_name(), def.get_type_information());
+        add_function(def.get_name(), static_cast<const statement::function_definition&>(def).get_formal_parameters());
+
+        enter_scope(def.get_name());
+        for (auto param: def.get_formal_parameters())
+        {
+            if (param->get_statement_type() == statement_type::ALLOCATION)
+            {
+                auto alloc = static_cast<const statement::allocation*>(param);
+                add_name(alloc->get_name(), alloc->get_type_information());
+            }
+            else if (param->get_statement_type() == statement_type::DECLARATION)
+            {
+                auto decl = static_cast<const statement::declaration*>(param);
+                add_name(decl->get_name(), decl->get_type_information());
+            }
+        }
+        optimize_block(def.get_procedure());
+        leave_scope();
+
+        if (_level >= 2)
+        {
+            {
+                general_utilities::phase_report::scope escape_analysis("escape analysis");
+                demote_allocations(def);
+            }
+            {
+                general_utilities::phase_report::scope refcount_elision("refcount elision");
+                borrow_parameters(def);
+            }
+        }
+        break;
+    }
+    default:
+        // struct definitions, calls, etc. are left alone
+        break;
+    }
+
+    if (_level >= 2)
+    {
+        general_utilities::phase_report::scope bounds_checks("bounds checks");
+        mark_bounds_checks(s);
+    }
+}
+
+void optimizer::optimize(statement::statement_block& ast)
+{
+    if (_level == 0)
+        return;
+
+    optimize_block(ast);
+}
+
+void optimizer::print_report(std::ostream& out) const
+{
+    if (_checks_seen)
+    {
+        out << "**** Bounds checks: removed " << _checks_removed << " of " << _checks_seen;
+        if (_checks_guarded)
+            out << "; " << _checks_guarded << " more hoisted out of loops";
+        out << std::endl;
+    }
+
+    if (_allocations_demoted)
+        out << "**** Escape analysis: " << _allocations_demoted << " dynamic allocations moved to automatic memory" << std::endl;
+
+    if (_refcounts_elided)
+        out << "**** Reference counting: elided " << _refcounts_elided << " increments and decrements" << std::endl;
+
+    if (_element_loops)
+        out << "**** Loops: " << _element_loops << " element-wise loops prepared for vectorization" << std::endl;
+}
+
+optimizer::optimizer(unsigned int level)
+    : _level(level)
+    , _block_count(0)
+    , _guard_count(0)
+    , _checks_seen(0)
+    , _checks_removed(0)
+    , _checks_guarded(0)
+    , _allocations_demoted(0)
+    , _refcounts_elided(0)
+    , _element_loops(0)
+{
+    // the global scope
+    _names.emplace_back();
+}
+
+optimizer::~optimizer()
+{
+}
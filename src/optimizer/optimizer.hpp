@@ -0,0 +1,188 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <ostream>
+#include <cinttypes>
+
+#include "../parser/statements.hpp"
+#include "../parser/expressions.hpp"
+#include "../cgen/common/constant_evaluator.hpp"
+
+/**
+ * The AST-level optimizer.
+ *
+ * This runs between the parser and the code generator, rewriting the AST in place.
+ * The passes that are run depend on the optimization level:
+ *  - 0: no optimizations
+ *  - 1: constant folding and propagation of `const` data
+ *  - 2: algebraic simplification, bounds-check elimination, escape analysis, reference count elision,
+ *       and marking element-wise loops for vectorization
+ */
+class optimizer
+{
+    unsigned int _level;
+
+    /**
+     * The full nested scope name.
+     */
+    std::vector<std::string> _scope;
+    /**
+     * Used to generate names for unnamed scopes (scoped blocks, loop bodies, etc.).
+     */
+    size_t _block_count;
+    /**
+     * The data visible in each scope.
+     *
+     * Tracks the type of each name so that folding never looks through a shadowed name,
+     * and so that algebraic identities are only applied when they don't change the type of an expression.
+     */
+    std::vector<std::unordered_map<std::string, data_type>> _names;
+    /**
+     * Evaluates the constant subexpressions we fold.
+     */
+    utility::constant_evaluator _constants;
+
+    /**
+     * A fact of the form `index < bound` that holds within part of a loop body.
+     */
+    struct index_range
+    {
+        std::string index;
+        const expression::expression_base* bound;
+        std::string container;  // set if the bound is `container:len`
+        bool can_guard;         // whether checks may be hoisted in front of the loop
+        std::unordered_map<std::string, std::string> guards;    // container name -> guard name
+        bool valid;
+    };
+    std::vector<index_range> _ranges;
+
+    /**
+     * The guards generated for the loop currently being optimized.
+     */
+    std::vector<std::shared_ptr<statement::statement_base>> _guards;
+    size_t _guard_count;
+
+    size_t _checks_seen;
+    size_t _checks_removed;
+    size_t _checks_guarded;
+
+    /**
+     * The parameter types of the functions we have seen so far.
+     *
+     * Used to determine whether an argument is passed by reference.
+     */
+    std::unordered_map<std::string, std::vector<data_type>> _functions;
+
+    /**
+     * The largest dynamic allocation that may be moved onto the stack.
+     */
+    static constexpr size_t MAX_DEMOTED_WIDTH = 4096;
+    size_t _allocations_demoted;
+
+    /**
+     * How a sequence of statements uses the names it refers to.
+     */
+    struct usage
+    {
+        std::unordered_set<std::string> mentioned;
+        std::unordered_set<std::string> allocated;
+        std::unordered_set<std::string> stored;     // anything written, including through an index or member
+        std::unordered_set<std::string> reseated;   // the name itself is given a new value
+        std::unordered_set<std::string> escaped;    // returned, moved, bound to a reference, or had its address taken
+        bool calls = false;
+        bool returns = false;
+        bool indirect_stores = false;
+        bool opaque = false;
+    };
+    size_t _refcounts_elided;
+
+    size_t _element_loops;
+
+    void enter_scope(const std::string& name);
+    void leave_scope();
+    const data_type* find_name(const std::string& name) const;
+    void add_name(const std::string& name, const data_type& type);
+
+    void optimize_block(statement::statement_block& block);
+    void optimize_statement(statement::statement_base& s);
+    void optimize_branch(statement::statement_base* branch);
+    void optimize_loop( statement::while_loop& loop,
+                        const std::vector<std::shared_ptr<statement::statement_base>>* preceding,
+                        size_t position );
+
+    // constant folding and simplification
+    static bool is_foldable_type(const data_type& t);
+    bool is_foldable(const expression::expression_base& exp) const;
+    static bool has_side_effects(const expression::expression_base& exp);
+    const data_type* get_type(const expression::expression_base& exp) const;
+
+    std::unique_ptr<expression::expression_base> fold(const expression::expression_base& exp, unsigned int line);
+    std::unique_ptr<expression::expression_base> simplify(const expression::binary& exp, unsigned int line);
+    bool literal_equals(const expression::expression_base& exp, int64_t value, unsigned int line);
+    bool literal_value(const expression::expression_base& exp, int64_t& value, unsigned int line);
+
+    // bounds-check elimination
+    static bool contains_call(const expression::expression_base& exp);
+    void collect_writes(const statement::statement_base& s,
+                        std::unordered_map<std::string, int64_t>& writes,
+                        bool& opaque);
+    bool is_non_negative_before(const std::string& index,
+                                const std::vector<std::shared_ptr<statement::statement_base>>& preceding,
+                                size_t position);
+    bool is_loop_invariant( const expression::expression_base& exp,
+                            const std::unordered_map<std::string, int64_t>& writes ) const;
+    void add_ranges(const expression::expression_base& condition,
+                    const std::unordered_map<std::string, int64_t>& writes,
+                    const std::vector<std::shared_ptr<statement::statement_base>>* preceding,
+                    size_t position,
+                    unsigned int line);
+    void kill_ranges(const std::unordered_map<std::string, int64_t>& writes);
+    void mark_bounds_checks(expression::expression_base& exp, unsigned int line);
+    void mark_bounds_checks(statement::statement_base& s);
+    bool constant_bound(const expression::expression_base& exp, int64_t& value, unsigned int line);
+    bool get_fixed_length(const std::string& name, size_t& length, unsigned int line);
+    bool is_indexable(const std::string& name) const;
+
+    // escape analysis
+    void add_function(const std::string& name, const std::vector<const statement::statement_base*>& formal_parameters);
+    static void collect_allocations(statement::statement_base& s,
+                                    std::vector<statement::allocation*>& allocations,
+                                    std::unordered_map<std::string, size_t>& counts);
+    void find_escapes(const expression::expression_base& exp, std::unordered_set<std::string>& escapes, bool& opaque) const;
+    void find_escapes(const statement::statement_base& s, std::unordered_set<std::string>& escapes, bool& opaque) const;
+    bool get_demoted_width(const data_type& t, size_t& width, unsigned int line);
+    void demote_allocations(statement::function_definition& def);
+
+    // reference count elision
+    static void collect_usage(const expression::expression_base& exp, usage& u);
+    static void collect_usage(const statement::statement_base& s, usage& u);
+    void borrow_parameters(statement::function_definition& def);
+    void elide_refcounts(statement::statement_block& block);
+
+    // element-wise loops
+    bool find_element_arrays(const expression::expression_base& exp,
+                            const std::string& index,
+                            std::vector<std::pair<std::string, data_type>>& arrays) const;
+    void mark_element_wise( statement::while_loop& loop,
+                            const std::string& index,
+                            const std::unordered_map<std::string, int64_t>& writes );
+public:
+    /**
+     * Optimizes the given AST in place.
+     */
+    void optimize(statement::statement_block& ast);
+
+    unsigned int get_level() const { return _level; }
+
+    /**
+     * Prints a summary of what the optimizer did.
+     */
+    void print_report(std::ostream& out) const;
+
+    optimizer(unsigned int level);
+    ~optimizer();
+};
@@ -0,0 +1,414 @@
+#include "optimizer.hpp"
+
+/**
+ * Checks whether data of the given type holds a reference counted by the MAM.
+ */
+static bool is_counted_reference(const data_type& t)
+{
+    using enumerations::primitive_type;
+
+    return (t.get_primary() == primitive_type::PTR && t.get_qualities().is_managed()) ||
+        t.get_primary() == primitive_type::REFERENCE;
+}
+
+/**
+ * Checks whether the given data owns a reference it must release when it goes out of scope.
+ */
+static bool is_owner(const data_type& t)
+{
+    return (is_counted_reference(t) && t.get_primary() != enumerations::primitive_type::REFERENCE) ||
+        t.get_qualities().is_dynamic();
+}
+
+/**
+ * Gets the name at the root of an lvalue, looking through indices and member selection.
+ */
+static const std::string* get_lvalue_root(const expression::expression_base& exp)
+{
+    using enumerations::expression_type;
+
+    const expression::expression_base* current = &exp;
+    while (true)
+    {
+        if (current->get_expression_type() == expression_type::IDENTIFIER)
+        {
+            return &static_cast<const expression::identifier*>(current)->getValue();
+        }
+        else if (current->get_expression_type() == expression_type::INDEXED)
+        {
+            current = &static_cast<const expression::indexed*>(current)->get_to_index();
+        }
+        else if (current->get_expression_type() == expression_type::BINARY &&
+            static_cast<const expression::binary*>(current)->get_operator() == enumerations::exp_operator::DOT)
+        {
+            current = &static_cast<const expression::binary*>(current)->get_left();
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+}
+
+static const std::string* get_identifier(const expression::expression_base& exp)
+{
+    if (exp.get_expression_type() == enumerations::expression_type::IDENTIFIER)
+        return &static_cast<const expression::identifier&>(exp).getValue();
+    else
+        return nullptr;
+}
+
+void optimizer::collect_usage(const expression::expression_base& exp, usage& u)
+{
+    using enumerations::expression_type;
+
+    switch (exp.get_expression_type())
+    {
+    case expression_type::LITERAL:
+    case expression_type::KEYWORD_EXP:
+        break;
+    case expression_type::IDENTIFIER:
+        u.mentioned.insert(static_cast<const expression::identifier&>(exp).getValue());
+        break;
+    case expression_type::UNARY:
+    {
+        auto& u_exp = static_cast<const expression::unary&>(exp);
+        if (u_exp.get_operator() == enumerations::exp_operator::ADDRESS)
+        {
+            const std::string* name = get_lvalue_root(u_exp.get_operand());
+            if (name)
+                u.escaped.insert(*name);
+            else
+                u.opaque = true;
+        }
+
+        collect_usage(u_exp.get_operand(), u);
+        break;
+    }
+    case expression_type::BINARY:
+    {
+        auto& b = static_cast<const expression::binary&>(exp);
+        collect_usage(b.get_left(), u);
+        collect_usage(b.get_right(), u);
+        break;
+    }
+    case expression_type::CAST:
+        collect_usage(static_cast<const expression::typecast&>(exp).get_exp(), u);
+        break;
+    case expression_type::ATTRIBUTE:
+        collect_usage(static_cast<const expression::attribute_selection&>(exp).get_selected(), u);
+        break;
+    case expression_type::INDEXED:
+    {
+        auto& i = static_cast<const expression::indexed&>(exp);
+        collect_usage(i.get_to_index(), u);
+        collect_usage(i.get_index_value(), u);
+        break;
+    }
+    case expression_type::LIST:
+    {
+        for (auto member: static_cast<const expression::list_expression&>(exp).get_list())
+            collect_usage(*member, u);
+        break;
+    }
+    case expression_type::CALL_EXP:
+    case expression_type::PROC_EXP:
+    {
+        auto& proc = static_cast<const expression::procedure&>(exp);
+        u.calls = true;
+        collect_usage(proc.get_func_name(), u);
+        for (size_t i = 0; i < proc.get_num_args(); i++)
+            collect_usage(proc.get_arg(i), u);
+        break;
+    }
+    default:
+        // constructions
+        u.opaque = true;
+        break;
+    }
+}
+
+void optimizer::collect_usage(const statement::statement_base& s, usage& u)
+{
+    using enumerations::statement_type;
+
+    switch (s.get_statement_type())
+    {
+    case statement_type::ALLOCATION:
+    {
+        auto& alloc = static_cast<const statement::allocation&>(s);
+        u.allocated.insert(alloc.get_name());
+        if (alloc.get_initial_value())
+        {
+            const std::string* name = get_lvalue_root(*alloc.get_initial_value());
+            if (name && alloc.get_type_information().get_primary() == enumerations::primitive_type::REFERENCE)
+                u.escaped.insert(*name);
+
+            collect_usage(*alloc.get_initial_value(), u);
+        }
+        break;
+    }
+    case statement_type::ASSIGNMENT:
+    case statement_type::COMPOUND_ASSIGNMENT:
+    case statement_type::MOVEMENT:
+    {
+        auto& assign = static_cast<const statement::assignment&>(s);
+        const std::string* target = get_lvalue_root(assign.get_lvalue());
+        if (target)
+        {
+            u.stored.insert(*target);
+            if (assign.get_lvalue().get_expression_type() == enumerations::expression_type::IDENTIFIER)
+                u.reseated.insert(*target);
+        }
+        else
+        {
+            // a store through a pointer could change anything
+            u.indirect_stores = true;
+        }
+
+        if (s.get_statement_type() == statement_type::MOVEMENT)
+        {
+            const std::string* source = get_lvalue_root(assign.get_rvalue());
+            if (source)
+                u.escaped.insert(*source);
+        }
+
+        collect_usage(assign.get_lvalue(), u);
+        collect_usage(assign.get_rvalue(), u);
+        break;
+    }
+    case statement_type::RETURN_STATEMENT:
+    {
+        auto& ret = static_cast<const statement::return_statement&>(s);
+        const std::string* name = get_lvalue_root(ret.get_return_exp());
+        if (name)
+            u.escaped.insert(*name);
+
+        u.returns = true;
+        collect_usage(ret.get_return_exp(), u);
+        break;
+    }
+    case statement_type::CALL:
+        collect_usage(static_cast<const expression::procedure&>(static_cast<const statement::call&>(s)), u);
+        break;
+    case statement_type::IF_THEN_ELSE:
+    {
+        auto& ite = static_cast<const statement::if_else&>(s);
+        collect_usage(ite.get_condition(), u);
+        if (ite.get_if_branch())
+            collect_usage(*ite.get_if_branch(), u);
+        if (ite.get_else_branch())
+            collect_usage(*ite.get_else_branch(), u);
+        break;
+    }
+    case statement_type::WHILE_LOOP:
+    {
+        auto& loop = static_cast<const statement::while_loop&>(s);
+        collect_usage(loop.get_condition(), u);
+        if (loop.get_branch())
+            collect_usage(*loop.get_branch(), u);
+        break;
+    }
+    case statement_type::SCOPED_BLOCK:
+    {
+        for (auto& inner: static_cast<const statement::scoped_block&>(s).get_statements().statements_list)
+            collect_usage(*inner, u);
+        break;
+    }
+    case statement_type::DECLARATION:
+    case statement_type::FUNCTION_DEFINITION:
+    case statement_type::STRUCT_DEFINITION:
+        break;
+    default:
+        // inline assembly, frees, constructions, etc.
+        u.opaque = true;
+        break;
+    }
+}
+
+/**
+ * Marks the managed parameters a function only borrows.
+ *
+ * The caller's reference keeps a parameter's data alive for the duration of the call,
+ * so a parameter that the function never reseats, moves, returns, or takes the address of needs no reference of its own.
+ * Since anything the function calls or stores outside of its own data could drop the caller's reference,
+ * we only do this for functions that make no calls and only store to their own parameters and locals.
+ */
+void optimizer::borrow_parameters(statement::function_definition& def)
+{
+    std::vector<statement::allocation*> allocations;
+    std::unordered_map<std::string, size_t> counts;
+    for (auto& s: def.get_procedure().statements_list)
+        collect_allocations(*s, allocations, counts);
+
+    usage u;
+    for (auto& s: def.get_procedure().statements_list)
+        collect_usage(*s, u);
+
+    if (u.opaque || u.calls || u.indirect_stores)
+        return;
+
+    std::unordered_set<std::string> locals;
+    for (auto alloc: allocations)
+        locals.insert(alloc->get_name());
+    for (auto param: def.get_formal_parameters())
+    {
+        if (param->get_statement_type() == enumerations::statement_type::ALLOCATION)
+            locals.insert(static_cast<statement::allocation*>(param)->get_name());
+    }
+
+    for (auto& name: u.stored)
+    {
+        if (!locals.count(name))
+            return;
+    }
+
+    for (auto param: def.get_formal_parameters())
+    {
+        if (param->get_statement_type() != enumerations::statement_type::ALLOCATION)
+            continue;
+
+        auto alloc = static_cast<statement::allocation*>(param);
+        const std::string& name = alloc->get_name();
+        if (!is_counted_reference(alloc->get_type_information()) ||
+            counts.count(name) ||
+            u.reseated.count(name) ||
+            u.escaped.count(name))
+        {
+            continue;
+        }
+
+        alloc->elide_add_ref();
+        alloc->elide_release();
+        _refcounts_elided += 2;
+    }
+}
+
+/**
+ * Elides reference count operations on the statements of a block.
+ *
+ * This handles:
+ *  - managed data initialized or assigned with the result of a call; the call's result already owns a reference,
+ *    which is adopted instead of incrementing the count and then releasing the temporary
+ *  - local aliases like `alloc ptr<T> q: p`, where neither `p` nor `q` is reseated or moved while `q` is in scope
+ *    and nothing in that scope could release `p`'s data; `q` borrows `p`'s reference
+ *  - movements out of a local owner that is never used again; the reference is transferred instead of copied and then released
+ *
+ * Nested blocks are handled when they are optimized.
+ */
+void optimizer::elide_refcounts(statement::statement_block& block)
+{
+    using enumerations::statement_type;
+
+    auto& statements = block.statements_list;
+    for (size_t i = 0; i < statements.size(); i++)
+    {
+        statement::statement_base& s = *statements[i];
+        if (s.get_statement_type() == statement_type::ALLOCATION)
+        {
+            auto& alloc = static_cast<statement::allocation&>(s);
+            const data_type& t = alloc.get_type_information();
+            const expression::expression_base* init = alloc.get_initial_value();
+            if (!init || !is_counted_reference(t) || t.get_primary() == enumerations::primitive_type::REFERENCE)
+                continue;
+
+            if (init->get_expression_type() == enumerations::expression_type::CALL_EXP)
+            {
+                alloc.elide_add_ref();
+                _refcounts_elided += 2;
+                continue;
+            }
+
+            // the data we borrow must be held by a managed pointer or reference, or be dynamic data we take the address of
+            const std::string* source = get_identifier(*init);
+            const data_type* source_type = source ? find_name(*source) : nullptr;
+            if (source_type && !is_counted_reference(*source_type))
+            {
+                source_type = nullptr;
+            }
+            else if (!source &&
+                init->get_expression_type() == enumerations::expression_type::UNARY &&
+                static_cast<const expression::unary*>(init)->get_operator() == enumerations::exp_operator::ADDRESS)
+            {
+                source = get_identifier(static_cast<const expression::unary*>(init)->get_operand());
+                source_type = source ? find_name(*source) : nullptr;
+                if (source_type && !source_type->get_qualities().is_dynamic())
+                    source_type = nullptr;
+            }
+
+            if (!source_type || t.get_qualities().is_dynamic())
+                continue;
+
+            usage u;
+            for (size_t j = i + 1; j < statements.size(); j++)
+                collect_usage(*statements[j], u);
+
+            const std::string& name = alloc.get_name();
+            if (u.opaque || u.calls || u.indirect_stores ||
+                u.allocated.count(name) || u.allocated.count(*source) ||
+                u.reseated.count(name) || u.reseated.count(*source) ||
+                u.escaped.count(name) || u.escaped.count(*source))
+            {
+                continue;
+            }
+
+            alloc.elide_add_ref();
+            alloc.elide_release();
+            _refcounts_elided += 2;
+        }
+        else if (s.get_statement_type() == statement_type::ASSIGNMENT || s.get_statement_type() == statement_type::MOVEMENT)
+        {
+            auto& assign = static_cast<statement::assignment&>(s);
+            const std::string* target = get_identifier(assign.get_lvalue());
+            const data_type* target_type = target ? find_name(*target) : nullptr;
+            if (!target_type || !is_owner(*target_type))
+                continue;
+
+            if (assign.get_rvalue().get_expression_type() == enumerations::expression_type::CALL_EXP)
+            {
+                assign.elide_add_ref();
+                _refcounts_elided += 2;
+                continue;
+            }
+
+            const std::string* source = get_identifier(assign.get_rvalue());
+            if (s.get_statement_type() != statement_type::MOVEMENT || !source)
+                continue;
+
+            // find the source's allocation; it must be an owner in this block
+            statement::allocation* source_alloc = nullptr;
+            size_t allocated_at = 0;
+            for (size_t j = 0; j < i; j++)
+            {
+                if (statements[j]->get_statement_type() == statement_type::ALLOCATION &&
+                    static_cast<statement::allocation&>(*statements[j]).get_name() == *source)
+                {
+                    source_alloc = static_cast<statement::allocation*>(statements[j].get());
+                    allocated_at = j;
+                }
+            }
+
+            if (!source_alloc || !is_owner(source_alloc->get_type_information()) || !source_alloc->needs_release())
+                continue;
+
+            // it mustn't be aliased or leave the scope before the movement, nor be used after it
+            usage before;
+            for (size_t j = allocated_at + 1; j < i; j++)
+                collect_usage(*statements[j], before);
+
+            usage after;
+            for (size_t j = i + 1; j < statements.size(); j++)
+                collect_usage(*statements[j], after);
+
+            if (before.opaque || before.returns || before.escaped.count(*source) ||
+                after.opaque || after.mentioned.count(*source) || after.allocated.count(*source))
+            {
+                continue;
+            }
+
+            assign.elide_add_ref();
+            source_alloc->elide_release();
+            _refcounts_elided += 2;
+        }
+    }
+}
@@ -8,6 +8,10 @@ namespace expression
         return *this->selected;
     }
 
+    expression_base &attribute_selection::get_selected() {
+        return *this->selected;
+    }
+
     enumerations::attribute attribute_selection::get_attribute() const {
         return this->attrib;
     }
@@ -99,7 +103,8 @@ namespace expression
     attribute_selection::attribute_selection(   std::unique_ptr<expression_base>&& selected, 
                                                 enumerations::attribute attrib, 
                                                 const data_type& t  )
-        : selected(std::move(selected))
+        : expression_base(enumerations::expression_type::ATTRIBUTE)
+        , selected(std::move(selected))
         , attrib(attrib)
         , t(t) { }
 }
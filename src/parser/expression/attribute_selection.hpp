@@ -20,6 +20,8 @@ namespace expression
         static bool is_attribute(const std::string& a);
 
         const expression_base &get_selected() const;
+
+        expression_base &get_selected();
         enumerations::attribute get_attribute() const;
         const data_type &get_data_type() const;
 
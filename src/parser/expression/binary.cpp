@@ -16,10 +16,18 @@ namespace expression
         return *this->left_exp.get();
     }
 
+    expression_base &binary::get_left() {
+        return *this->left_exp.get();
+    }
+
     const expression_base &binary::get_right() const {
         return *this->right_exp.get();
     }
 
+    expression_base &binary::get_right() {
+        return *this->right_exp.get();
+    }
+
     enumerations::exp_operator binary::get_operator() const {
         return this->op;
     }
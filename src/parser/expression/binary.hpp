@@ -21,7 +21,9 @@ namespace expression
         std::unique_ptr<expression_base> get_right_unique();
     public:
         const expression_base &get_left() const;
+        expression_base &get_left();
         const expression_base &get_right() const;
+        expression_base &get_right();
 
         enumerations::exp_operator get_operator() const;
 
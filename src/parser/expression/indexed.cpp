@@ -7,16 +7,48 @@ namespace expression
         return *this->index_value.get();
     }
 
+    expression_base &indexed::get_index_value()
+    {
+        return *this->index_value.get();
+    }
+
     const expression_base &indexed::get_to_index() const
     {
         return *this->to_index.get();
     }
 
+    expression_base &indexed::get_to_index()
+    {
+        return *this->to_index.get();
+    }
+
+    bool indexed::is_bounds_checked() const
+    {
+        return this->bounds_checked;
+    }
+
+    const std::string &indexed::get_bounds_guard() const
+    {
+        return this->bounds_guard;
+    }
+
+    void indexed::remove_bounds_check()
+    {
+        this->bounds_checked = false;
+        this->bounds_guard.clear();
+    }
+
+    void indexed::set_bounds_guard(const std::string& guard)
+    {
+        this->bounds_guard = guard;
+    }
+
     indexed::indexed(   std::unique_ptr<expression_base> to_index, 
                         std::unique_ptr<expression_base> index_value)
         : expression_base(enumerations::expression_type::INDEXED)
         , to_index(std::move(to_index))
-        , index_value(std::move(index_value)) {}
+        , index_value(std::move(index_value))
+        , bounds_checked(true) {}
 
     indexed::indexed()
         : indexed(nullptr, nullptr) {}
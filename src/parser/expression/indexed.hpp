@@ -2,22 +2,42 @@
 
 #include "expression.hpp"
 
+#include <string>
+
 namespace expression
 {
     class indexed : public expression_base
     {
         std::unique_ptr<expression_base> index_value;	// the index value is simply an expression
         std::unique_ptr<expression_base> to_index;	// what we are indexing
+
+        bool bounds_checked;	// cleared by the optimizer when the index is provably in range
+        std::string bounds_guard;	// if set, the check is skipped at runtime when this guard is true
     public:
         const expression_base &get_index_value() const;
+        expression_base &get_index_value();
         const expression_base &get_to_index() const;
+        expression_base &get_to_index();
+
+        /**
+         * Whether this access needs a runtime bounds check.
+         *
+         * Note that a guarded access still needs its check generated; it will only be performed if the guard is false.
+         */
+        bool is_bounds_checked() const;
+        const std::string &get_bounds_guard() const;
+        void remove_bounds_check();
+        void set_bounds_guard(const std::string& guard);
 
         inline virtual std::unique_ptr<expression_base> clone() const override
         {
-            return std::make_unique<indexed>(
+            auto c = std::make_unique<indexed>(
                 to_index->clone(),
                 index_value->clone()
             );
+            c->bounds_checked = bounds_checked;
+            c->bounds_guard = bounds_guard;
+            return c;
         }
 
         indexed(std::unique_ptr<expression_base> to_index, std::unique_ptr<expression_base> index_value);
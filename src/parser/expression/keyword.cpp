@@ -23,7 +23,8 @@ namespace expression
         , _keyword(kwd) { }
 
     keyword::keyword(const data_type& t)
-        : _keyword("")
+        : expression_base(enumerations::expression_type::KEYWORD_EXP)
+        , _keyword("")
         , _type(t) { }
 
     keyword::keyword(const data_type& t, const std::string& kwd)
@@ -19,6 +19,15 @@ namespace expression
         return to_return;
     }
 
+    std::vector<expression_base*> list_expression::get_list()
+    {
+        std::vector<expression_base*> to_return;
+        for (auto it = this->list_members.begin(); it != this->list_members.end(); it++) {
+            to_return.push_back(it->get());
+        }
+        return to_return;
+    }
+
     void list_expression::add_item(std::unique_ptr<expression_base> to_add, const size_t index) {
         if (index <= this->list_members.size()) {
             auto it = this->list_members.begin() + index;
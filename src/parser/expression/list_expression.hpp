@@ -10,6 +10,7 @@ namespace expression
         std::vector<std::unique_ptr<expression_base>> list_members;
     public:
         std::vector<const expression_base*> get_list() const;
+        std::vector<expression_base*> get_list();
         bool has_type_information() const override;
         enumerations::primitive_type get_list_type() const;	// the list type that we parsed -- () yields TUPLE, {} yields ARRAY
 
@@ -7,6 +7,10 @@ namespace expression
         return *this->to_cast;
     }
 
+    expression_base &typecast::get_exp() {
+        return *this->to_cast;
+    }
+
     const data_type& typecast::get_new_type() const {
         return this->new_type;
     }
@@ -12,6 +12,7 @@ namespace expression
         data_type new_type;	// the new type for the expression
     public:
         const expression_base &get_exp() const;
+        expression_base &get_exp();
         const data_type &get_new_type() const;
 
         inline virtual std::unique_ptr<expression_base> clone() const override
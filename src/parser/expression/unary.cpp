@@ -10,6 +10,10 @@ namespace expression
         return *this->operand.get();
     }
 
+    expression_base &unary::get_operand() {
+        return *this->operand.get();
+    }
+
     unary::unary(std::unique_ptr<expression_base> operand, enumerations::exp_operator op)
         : expression_base(enumerations::expression_type::UNARY)
         , operand(std::move(operand))
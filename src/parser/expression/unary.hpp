@@ -12,6 +12,7 @@ namespace expression
     public:
         enumerations::exp_operator get_operator() const;
         const expression_base &get_operand() const;
+        expression_base &get_operand();
 
         inline virtual std::unique_ptr<expression_base> clone() const override
         {
@@ -150,8 +150,13 @@ These are used to test whether a character is of a certain type.
 
 bool lexer::match_character(const char ch, const std::string& expression) {
 	try {
-        // todo: is there a more efficient way to test one character against a regex?
-		return std::regex_match(std::string(1, ch), std::regex(expression));
+		// each expression is compiled once; compiling it for every character made lexing most of the compile time
+		static thread_local std::unordered_map<std::string, std::regex> compiled;
+		auto it = compiled.find(expression);
+		if (it == compiled.end()) {
+			it = compiled.emplace(expression, std::regex(expression)).first;
+		}
+		return std::regex_match(std::string(1, ch), it->second);
 	}
 	catch (const std::regex_error &e) {
 		std::cerr << "REGEX ERROR:" << std::endl << e.what() << std::endl;	// todo: reevaluate whether these functions need to be static
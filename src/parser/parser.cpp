@@ -1,4 +1,5 @@
 #include "parser.hpp"
+#include "../util/phase_report.hpp"
 
 statement::statement_block parser::create_ast() {
 	/*
@@ -62,6 +63,7 @@ parser::parser(const std::string& filename)
 
 	// Tokenize the file
 	std::cout << "Lexing..." << std::endl;
+	general_utilities::phase_report::scope lexing("lex", filename);
 	while (!lexer.eof() && !lexer.exit_flag_is_set()) {
 		lexeme token = lexer.read_next();
 
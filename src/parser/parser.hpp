@@ -59,6 +59,7 @@ class parser
 
 	// get the appropriate enumerations::symbol_quality member from the lexeme containing it
 	static enumerations::symbol_quality get_quality(lexeme quality_token);
+	static bool is_contextual_quality(const lexeme& l);	// qualities that are only keywords where a quality may appear
 
 	// we have to fetch a type (and its qualities) more than once; use a tuple for this
 	data_type get_type(const std::string& grouping_symbol = "");
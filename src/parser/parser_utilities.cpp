@@ -399,7 +399,7 @@ data_type parser::get_type(const std::string& grouping_symbol)
 		subtype_is_list = true;
 		if (this->peek().value == "<") {
 			this->next();
-			while (this->peek().type == enumerations::lexeme_type::KEYWORD_LEX) {
+			while (this->peek().type == enumerations::lexeme_type::KEYWORD_LEX || is_contextual_quality(this->peek())) {
 				// get the type
 				this->next();
 				data_type sub = this->get_type();
@@ -522,7 +522,8 @@ symbol_qualities parser::get_prefix_qualities(const std::string& grouping_symbol
 
 	// loop until we don't have a quality token, at which point we should return the qualities object
 	lexeme current = this->current_token();
-	while (current.type == enumerations::lexeme_type::KEYWORD_LEX && !is_type(current.value)) {
+	while ((current.type == enumerations::lexeme_type::KEYWORD_LEX && !is_type(current.value)) ||
+		(is_contextual_quality(current) && this->peek().type == enumerations::lexeme_type::KEYWORD_LEX)) {
 		// get the current quality and add it to our qualities object
 		try {
 			qualities.add_quality(get_quality(current));
@@ -552,7 +553,7 @@ symbol_qualities parser::get_postfix_qualities(const std::string& grouping_symbo
 
 	// continue parsing our SymbolQualities until we hit a semicolon, at which point we will trigger the 'done' flag
 	bool done = false;
-	while (this->peek().type == enumerations::lexeme_type::KEYWORD_LEX) {
+	while (this->peek().type == enumerations::lexeme_type::KEYWORD_LEX || is_contextual_quality(this->peek())) {
 		lexeme quality_token = this->next();	// get the token for the quality
 		enumerations::symbol_quality quality = this->get_quality(quality_token);	// use our 'get_quality' function to get the enumerations::symbol_quality based on the token
 
@@ -567,6 +568,12 @@ symbol_qualities parser::get_postfix_qualities(const std::string& grouping_symbo
 	return qualities;
 }
 
+bool parser::is_contextual_quality(const lexeme& l)
+{
+	// 'soa' may still be used as a name everywhere else
+	return l.type == enumerations::lexeme_type::IDENTIFIER_LEX && l.value == "soa";
+}
+
 enumerations::symbol_quality parser::get_quality(lexeme quality_token)
 {
 	// Given a lexeme containing a quality, returns the appropriate member from enumerations::symbol_quality
@@ -574,7 +581,7 @@ enumerations::symbol_quality parser::get_quality(lexeme quality_token)
 	enumerations::symbol_quality to_return = enumerations::symbol_quality::NO_QUALITY;
 
 	// ensure the token is a kwd
-	if (quality_token.type == enumerations::lexeme_type::KEYWORD_LEX) {
+	if (quality_token.type == enumerations::lexeme_type::KEYWORD_LEX || is_contextual_quality(quality_token)) {
 		// Use the unordered_map to find the quality
 		auto it = symbol_qualities::quality_strings.find(quality_token.value);
 		
@@ -44,6 +44,36 @@ namespace statement
         return this->initial_value.get();
     }
 
+    expression::expression_base *allocation::get_initial_value()
+    {
+        return this->initial_value.get();
+    }
+
+    void allocation::set_initial_value(std::unique_ptr<expression::expression_base>&& new_value)
+    {
+        this->initial_value = std::move(new_value);
+    }
+
+    bool allocation::needs_add_ref() const
+    {
+        return this->adds_reference;
+    }
+
+    bool allocation::needs_release() const
+    {
+        return this->releases_reference;
+    }
+
+    void allocation::elide_add_ref()
+    {
+        this->adds_reference = false;
+    }
+
+    void allocation::elide_release()
+    {
+        this->releases_reference = false;
+    }
+
     allocation::allocation( const data_type& type_information,
                             const std::string& value, 
                             const bool initialized, 
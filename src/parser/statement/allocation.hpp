@@ -16,6 +16,9 @@ namespace statement
 
         expression::identifier struct_name;
         std::unique_ptr<expression::expression_base> initial_value;
+
+        bool adds_reference = true;	// cleared by the optimizer when the initial value's reference count need not be incremented
+        bool releases_reference = true;	// cleared by the optimizer when the data need not be released at scope exit
     public:
         data_type& get_type_information();
         const data_type& get_type_information() const;
@@ -24,6 +27,18 @@ namespace statement
 
         bool was_initialized() const;
         const expression::expression_base* get_initial_value() const;
+        expression::expression_base* get_initial_value();
+        void set_initial_value(std::unique_ptr<expression::expression_base>&& new_value);
+
+        /**
+         * Whether managed data bound by this allocation needs its reference count incremented and decremented.
+         *
+         * An allocation that does neither is borrowing a reference that is kept alive elsewhere.
+         */
+        bool needs_add_ref() const;
+        bool needs_release() const;
+        void elide_add_ref();
+        void elide_release();
 
         allocation( const data_type& type_information, 
                     const std::string& value, 
@@ -6,10 +6,34 @@ namespace statement
         return *this->lvalue.get();
     }
 
+    expression::expression_base& assignment::get_lvalue() {
+        return *this->lvalue.get();
+    }
+
     const expression::expression_base& assignment::get_rvalue() const {
         return *this->rvalue_ptr.get();
     }
 
+    expression::expression_base& assignment::get_rvalue() {
+        return *this->rvalue_ptr.get();
+    }
+
+    void assignment::set_lvalue(std::unique_ptr<expression::expression_base>&& new_lvalue) {
+        this->lvalue = std::move(new_lvalue);
+    }
+
+    void assignment::set_rvalue(std::unique_ptr<expression::expression_base>&& new_rvalue) {
+        this->rvalue_ptr = std::move(new_rvalue);
+    }
+
+    bool assignment::needs_add_ref() const {
+        return this->adds_reference;
+    }
+
+    void assignment::elide_add_ref() {
+        this->adds_reference = false;
+    }
+
     assignment::assignment(std::unique_ptr<expression::expression_base>&& lvalue, std::unique_ptr<expression::expression_base>&& rvalue) 
         : statement_base(enumerations::statement_type::ASSIGNMENT)
         , lvalue(std::move(lvalue)) 
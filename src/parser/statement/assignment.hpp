@@ -10,9 +10,24 @@ namespace statement
     protected:
         std::unique_ptr<expression::expression_base> lvalue;
         std::unique_ptr<expression::expression_base> rvalue_ptr;
+
+        bool adds_reference = true;	// cleared by the optimizer when the new value's reference count need not be incremented
     public:
         const expression::expression_base& get_lvalue() const;
+        expression::expression_base& get_lvalue();
         const expression::expression_base& get_rvalue() const;
+        expression::expression_base& get_rvalue();
+
+        void set_lvalue(std::unique_ptr<expression::expression_base>&& new_lvalue);
+        void set_rvalue(std::unique_ptr<expression::expression_base>&& new_rvalue);
+
+        /**
+         * Whether managed data stored by this assignment needs its reference count incremented.
+         *
+         * The old value is always released.
+         */
+        bool needs_add_ref() const;
+        void elide_add_ref();
 
         assignment(std::unique_ptr<expression::expression_base>&& lvalue, std::unique_ptr<expression::expression_base>&& rvalue);
         assignment(const expression::identifier& lvalue, std::unique_ptr<expression::expression_base>&& rvalue);
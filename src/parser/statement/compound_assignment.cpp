@@ -13,6 +13,7 @@ namespace statement
                                                 enumerations::exp_operator op)	
         : assignment(std::move(lvalue)
         , std::make_unique<expression::binary>(lvalue->clone(), std::move(rvalue), op))
+        , _op(op)
         {
             this->_type = enumerations::statement_type::COMPOUND_ASSIGNMENT;
         }
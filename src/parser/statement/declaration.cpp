@@ -30,6 +30,11 @@ namespace statement
         return this->initial_value.get();
     }
 
+    const expression::expression_base* declaration::get_initial_value() const
+    {
+        return this->initial_value.get();
+    }
+
     std::vector<statement_base*> declaration::get_formal_parameters() {
         std::vector<statement_base*> to_return;
         for (auto it = this->formal_parameters.begin(); it != this->formal_parameters.end(); it++) {
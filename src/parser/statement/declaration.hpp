@@ -30,6 +30,7 @@ namespace statement
         bool is_struct() const;
 
         expression::expression_base* get_initial_value();
+        const expression::expression_base* get_initial_value() const;
 
         std::vector<statement_base*> get_formal_parameters();
         std::vector<const statement_base*> get_formal_parameters() const;
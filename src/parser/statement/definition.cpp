@@ -10,6 +10,10 @@ namespace statement
         return *this->procedure.get();
     }
 
+    statement_block& definition::get_procedure() {
+        return *this->procedure.get();
+    }
+
     definition::definition(const std::string& name, std::unique_ptr<statement_block>&& procedure)
         : statement_base()
         , name(name)
@@ -16,6 +16,7 @@ namespace statement
     public:
         const std::string& get_name() const;
         const statement_block& get_procedure() const;
+        statement_block& get_procedure();
 
         definition(const std::string& name, std::unique_ptr<statement_block>&& procedure);
         definition();
@@ -15,6 +15,14 @@ namespace statement
         return to_return;
     }
 
+    std::vector<statement_base*> function_definition::get_formal_parameters() {
+        std::vector<statement_base*> to_return;
+        for (auto it = this->formal_parameters.begin(); it != this->formal_parameters.end(); it++) {
+            to_return.push_back(it->get());
+        }
+        return to_return;
+    }
+
     function_definition::function_definition(   const std::string& name,
                                                 const data_type& return_type,
                                                 std::vector<std::unique_ptr<statement_base>>& args_ptr,
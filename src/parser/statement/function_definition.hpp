@@ -13,6 +13,7 @@ namespace statement
     public:
         const data_type& get_type_information() const;
         std::vector<const statement_base*> get_formal_parameters() const;
+        std::vector<statement_base*> get_formal_parameters();
         
         function_definition(const std::string& name,
                             const data_type& return_type,
@@ -6,6 +6,10 @@ namespace statement
         return *this->condition.get();
     }
 
+    expression::expression_base& if_else::get_condition() {
+        return *this->condition.get();
+    }
+
     const statement_base* if_else::get_if_branch() const {
         return this->if_branch.get();
     }
@@ -14,6 +18,18 @@ namespace statement
         return this->else_branch.get();
     }
 
+    statement_base* if_else::get_if_branch() {
+        return this->if_branch.get();
+    }
+
+    statement_base* if_else::get_else_branch() {
+        return this->else_branch.get();
+    }
+
+    void if_else::set_condition(std::unique_ptr<expression::expression_base>&& new_condition) {
+        this->condition = std::move(new_condition);
+    }
+
     if_else::if_else(   std::unique_ptr<expression::expression_base>&& condition_ptr,
                         std::unique_ptr<statement_base>&& if_branch_ptr,
                         std::unique_ptr<statement_base>&& else_branch_ptr)
@@ -12,8 +12,13 @@ namespace statement
         std::unique_ptr<statement_base> else_branch;
     public:
         const expression::expression_base& get_condition() const;
+        expression::expression_base& get_condition();
         const statement_base* get_if_branch() const;
         const statement_base* get_else_branch() const;
+        statement_base* get_if_branch();
+        statement_base* get_else_branch();
+
+        void set_condition(std::unique_ptr<expression::expression_base>&& new_condition);
 
         if_else(std::unique_ptr<expression::expression_base>&& condition, 
                 std::unique_ptr<statement_base>&& if_branch,
@@ -6,6 +6,14 @@ namespace statement
         return *this->return_exp.get();
     }
 
+    expression::expression_base& return_statement::get_return_exp() {
+        return *this->return_exp.get();
+    }
+
+    void return_statement::set_return_exp(std::unique_ptr<expression::expression_base>&& new_exp) {
+        this->return_exp = std::move(new_exp);
+    }
+
     return_statement::return_statement(std::unique_ptr<expression::expression_base>&& exp_ptr)
         : statement_base(enumerations::statement_type::RETURN_STATEMENT)
         , return_exp(std::move(exp_ptr)) { }
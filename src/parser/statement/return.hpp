@@ -10,6 +10,8 @@ namespace statement
         std::unique_ptr<expression::expression_base> return_exp;
     public:
         const expression::expression_base& get_return_exp() const;
+        expression::expression_base& get_return_exp();
+        void set_return_exp(std::unique_ptr<expression::expression_base>&& new_exp);
 
         return_statement(std::unique_ptr<expression::expression_base>&& exp_ptr);
         return_statement();
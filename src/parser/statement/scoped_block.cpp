@@ -6,6 +6,10 @@ namespace statement
         return this->statements;
     }
 
+    statement_block& scoped_block::get_statements() {
+        return this->statements;
+    }
+
     scoped_block::scoped_block(const statement_block& statements)
         : statement_base(enumerations::statement_type::SCOPED_BLOCK)
         , statements(statements) { }
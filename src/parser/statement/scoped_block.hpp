@@ -10,6 +10,7 @@ namespace statement
         statement_block statements;
     public:
         const statement_block& get_statements() const;
+        statement_block& get_statements();
         
         scoped_block(const statement_block& statements);
         virtual ~scoped_block() = default;
@@ -7,11 +7,47 @@ namespace statement
         return *this->condition.get();
     }
 
+    expression::expression_base& while_loop::get_condition()
+    {
+        return *this->condition.get();
+    }
+
     const statement_base* while_loop::get_branch() const
     {
         return this->branch.get();
     }
 
+    statement_base* while_loop::get_branch()
+    {
+        return this->branch.get();
+    }
+
+    void while_loop::set_condition(std::unique_ptr<expression::expression_base>&& new_condition)
+    {
+        this->condition = std::move(new_condition);
+    }
+
+    bool while_loop::is_element_wise() const
+    {
+        return !this->induction_variable.empty();
+    }
+
+    const std::string& while_loop::get_induction_variable() const
+    {
+        return this->induction_variable;
+    }
+
+    const std::vector<std::pair<std::string, data_type>>& while_loop::get_element_arrays() const
+    {
+        return this->element_arrays;
+    }
+
+    void while_loop::set_element_wise(const std::string& index, std::vector<std::pair<std::string, data_type>>&& arrays)
+    {
+        this->induction_variable = index;
+        this->element_arrays = std::move(arrays);
+    }
+
     while_loop::while_loop(std::unique_ptr<expression::expression_base>&& condition, std::unique_ptr<statement_base>&& branch) 
         : statement_base(enumerations::statement_type::WHILE_LOOP)
         , condition(std::move(condition))
@@ -2,6 +2,11 @@
 
 #include "statement.hpp"
 #include "../expression/expression.hpp"
+#include "../../util/data_type.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
 
 namespace statement
 {
@@ -9,9 +14,26 @@ namespace statement
     {
         std::unique_ptr<expression::expression_base> condition;
         std::unique_ptr<statement_base> branch;
+
+        std::string induction_variable;	// set by the optimizer if the loop only touches array elements at this index
+        std::vector<std::pair<std::string, data_type>> element_arrays;	// the arrays indexed in the loop, with their types
     public:
         const expression::expression_base& get_condition() const;
+        expression::expression_base& get_condition();
         const statement_base* get_branch() const;
+        statement_base* get_branch();
+
+        void set_condition(std::unique_ptr<expression::expression_base>&& new_condition);
+
+        /**
+         * Whether this is a counted loop that steps its index by one and only accesses arrays at that index.
+         *
+         * Such loops have no dependencies between iterations, so their element accesses may go through pointers hoisted out of the loop.
+         */
+        bool is_element_wise() const;
+        const std::string& get_induction_variable() const;
+        const std::vector<std::pair<std::string, data_type>>& get_element_arrays() const;
+        void set_element_wise(const std::string& index, std::vector<std::pair<std::string, data_type>>&& arrays);
 
         while_loop(std::unique_ptr<expression::expression_base>&& condition, std::unique_ptr<statement_base>&& branch);
         while_loop();
@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "sinl_alloc_profile.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Every site that has allocated, most recent first.
+ */
+static struct sinl_alloc_site *sites;
+static uint32_t site_count;
+static char sites_lock;
+
+/**
+ * The bytes live across every site, and the most that ever were at once.
+ */
+static int64_t live_bytes;
+static int64_t peak_bytes;
+
+static volatile sig_atomic_t report_requested;
+
+static void request_report(int signal)
+{
+    (void)signal;
+    report_requested = 1;
+}
+
+/**
+ * Raises `*peak` to `value` if it is higher.
+ */
+static void update_peak(int64_t *peak, int64_t value)
+{
+    int64_t current = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (value > current && !__atomic_compare_exchange_n(peak, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void register_site(struct sinl_alloc_site *site)
+{
+    while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE))
+        ;
+
+    if (site->id == 0)
+    {
+        if (site_count == 0)
+        {
+            atexit(sinl_alloc_profile_write);
+
+            // don't take SIGUSR1 from a program that uses it
+            struct sigaction previous;
+            if (sigaction(SIGUSR1, NULL, &previous) == 0 && previous.sa_handler == SIG_DFL)
+            {
+                struct sigaction action;
+                memset(&action, 0, sizeof action);
+                action.sa_handler = request_report;
+                sigemptyset(&action.sa_mask);
+                sigaction(SIGUSR1, &action, NULL);
+            }
+        }
+
+        site->next = sites;
+        sites = site;
+        __atomic_store_n(&site->id, ++site_count, __ATOMIC_RELEASE);
+    }
+
+    __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+}
+
+void sinl_alloc_profile_allocated(struct sinl_alloc_site *site, size_t size)
+{
+    if (report_requested)
+    {
+        report_requested = 0;
+        sinl_alloc_profile_write();
+    }
+
+    if (__atomic_load_n(&site->id, __ATOMIC_ACQUIRE) == 0)
+        register_site(site);
+
+    __atomic_add_fetch(&site->allocations, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&site->allocated_bytes, size, __ATOMIC_RELAXED);
+    update_peak(&site->peak_bytes, __atomic_add_fetch(&site->live_bytes, (int64_t)size, __ATOMIC_RELAXED));
+    update_peak(&peak_bytes, __atomic_add_fetch(&live_bytes, (int64_t)size, __ATOMIC_RELAXED));
+}
+
+void sinl_alloc_profile_freed(struct sinl_alloc_site *site, size_t size)
+{
+    __atomic_sub_fetch(&site->live_bytes, (int64_t)size, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&live_bytes, (int64_t)size, __ATOMIC_RELAXED);
+}
+
+/**
+ * Orders sites by the most bytes they ever had live, most first.
+ */
+static int compare_peak(const void *left, const void *right)
+{
+    const int64_t l = (*(struct sinl_alloc_site *const *)left)->peak_bytes;
+    const int64_t r = (*(struct sinl_alloc_site *const *)right)->peak_bytes;
+    return l < r ? 1 : l > r ? -1 : 0;
+}
+
+void sinl_alloc_profile_write(void)
+{
+    while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE))
+        ;
+    const uint32_t count = site_count;
+    struct sinl_alloc_site *first = sites;
+    __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+
+    struct sinl_alloc_site **order = malloc(((size_t)count + 1) * sizeof *order);
+    if (order == NULL)
+    {
+        fputs("sinl_alloc_profile: out of memory\n", stderr);
+        return;
+    }
+
+    size_t n = 0;
+    for (struct sinl_alloc_site *s = first; s != NULL && n < count; s = s->next)
+        order[n++] = s;
+    qsort(order, n, sizeof *order, compare_peak);
+
+    const char *filename = getenv("SINL_ALLOC_REPORT");
+    if (filename == NULL || filename[0] == '\0')
+        filename = "sinl_alloc_profile.txt";
+
+    FILE *out = strcmp(filename, "-") == 0 ? stderr : fopen(filename, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "sinl_alloc_profile: could not open '%s'\n", filename);
+        free(order);
+        return;
+    }
+
+    fprintf(out, "Managed allocations by site: %lld bytes live, %lld at peak\n\n",
+        (long long)__atomic_load_n(&live_bytes, __ATOMIC_RELAXED), (long long)__atomic_load_n(&peak_bytes, __ATOMIC_RELAXED));
+    fprintf(out, "%5s %12s %14s %14s %14s %12s %12s  %s\n",
+        "site", "allocations", "bytes", "live bytes", "peak bytes", "retains", "releases", "location");
+    for (size_t i = 0; i < n; i++)
+    {
+        const struct sinl_alloc_site *s = order[i];
+        fprintf(out, "%5u %12llu %14llu %14lld %14lld %12llu %12llu  %s:%u\n",
+            (unsigned)s->id,
+            (unsigned long long)__atomic_load_n(&s->allocations, __ATOMIC_RELAXED),
+            (unsigned long long)__atomic_load_n(&s->allocated_bytes, __ATOMIC_RELAXED),
+            (long long)__atomic_load_n(&s->live_bytes, __ATOMIC_RELAXED),
+            (long long)__atomic_load_n(&s->peak_bytes, __ATOMIC_RELAXED),
+            (unsigned long long)__atomic_load_n(&s->retains, __ATOMIC_RELAXED),
+            (unsigned long long)__atomic_load_n(&s->releases, __ATOMIC_RELAXED),
+            s->file, (unsigned)s->line);
+    }
+
+    if (out != stderr)
+        fclose(out);
+    free(order);
+}
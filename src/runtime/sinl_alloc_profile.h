@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * Allocation profiling for programs compiled with `--alloc-profile`.
+ *
+ * The compiler emits a site for each `dynamic` allocation in the program, holding the file and line it was made on, and
+ * the reference counting functions in `sinl_refcount.h` record each allocation, retain, release, and free against the
+ * site of the resource. For each site, the profile gives the number of allocations and bytes allocated, the bytes still
+ * live and the most that were ever live at once, and the number of reference count updates.
+ *
+ * The report is written to the file named by the `SINL_ALLOC_REPORT` environment variable (`sinl_alloc_profile.txt`
+ * by default, or standard error if it is `-`) when the program exits. If the program doesn't handle SIGUSR1 itself,
+ * sending it SIGUSR1 also writes the report, at the next managed allocation; writing it from the signal handler
+ * wouldn't be safe.
+ *
+ * The counts are updated atomically, so this may be used in programs with any number of threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sinl_alloc_site
+{
+    const char *file;
+    uint32_t line;
+    uint32_t id;                // numbers the sites in the order they first allocated, starting at 1
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t retains;
+    uint64_t releases;
+    int64_t live_bytes;
+    int64_t peak_bytes;
+    struct sinl_alloc_site *next;
+};
+
+/**
+ * Initializes a site for an allocation made at `file`:`line`.
+ */
+#define SINL_ALLOC_SITE(file, line) { (file), (line), 0, 0, 0, 0, 0, 0, 0, NULL }
+
+void sinl_alloc_profile_allocated(struct sinl_alloc_site *site, size_t size);
+void sinl_alloc_profile_freed(struct sinl_alloc_site *site, size_t size);
+
+static inline void sinl_alloc_profile_retained(struct sinl_alloc_site *site)
+{
+    if (site != NULL)
+        __atomic_add_fetch(&site->retains, 1, __ATOMIC_RELAXED);
+}
+
+static inline void sinl_alloc_profile_released(struct sinl_alloc_site *site)
+{
+    if (site != NULL)
+        __atomic_add_fetch(&site->releases, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Writes the report for the allocations made so far, overwriting any written before.
+ */
+void sinl_alloc_profile_write(void);
+
+#ifdef __cplusplus
+}
+#endif
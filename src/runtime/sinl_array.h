@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * Access to SIN arrays from generated code.
+ *
+ * An array is its 32-bit length followed by its elements. Reading the elements through the same pointer as the length
+ * means every store to an element might change the length, as far as the C compiler knows, so loops over arrays written
+ * that way must reload the length on each iteration and can't be vectorized.
+ *
+ * For loops that the optimizer has found to be element-wise, the code generator instead hoists a `restrict` pointer to
+ * each array's elements out of the loop, and runs the loop in blocks of SINL_ARRAY_VECTOR_BLOCK iterations so that
+ * the C compiler knows the trip count of the inner loop. Any remaining iterations run one at a time afterwards.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sinl_common.h"
+#include "sinl_error.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SINL_ARRAY_LENGTH_SIZE 4
+
+/**
+ * The alignment of the first element of every array.
+ *
+ * By default, arrays are packed, and their elements immediately follow the length. When arrays are aligned for SIMD access,
+ * the code generator defines this as 16, 32, or 64 before including this header; the elements then begin at the first
+ * address with that alignment at least SINL_ARRAY_LENGTH_SIZE bytes past the length, and the header reserves enough
+ * room for the padding. Automatic and static arrays are declared with SINL_ARRAY_STORAGE, which is itself aligned, so
+ * their padding is always the whole header and their width is rounded up to the alignment. Dynamic arrays only have the
+ * alignment of the allocator, so arrays behind pointers are accessed with sinl_array_data() and sinl_array_length(),
+ * which find where the elements begin at runtime.
+ *
+ * The length is at the head of the array in either layout, so bounds checks are the same in both.
+ * The alignment must be the same in every translation unit in the program.
+ */
+#ifndef SINL_ARRAY_ALIGNMENT
+#define SINL_ARRAY_ALIGNMENT 4
+#endif
+
+#if SINL_ARRAY_ALIGNMENT > SINL_ARRAY_LENGTH_SIZE
+#define SINL_ARRAY_HEADER_SIZE SINL_ARRAY_ALIGNMENT
+#else
+#define SINL_ARRAY_HEADER_SIZE SINL_ARRAY_LENGTH_SIZE
+#endif
+
+#if defined(__GNUC__) && SINL_ARRAY_ALIGNMENT > SINL_ARRAY_LENGTH_SIZE
+#define SINL_ARRAY_ALIGNED __attribute__((aligned(SINL_ARRAY_ALIGNMENT)))
+#else
+#define SINL_ARRAY_ALIGNED
+#endif
+
+/**
+ * The storage of an array of `N` elements of type `T`: its length, followed by its elements.
+ *
+ * The code generator defines a type with this for every element type and length it declares arrays of. Leaving `N`
+ * empty gives the type of arrays of any length, such as dynamic arrays and arrays behind pointers.
+ */
+#if SINL_ARRAY_ALIGNMENT > SINL_ARRAY_LENGTH_SIZE
+#define SINL_ARRAY_STORAGE(T, N) struct { uint32_t len; T data[N] SINL_ARRAY_ALIGNED; }
+#elif defined(__GNUC__)
+#define SINL_ARRAY_STORAGE(T, N) struct __attribute__((packed)) { uint32_t len; T data[N]; }
+#else
+#define SINL_ARRAY_STORAGE(T, N) struct { uint32_t len; T data[N]; }
+#endif
+
+/**
+ * The number of iterations in each block of an element-wise loop; enough to fill the widest vector registers.
+ */
+#define SINL_ARRAY_VECTOR_BLOCK 16
+
+/**
+ * Tells the C compiler that the iterations of the next loop don't depend on each other.
+ */
+#if defined(__clang__)
+#define SINL_ARRAY_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define SINL_ARRAY_IVDEP _Pragma("GCC ivdep")
+#else
+#define SINL_ARRAY_IVDEP
+#endif
+
+/**
+ * Gets the address of the first element of an array.
+ */
+static inline void *sinl_array_data(const void *array)
+{
+    const uintptr_t address = (uintptr_t)array + SINL_ARRAY_LENGTH_SIZE;
+#if SINL_ARRAY_ALIGNMENT > SINL_ARRAY_LENGTH_SIZE
+    return (void *)((address + SINL_ARRAY_ALIGNMENT - 1) & ~(uintptr_t)(SINL_ARRAY_ALIGNMENT - 1));
+#else
+    return (void *)address;
+#endif
+}
+
+#if defined(__GNUC__)
+#define SINL_ARRAY_DATA(array, T) ((T *)__builtin_assume_aligned(sinl_array_data(array), SINL_ARRAY_ALIGNMENT))
+#else
+#define SINL_ARRAY_DATA(array, T) ((T *)sinl_array_data(array))
+#endif
+
+static inline uint32_t sinl_array_length(const void *array)
+{
+    uint32_t length;
+    memcpy(&length, array, sizeof length);
+    return length;
+}
+
+static inline void sinl_array_set_length(void *array, uint32_t length)
+{
+    memcpy(array, &length, sizeof length);
+}
+
+/**
+ * Copies the elements of `src` into `dest`, as many as fit; any elements of `dest` beyond the length of `src` are left
+ * as they were. The arrays may be the same array.
+ */
+static inline void sinl_array_copy(void *dest, const void *src, size_t element_size)
+{
+    const uint32_t dest_length = sinl_array_length(dest);
+    const uint32_t src_length = sinl_array_length(src);
+    const uint32_t length = dest_length < src_length ? dest_length : src_length;
+    memmove(sinl_array_data(dest), sinl_array_data(src), (size_t)length * element_size);
+}
+
+/**
+ * Checks that `index` is within the bounds of `array` before it is accessed, returning it so the check may be made
+ * inside the access.
+ */
+static inline int64_t sinl_array_check(const void *array, int64_t index, const struct sinl_error_site *site)
+{
+    const uint32_t length = sinl_array_length(array);
+    if (SINL_UNLIKELY((uint64_t)index >= length))
+        sinl_fail_bounds(site, index, length);
+
+    return index;
+}
+
+/**
+ * Gets the number of whole blocks an element-wise loop runs, stepping `index` by one until it reaches `trip`.
+ */
+static inline int64_t sinl_array_blocks(int64_t index, int64_t trip)
+{
+    return index < trip ? (trip - index) / SINL_ARRAY_VECTOR_BLOCK : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
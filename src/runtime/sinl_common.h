@@ -0,0 +1,43 @@
+#pragma once
+
+/**
+ * Definitions shared by the runtime's sources and headers.
+ */
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SINL_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+#define SINL_THREAD_LOCAL __declspec(thread)
+#else
+#define SINL_THREAD_LOCAL __thread
+#endif
+
+/**
+ * Tell the C compiler which way a branch usually goes, and which functions run often or rarely, so that it can lay out
+ * the common paths together. Failed checks and exhausted memory are always unlikely; functions are marked from a profile.
+ * The runtime's own slow paths are kept out of line, so that the fast paths they branch from needn't save registers.
+ */
+#if defined(__GNUC__)
+#define SINL_LIKELY(x) __builtin_expect(!!(x), 1)
+#define SINL_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#define SINL_HOT __attribute__((hot))
+#define SINL_COLD __attribute__((cold))
+#define SINL_NORETURN __attribute__((noreturn))
+#define SINL_NOINLINE __attribute__((noinline))
+#else
+#define SINL_LIKELY(x) (x)
+#define SINL_UNLIKELY(x) (x)
+#define SINL_HOT
+#define SINL_COLD
+#define SINL_NORETURN
+#define SINL_NOINLINE
+#endif
+
+/**
+ * Aligns data to `n` bytes; used for members of structs whose layout the compiler has padded for alignment.
+ */
+#if defined(__GNUC__)
+#define SINL_ALIGNED(n) __attribute__((aligned(n)))
+#else
+#define SINL_ALIGNED(n)
+#endif
@@ -0,0 +1,142 @@
+#include "sinl_counters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Every site that has counted, most recent first.
+ */
+static struct sinl_counter_site *sites;
+static size_t site_count;
+static char sites_lock;
+
+void sinl_counter_register(struct sinl_counter_site *site)
+{
+    while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE))
+        ;
+
+    if (!site->registered)
+    {
+        if (site_count++ == 0)
+            atexit(sinl_counter_write);
+
+        site->next = sites;
+        sites = site;
+        __atomic_store_n(&site->registered, 1, __ATOMIC_RELEASE);
+    }
+
+    __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * The counts for one line, from all of its sites.
+ */
+struct line_counts
+{
+    const char *file;
+    uint32_t line;
+    uint64_t counts[SINL_COUNTER_KINDS];
+    uint64_t total;
+};
+
+/**
+ * Orders sites by their location.
+ */
+static int compare_location(const void *left, const void *right)
+{
+    const struct sinl_counter_site *l = *(struct sinl_counter_site *const *)left;
+    const struct sinl_counter_site *r = *(struct sinl_counter_site *const *)right;
+    const int file = strcmp(l->file, r->file);
+    if (file != 0)
+        return file;
+
+    return l->line < r->line ? -1 : l->line > r->line ? 1 : 0;
+}
+
+/**
+ * Orders lines by the operations counted on them, most first.
+ */
+static int compare_total(const void *left, const void *right)
+{
+    const uint64_t l = ((const struct line_counts *)left)->total;
+    const uint64_t r = ((const struct line_counts *)right)->total;
+    return l < r ? 1 : l > r ? -1 : 0;
+}
+
+void sinl_counter_write(void)
+{
+    while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE))
+        ;
+    const size_t count = site_count;
+    struct sinl_counter_site *first = sites;
+    __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+
+    struct sinl_counter_site **order = malloc((count + 1) * sizeof *order);
+    struct line_counts *lines = calloc(count + 1, sizeof *lines);
+    if (order == NULL || lines == NULL)
+    {
+        fputs("sinl_counters: out of memory\n", stderr);
+        free(order);
+        free(lines);
+        return;
+    }
+
+    size_t n = 0;
+    for (struct sinl_counter_site *s = first; s != NULL && n < count; s = s->next)
+        order[n++] = s;
+    qsort(order, n, sizeof *order, compare_location);
+
+    // several sites may share a line, such as two accesses to arrays in one expression
+    size_t line_count = 0;
+    uint64_t totals[SINL_COUNTER_KINDS] = { 0 };
+    for (size_t i = 0; i < n; i++)
+    {
+        const struct sinl_counter_site *s = order[i];
+        if (line_count == 0 || compare_location(&order[i - 1], &order[i]) != 0)
+        {
+            lines[line_count].file = s->file;
+            lines[line_count].line = s->line;
+            line_count++;
+        }
+
+        const uint64_t c = __atomic_load_n(&s->count, __ATOMIC_RELAXED);
+        if (s->kind < SINL_COUNTER_KINDS)
+        {
+            lines[line_count - 1].counts[s->kind] += c;
+            totals[s->kind] += c;
+        }
+        lines[line_count - 1].total += c;
+    }
+    qsort(lines, line_count, sizeof *lines, compare_total);
+
+    const char *filename = getenv("SINL_COUNTERS");
+    if (filename == NULL || filename[0] == '\0')
+        filename = "sinl_counters.txt";
+
+    FILE *out = strcmp(filename, "-") == 0 ? stderr : fopen(filename, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "sinl_counters: could not open '%s'\n", filename);
+    }
+    else
+    {
+        fprintf(out, "Runtime costs: %llu bounds checks, %llu retains, %llu releases\n\n",
+            (unsigned long long)totals[SINL_COUNT_BOUNDS_CHECK], (unsigned long long)totals[SINL_COUNT_RETAIN],
+            (unsigned long long)totals[SINL_COUNT_RELEASE]);
+        fprintf(out, "%16s %16s %16s  %s\n", "bounds checks", "retains", "releases", "location");
+        for (size_t i = 0; i < line_count; i++)
+        {
+            const struct line_counts *l = &lines[i];
+            fprintf(out, "%16llu %16llu %16llu  %s:%u\n",
+                (unsigned long long)l->counts[SINL_COUNT_BOUNDS_CHECK], (unsigned long long)l->counts[SINL_COUNT_RETAIN],
+                (unsigned long long)l->counts[SINL_COUNT_RELEASE], l->file, (unsigned)l->line);
+        }
+
+        if (out != stderr)
+            fclose(out);
+    }
+
+    free(order);
+    free(lines);
+}
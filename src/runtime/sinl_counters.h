@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * Counters for the runtime costs of programs compiled with `--count-costs`.
+ *
+ * The compiler emits a site for each runtime bounds check and reference count update in the program, holding the
+ * line of the SIN source it came from, and counts every time it is executed. When the program exits, the counts are
+ * totalled by line and written to the file named by the `SINL_COUNTERS` environment variable (`sinl_counters.txt` by
+ * default, or standard error if it is `-`), with the busiest lines first.
+ *
+ * Checks and updates the optimizer removes have no site, so comparing the counts of a program compiled at different
+ * optimization levels shows how many its passes removed at runtime, and not only how many they removed from the source.
+ *
+ * The counts are updated atomically, so this may be used in programs with any number of threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum sinl_counter_kind
+{
+    SINL_COUNT_BOUNDS_CHECK,
+    SINL_COUNT_RETAIN,
+    SINL_COUNT_RELEASE,
+    SINL_COUNTER_KINDS
+};
+
+struct sinl_counter_site
+{
+    const char *file;
+    uint32_t line;
+    uint32_t kind;
+    uint64_t count;
+    uint32_t registered;
+    struct sinl_counter_site *next;
+};
+
+/**
+ * Initializes a site counting operations of the given kind at `file`:`line`.
+ */
+#define SINL_COUNTER_SITE(file, line, kind) { (file), (line), (kind), 0, 0, NULL }
+
+void sinl_counter_register(struct sinl_counter_site *site);
+
+/**
+ * Counts `n` operations at a site.
+ */
+static inline void sinl_counter_add(struct sinl_counter_site *site, uint64_t n)
+{
+    if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE))
+        sinl_counter_register(site);
+
+    __atomic_add_fetch(&site->count, n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Writes the counts so far, overwriting any written before.
+ */
+void sinl_counter_write(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+#include "sinl_error.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void sinl_fail_bounds(const struct sinl_error_site *site, int64_t index, uint32_t length)
+{
+    fprintf(stderr, "%s:%u: index %lld is out of bounds for an array of length %u\n",
+        site->file, (unsigned)site->line, (long long)index, (unsigned)length);
+    exit(EXIT_FAILURE);
+}
+
+void sinl_fail_null(const struct sinl_error_site *site)
+{
+    fprintf(stderr, "%s:%u: null pointer dereferenced\n", site->file, (unsigned)site->line);
+    exit(EXIT_FAILURE);
+}
+
+void sinl_fail_alloc(const struct sinl_error_site *site, size_t size)
+{
+    fprintf(stderr, "%s:%u: could not allocate %zu bytes\n", site->file, (unsigned)site->line, size);
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * The SRE's error routines, which report a failed runtime check and stop the program.
+ *
+ * Each kind of error has a single routine, shared by every check of that kind in the program, and the routines are
+ * cold and never return. A check is then only a compare and a branch to an out-of-line call, so the C compiler keeps
+ * the failure handling out of the code around it and lays the common path out straight. gcc does the same for failure
+ * handling written inline, as long as it ends in `exit`, so this saves code rather than time; see
+ * `samples/benchmarks/cold_paths.c`. Each check passes a static
+ * site, holding the SIN file and line it is on, so that only one address is loaded even on the failure path.
+ *
+ * In uSIN, where no runtime library is linked, the code generator defines SINL_ERROR_TRAP before including this
+ * header, and errors stop the program with a trap instead of a message.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sinl_common.h"
+
+#if defined(SINL_ERROR_TRAP) && !defined(__GNUC__)
+#include <stdlib.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sinl_error_site
+{
+    const char *file;
+    uint32_t line;
+};
+
+#define SINL_ERROR_SITE(file, line) { (file), (line) }
+
+#ifdef SINL_ERROR_TRAP
+static inline SINL_COLD SINL_NORETURN void sinl_error_trap(void)
+{
+#if defined(__GNUC__)
+    __builtin_trap();
+#else
+    abort();
+#endif
+}
+
+static inline SINL_COLD SINL_NORETURN void sinl_fail_bounds(const struct sinl_error_site *site, int64_t index, uint32_t length)
+{
+    (void)site, (void)index, (void)length;
+    sinl_error_trap();
+}
+
+static inline SINL_COLD SINL_NORETURN void sinl_fail_null(const struct sinl_error_site *site)
+{
+    (void)site;
+    sinl_error_trap();
+}
+
+static inline SINL_COLD SINL_NORETURN void sinl_fail_alloc(const struct sinl_error_site *site, size_t size)
+{
+    (void)site, (void)size;
+    sinl_error_trap();
+}
+#else
+/**
+ * An index was outside the bounds of an array of the given length.
+ */
+SINL_COLD SINL_NORETURN void sinl_fail_bounds(const struct sinl_error_site *site, int64_t index, uint32_t length);
+/**
+ * A null pointer was dereferenced.
+ */
+SINL_COLD SINL_NORETURN void sinl_fail_null(const struct sinl_error_site *site);
+/**
+ * Dynamic memory of the given size could not be obtained.
+ */
+SINL_COLD SINL_NORETURN void sinl_fail_alloc(const struct sinl_error_site *site, size_t size);
+#endif
+
+static inline const void *sinl_check_null(const void *pointer, const struct sinl_error_site *site)
+{
+    if (SINL_UNLIKELY(pointer == NULL))
+        sinl_fail_null(site);
+
+    return pointer;
+}
+
+/**
+ * Checks that an allocation of `size` bytes succeeded, returning the memory.
+ */
+static inline void *sinl_check_alloc(void *memory, size_t size, const struct sinl_error_site *site)
+{
+    if (SINL_UNLIKELY(memory == NULL))
+        sinl_fail_alloc(site, size);
+
+    return memory;
+}
+
+#ifdef __cplusplus
+}
+#endif
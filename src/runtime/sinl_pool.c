@@ -0,0 +1,293 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "sinl_pool.h"
+#include "sinl_common.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+/**
+ * The size classes are powers of two from 8 to SINL_POOL_MAX_SIZE bytes.
+ */
+#define MIN_CLASS_SHIFT 3
+#define NUM_CLASSES 6
+
+/**
+ * A released block, threaded through the first word of its own storage.
+ */
+struct free_block
+{
+    struct free_block *next;
+};
+
+/**
+ * A thread's state for one size class.
+ *
+ * Released blocks are reused first; otherwise, blocks are taken from the shared list, and then carved from the current
+ * slab until it runs out.
+ */
+struct size_class
+{
+    struct free_block *free_list;
+    struct free_block *last;    // the end of the free list, so that it can be passed on whole
+    size_t free_count;
+    char *next;
+    char *end;
+};
+
+/**
+ * A list of released blocks passed on by a thread.
+ */
+struct chain
+{
+    struct free_block *first;
+    struct free_block *last;
+    size_t count;
+};
+
+/**
+ * The most chains a shared list holds apart; beyond this, chains are joined to the last one.
+ */
+#define MAX_CHAINS 64
+
+/**
+ * The blocks of one size class that threads have passed on, either because they released more than they keep or
+ * because they exited, for any thread to reuse. Chains are passed on and taken whole, so neither walks the blocks.
+ */
+struct shared_class
+{
+    struct chain chains[MAX_CHAINS];
+    size_t chain_count;
+    char lock;
+};
+
+static SINL_THREAD_LOCAL struct size_class classes[NUM_CLASSES];
+static SINL_THREAD_LOCAL int watching_exit;
+static struct shared_class shared[NUM_CLASSES];
+
+/**
+ * Holds each thread's size classes, so that they are passed on when the thread exits.
+ */
+static pthread_key_t exit_key;
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+static int exit_key_created;
+
+static size_t class_index(size_t size)
+{
+    size_t index = 0;
+    size_t width = (size_t)1 << MIN_CLASS_SHIFT;
+    while (width < size)
+    {
+        width <<= 1;
+        index++;
+    }
+
+    return index;
+}
+
+static size_t class_width(size_t index)
+{
+    return (size_t)1 << (index + MIN_CLASS_SHIFT);
+}
+
+static void lock(struct shared_class *c)
+{
+    while (__atomic_test_and_set(&c->lock, __ATOMIC_ACQUIRE))
+        ;
+}
+
+static void unlock(struct shared_class *c)
+{
+    __atomic_clear(&c->lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * Passes a thread's released blocks of one size class on to the shared list, leaving the thread's own list empty.
+ */
+static SINL_COLD void share(size_t index, struct size_class *c)
+{
+    struct shared_class *to = &shared[index];
+    lock(to);
+    if (to->chain_count < MAX_CHAINS)
+    {
+        struct chain *added = &to->chains[to->chain_count++];
+        added->first = c->free_list;
+        added->last = c->last;
+        added->count = c->free_count;
+    }
+    else
+    {
+        struct chain *joined = &to->chains[MAX_CHAINS - 1];
+        joined->last->next = c->free_list;
+        joined->last = c->last;
+        joined->count += c->free_count;
+    }
+    unlock(to);
+
+    c->free_list = c->last = NULL;
+    c->free_count = 0;
+}
+
+/**
+ * Moves a chain from the shared list of a size class to the thread's own, which must be empty.
+ */
+static void take_shared(size_t index, struct size_class *c)
+{
+    struct shared_class *from = &shared[index];
+    if (__atomic_load_n(&from->chain_count, __ATOMIC_RELAXED) == 0)
+        return;
+
+    lock(from);
+    if (from->chain_count > 0)
+    {
+        const struct chain *taken = &from->chains[--from->chain_count];
+        c->free_list = taken->first;
+        c->last = taken->last;
+        c->free_count = taken->count;
+    }
+    unlock(from);
+}
+
+/**
+ * Passes on everything a thread holds when it exits: its released blocks, and what is left of its slabs.
+ */
+static void thread_exited(void *state)
+{
+    struct size_class *thread_classes = state;
+    for (size_t index = 0; index < NUM_CLASSES; index++)
+    {
+        struct size_class *c = &thread_classes[index];
+        const size_t width = class_width(index);
+        while (c->next != NULL && (size_t)(c->end - c->next) >= width)
+        {
+            struct free_block *carved = (struct free_block *)c->next;
+            carved->next = c->free_list;
+            if (c->free_list == NULL)
+                c->last = carved;
+            c->free_list = carved;
+            c->free_count++;
+            c->next += width;
+        }
+
+        if (c->free_list != NULL)
+            share(index, c);
+        c->next = c->end = NULL;
+    }
+
+    // the runtime's other exit handlers may still release blocks on this thread, which are then passed on in turn
+    watching_exit = 0;
+}
+
+static void create_exit_key(void)
+{
+    exit_key_created = pthread_key_create(&exit_key, thread_exited) == 0;
+}
+
+/**
+ * Arranges for the calling thread's blocks to be passed on when it exits; if it is already exiting, they are passed on
+ * once the handlers that are running have finished.
+ */
+static SINL_COLD void watch_exit(void)
+{
+    watching_exit = 1;
+    pthread_once(&exit_key_once, create_exit_key);
+    if (exit_key_created)
+        pthread_setspecific(exit_key, classes);
+}
+
+/**
+ * Allocates a block once the thread's own free list is empty: from the shared list if it can, or else from a slab.
+ */
+static SINL_NOINLINE void *alloc_slowly(size_t index)
+{
+    struct size_class *c = &classes[index];
+    take_shared(index, c);
+
+    struct free_block *block = c->free_list;
+    if (block)
+    {
+        c->free_list = block->next;
+        c->free_count--;
+        return block;
+    }
+
+    const size_t width = class_width(index);
+    if (c->next == NULL || (size_t)(c->end - c->next) < width)
+    {
+        /*
+         * Slabs are never returned to the system, as their blocks may have been handed to other threads' free lists.
+         * Whatever is left of the old slab is abandoned, but that is always less than one block.
+         */
+        char *slab = malloc(SINL_POOL_SLAB_SIZE);
+        if (slab == NULL)
+            return NULL;
+
+        if (!watching_exit)
+            watch_exit();
+
+        c->next = slab;
+        c->end = slab + SINL_POOL_SLAB_SIZE;
+    }
+
+    void *carved = c->next;
+    c->next += width;
+    return carved;
+}
+
+/**
+ * Finishes releasing a block when the thread isn't yet watching for its exit, or is keeping too many blocks.
+ */
+static SINL_COLD SINL_NOINLINE void pass_on(size_t index)
+{
+    if (!watching_exit)
+        watch_exit();
+
+    // a thread that releases what others allocated passes it on, rather than keep it from them
+    struct size_class *c = &classes[index];
+    if (c->free_count > SINL_POOL_CACHE_LIMIT)
+        share(index, c);
+}
+
+void *sinl_pool_alloc(size_t size)
+{
+    if (size > SINL_POOL_MAX_SIZE)
+        return malloc(size);
+
+    const size_t index = class_index(size);
+    struct size_class *c = &classes[index];
+    struct free_block *block = c->free_list;
+    if (SINL_UNLIKELY(block == NULL))
+        return alloc_slowly(index);
+
+    c->free_list = block->next;
+    c->free_count--;
+    return block;
+}
+
+void sinl_pool_free(void *block, size_t size)
+{
+    if (block == NULL)
+        return;
+
+    if (size > SINL_POOL_MAX_SIZE)
+    {
+        free(block);
+        return;
+    }
+
+    const size_t index = class_index(size);
+    struct size_class *c = &classes[index];
+    struct free_block *released = block;
+    released->next = c->free_list;
+    if (released->next == NULL)
+        c->last = released;
+    c->free_list = released;
+    if (SINL_UNLIKELY(++c->free_count > SINL_POOL_CACHE_LIMIT || !watching_exit))
+        pass_on(index);
+}
+
+void sinl_pool_release(void *const *blocks, const size_t *sizes, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_pool_free(blocks[i], sizes[i]);
+}
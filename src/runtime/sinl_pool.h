@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * The pooled allocator used by generated code for dynamic data.
+ *
+ * Small allocations are served from size-class slabs with a free list per thread, so allocating and releasing
+ * many small objects of the same size never touches malloc() once a slab has been obtained.
+ * Larger allocations fall through to malloc() and free().
+ *
+ * A thread keeps at most SINL_POOL_CACHE_LIMIT released blocks of each size. Beyond that, it passes them on to a list
+ * shared by every thread, which a thread whose own list is empty takes from before it carves a new slab. When a thread
+ * exits, its released blocks and the rest of its slabs go to the shared lists too. So memory released by a thread
+ * other than the one that allocated it is reused, rather than piling up, or being lost, on the releasing thread.
+ *
+ * The caller passes the size of a block when releasing it; the compiler always knows the width of the data it releases.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The largest allocation served by the pool; anything larger comes from malloc().
+ */
+#define SINL_POOL_MAX_SIZE 256
+
+/**
+ * The size of each slab obtained from malloc().
+ */
+#define SINL_POOL_SLAB_SIZE (64 * 1024)
+
+/**
+ * The most released blocks of each size a thread keeps for itself.
+ */
+#define SINL_POOL_CACHE_LIMIT 1024
+
+/**
+ * Allocates `size` bytes, aligned suitably for any type of that size.
+ *
+ * Returns NULL if the memory could not be obtained.
+ */
+void *sinl_pool_alloc(size_t size);
+
+/**
+ * Releases a block obtained from `sinl_pool_alloc`; `size` must be the size it was allocated with.
+ *
+ * Blocks may be released by any thread; they go to the releasing thread's free list, and on to a shared list if that
+ * is full.
+ */
+void sinl_pool_free(void *block, size_t size);
+
+/**
+ * Releases `count` blocks at once, such as all of the dynamic data in a scope that is being exited.
+ *
+ * NULL entries are skipped.
+ */
+void sinl_pool_release(void *const *blocks, const size_t *sizes, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
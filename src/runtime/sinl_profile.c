@@ -0,0 +1,426 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "sinl_profile.h"
+#include "sinl_common.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+#define TIME_UNIT "cycles"
+
+static uint64_t now(void)
+{
+    return __rdtsc();
+}
+#else
+#define TIME_UNIT "ns"
+
+static uint64_t now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+/**
+ * A call that hasn't returned yet.
+ */
+struct frame
+{
+    uint32_t site;
+    uint32_t edge;          // the edge from its caller, which its return adds to
+    uint64_t start;
+    uint64_t children;      // the time spent in the functions it has called so far
+    uint32_t callee;        // the site it called last, and the edge to it, so calls in a loop needn't be looked up
+    uint32_t callee_edge;
+};
+
+/**
+ * The totals for one function.
+ */
+struct counts
+{
+    uint64_t calls;
+    uint64_t self;      // time spent in the function itself, not including the functions it called
+    uint64_t total;     // time spent in the function and everything it called
+    uint32_t active;    // calls that haven't returned; only the outermost of recursive calls adds to the total
+};
+
+/**
+ * The totals for calls from one function to another; a caller of 0 is the start of a thread.
+ */
+struct edge
+{
+    uint32_t caller;
+    uint32_t callee;
+    uint64_t calls;
+    uint64_t total;
+};
+
+/**
+ * What a thread has recorded. These are never freed, so that threads that have finished are still in the profile.
+ */
+struct thread_profile
+{
+    struct frame *frames;
+    size_t depth;
+    size_t frame_capacity;
+
+    struct counts *counts;      // indexed by site id
+    size_t count_capacity;
+
+    struct edge *edges;         // in the order they were first called, so that frames may refer to them by index
+    size_t edge_count;
+    size_t edge_capacity;
+    uint32_t *edge_index;       // an open-addressed table of indices into `edges` plus one; the capacity is a power of two
+    size_t index_capacity;
+
+    struct thread_profile *next;
+};
+
+static SINL_THREAD_LOCAL struct thread_profile *current_thread;
+static struct thread_profile *threads;
+
+/**
+ * The sites called so far, indexed by id - 1. Only updated with the lock held.
+ */
+static struct sinl_profile_site **sites;
+static uint32_t site_count;
+static size_t site_capacity;
+static char sites_lock;
+
+static void lock_sites(void)
+{
+    while (__atomic_test_and_set(&sites_lock, __ATOMIC_ACQUIRE))
+        ;
+}
+
+static void unlock_sites(void)
+{
+    __atomic_clear(&sites_lock, __ATOMIC_RELEASE);
+}
+
+/**
+ * Grows an array to hold at least `needed` elements, zeroing the new ones. Profiling can't continue without the
+ * memory, so the program is stopped if it can't be had.
+ */
+static void *grow(void *array, size_t *capacity, size_t element_size, size_t needed)
+{
+    size_t new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+
+    char *grown = realloc(array, new_capacity * element_size);
+    if (grown == NULL)
+    {
+        fputs("sinl_profile: out of memory\n", stderr);
+        abort();
+    }
+
+    memset(grown + *capacity * element_size, 0, (new_capacity - *capacity) * element_size);
+    *capacity = new_capacity;
+    return grown;
+}
+
+static uint32_t register_site(struct sinl_profile_site *site)
+{
+    lock_sites();
+    if (site->id == 0)
+    {
+        if (site_count == site_capacity)
+            sites = grow(sites, &site_capacity, sizeof *sites, site_count + 1);
+
+        sites[site_count++] = site;
+        if (site_count == 1)
+            atexit(sinl_profile_write);
+
+        __atomic_store_n(&site->id, site_count, __ATOMIC_RELEASE);
+    }
+    unlock_sites();
+
+    return site->id;
+}
+
+static struct thread_profile *get_thread(void)
+{
+    struct thread_profile *t = current_thread;
+    if (t == NULL)
+    {
+        t = calloc(1, sizeof *t);
+        if (t == NULL)
+        {
+            fputs("sinl_profile: out of memory\n", stderr);
+            abort();
+        }
+
+        t->next = __atomic_load_n(&threads, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&threads, &t->next, t, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+
+        current_thread = t;
+    }
+
+    return t;
+}
+
+static uint32_t *find_slot(const struct thread_profile *t, uint32_t caller, uint32_t callee)
+{
+    size_t i = ((size_t)caller * 0x9E3779B1u ^ callee) & (t->index_capacity - 1);
+    while (t->edge_index[i] != 0)
+    {
+        const struct edge *e = &t->edges[t->edge_index[i] - 1];
+        if (e->caller == caller && e->callee == callee)
+            break;
+
+        i = (i + 1) & (t->index_capacity - 1);
+    }
+
+    return &t->edge_index[i];
+}
+
+/**
+ * Gets the index of the edge from `caller` to `callee`, adding it if it hasn't been seen.
+ */
+static uint32_t find_edge(struct thread_profile *t, uint32_t caller, uint32_t callee)
+{
+    if ((t->edge_count + 1) * 2 > t->index_capacity)
+    {
+        // rebuild the index at twice the size; the edges themselves don't move
+        const size_t old_capacity = t->index_capacity;
+        free(t->edge_index);
+        t->edge_index = NULL;
+        t->index_capacity = 0;
+        t->edge_index = grow(NULL, &t->index_capacity, sizeof *t->edge_index, old_capacity ? old_capacity * 2 : 64);
+        for (size_t i = 0; i < t->edge_count; i++)
+            *find_slot(t, t->edges[i].caller, t->edges[i].callee) = (uint32_t)i + 1;
+    }
+
+    uint32_t *slot = find_slot(t, caller, callee);
+    if (*slot == 0)
+    {
+        if (t->edge_count == t->edge_capacity)
+            t->edges = grow(t->edges, &t->edge_capacity, sizeof *t->edges, t->edge_count + 1);
+
+        struct edge *e = &t->edges[t->edge_count++];
+        e->caller = caller;
+        e->callee = callee;
+        *slot = (uint32_t)t->edge_count;
+    }
+
+    return *slot - 1;
+}
+
+void sinl_profile_enter(struct sinl_profile_site *site)
+{
+    uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+    if (id == 0)
+        id = register_site(site);
+
+    struct thread_profile *t = get_thread();
+    if (t->depth == t->frame_capacity)
+        t->frames = grow(t->frames, &t->frame_capacity, sizeof *t->frames, t->depth + 1);
+    if (id >= t->count_capacity)
+        t->counts = grow(t->counts, &t->count_capacity, sizeof *t->counts, (size_t)id + 1);
+
+    t->counts[id].calls++;
+    t->counts[id].active++;
+
+    // the edge is found here, so that the return only has to add to it
+    uint32_t edge;
+    if (t->depth == 0)
+    {
+        edge = find_edge(t, 0, id);
+    }
+    else
+    {
+        struct frame *parent = &t->frames[t->depth - 1];
+        if (parent->callee != id)
+        {
+            parent->callee = id;
+            parent->callee_edge = find_edge(t, parent->site, id);
+        }
+        edge = parent->callee_edge;
+    }
+
+    struct frame *f = &t->frames[t->depth++];
+    f->site = id;
+    f->edge = edge;
+    f->children = 0;
+    f->callee = 0;
+
+    // the timestamp is taken last, so that the bookkeeping isn't charged to the function
+    f->start = now();
+}
+
+void sinl_profile_exit(void)
+{
+    const uint64_t end = now();
+
+    struct thread_profile *t = current_thread;
+    if (t == NULL || t->depth == 0)
+        return;
+
+    const struct frame *f = &t->frames[--t->depth];
+    const uint64_t elapsed = end - f->start;
+
+    struct counts *c = &t->counts[f->site];
+    c->self += elapsed > f->children ? elapsed - f->children : 0;
+    if (--c->active == 0)
+        c->total += elapsed;
+
+    struct edge *e = &t->edges[f->edge];
+    e->calls++;
+    e->total += elapsed;
+
+    if (t->depth > 0)
+        t->frames[t->depth - 1].children += elapsed;
+}
+
+/* the report */
+
+static struct counts *merged_counts;
+
+/**
+ * Orders site ids by the time spent in the function itself, most first.
+ */
+static int compare_self(const void *left, const void *right)
+{
+    const uint64_t l = merged_counts[*(const uint32_t *)left].self;
+    const uint64_t r = merged_counts[*(const uint32_t *)right].self;
+    return l < r ? 1 : l > r ? -1 : 0;
+}
+
+/**
+ * Orders site ids by the time spent in the function and its callees, most first.
+ */
+static int compare_total(const void *left, const void *right)
+{
+    const uint64_t l = merged_counts[*(const uint32_t *)left].total;
+    const uint64_t r = merged_counts[*(const uint32_t *)right].total;
+    return l < r ? 1 : l > r ? -1 : 0;
+}
+
+static void print_site(FILE *out, struct sinl_profile_site *const *names, uint32_t id)
+{
+    if (id == 0)
+        fputs("<thread start>", out);
+    else
+        fprintf(out, "%s (%s:%u)", names[id - 1]->name, names[id - 1]->file, (unsigned)names[id - 1]->line);
+}
+
+void sinl_profile_write(void)
+{
+    // threads that are still running may update their counts while they are read; the report is only approximate for them
+    lock_sites();
+    const uint32_t count = site_count;
+    struct sinl_profile_site **names = malloc((count + 1) * sizeof *names);
+    if (names != NULL && count > 0)
+        memcpy(names, sites, count * sizeof *names);
+    unlock_sites();
+
+    struct thread_profile merged = { 0 };
+    merged_counts = calloc((size_t)count + 1, sizeof *merged_counts);
+    uint32_t *order = malloc(((size_t)count + 1) * sizeof *order);
+    if (names == NULL || merged_counts == NULL || order == NULL)
+    {
+        fputs("sinl_profile: out of memory\n", stderr);
+        free(names);
+        free(merged_counts);
+        free(order);
+        return;
+    }
+
+    for (struct thread_profile *t = __atomic_load_n(&threads, __ATOMIC_ACQUIRE); t != NULL; t = t->next)
+    {
+        for (size_t id = 1; id < t->count_capacity && id <= count; id++)
+        {
+            merged_counts[id].calls += t->counts[id].calls;
+            merged_counts[id].self += t->counts[id].self;
+            merged_counts[id].total += t->counts[id].total;
+        }
+        for (size_t i = 0; i < t->edge_count; i++)
+        {
+            const struct edge *e = &t->edges[i];
+            if (e->callee <= count && e->caller <= count)
+            {
+                const uint32_t index = find_edge(&merged, e->caller, e->callee);
+                struct edge *m = &merged.edges[index];
+                m->calls += e->calls;
+                m->total += e->total;
+            }
+        }
+    }
+
+    const char *filename = getenv("SINL_PROFILE");
+    if (filename == NULL || filename[0] == '\0')
+        filename = "sinl_profile.txt";
+
+    FILE *out = strcmp(filename, "-") == 0 ? stderr : fopen(filename, "w");
+    if (out == NULL)
+    {
+        fprintf(stderr, "sinl_profile: could not open '%s'\n", filename);
+    }
+    else
+    {
+        uint64_t all = 0;
+        for (uint32_t id = 1; id <= count; id++)
+        {
+            order[id - 1] = id;
+            all += merged_counts[id].self;
+        }
+
+        fprintf(out, "Flat profile (times in " TIME_UNIT ")\n\n");
+        fprintf(out, "%7s %16s %16s %12s  %s\n", "% self", "self", "total", "calls", "function");
+        qsort(order, count, sizeof *order, compare_self);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const struct counts *c = &merged_counts[order[i]];
+            fprintf(out, "%7.2f %16llu %16llu %12llu  ", all ? 100.0 * (double)c->self / (double)all : 0.0,
+                (unsigned long long)c->self, (unsigned long long)c->total, (unsigned long long)c->calls);
+            print_site(out, names, order[i]);
+            fputc('\n', out);
+        }
+
+        fprintf(out, "\nCall graph (times in " TIME_UNIT ", including callees)\n");
+        qsort(order, count, sizeof *order, compare_total);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const uint32_t id = order[i];
+            fputc('\n', out);
+            print_site(out, names, id);
+            fprintf(out, ": %llu calls, %llu total\n", (unsigned long long)merged_counts[id].calls,
+                (unsigned long long)merged_counts[id].total);
+
+            for (int callers = 1; callers >= 0; callers--)
+            {
+                for (size_t j = 0; j < merged.edge_count; j++)
+                {
+                    const struct edge *e = &merged.edges[j];
+                    if ((callers ? e->callee : e->caller) != id)
+                        continue;
+
+                    fprintf(out, "    %-10s %12llu calls %16llu  ", callers ? "called by" : "calls",
+                        (unsigned long long)e->calls, (unsigned long long)e->total);
+                    print_site(out, names, callers ? e->caller : e->callee);
+                    fputc('\n', out);
+                }
+            }
+        }
+
+        if (out != stderr)
+            fclose(out);
+    }
+
+    free(merged.edges);
+    free(merged.edge_index);
+    free(names);
+    free(merged_counts);
+    free(order);
+    merged_counts = NULL;
+}
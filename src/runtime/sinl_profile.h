@@ -0,0 +1,50 @@
+#pragma once
+
+/**
+ * Function profiling for programs compiled with `--instrument`.
+ *
+ * The compiler emits a site for each SIN function, holding its SIN name and where it was defined, and brackets the
+ * function's body with `sinl_profile_enter` and `sinl_profile_exit`. Each thread counts calls and accumulates
+ * timestamps in a buffer of its own, so recording never takes a lock. When the program exits, the threads' buffers are
+ * merged into a flat profile and a call graph, written to the file named by the `SINL_PROFILE` environment variable
+ * (`sinl_profile.txt` by default, or standard error if it is `-`).
+ *
+ * Times are in cycles from the timestamp counter on x86, and in nanoseconds elsewhere.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A function being profiled. The compiler emits one of these for each function, with a zero id.
+ */
+struct sinl_profile_site
+{
+    const char *name;   // the function's name in the SIN source
+    const char *file;
+    uint32_t line;
+    uint32_t id;        // numbers the sites in the order they were first called, starting at 1
+};
+
+/**
+ * Records a call to the function at `site`; every call must be matched by a call to `sinl_profile_exit` on the same thread.
+ */
+void sinl_profile_enter(struct sinl_profile_site *site);
+
+/**
+ * Records the return from the function most recently entered on the calling thread.
+ */
+void sinl_profile_exit(void);
+
+/**
+ * Writes the profile collected so far. This is done automatically when the program exits, but may also be done at
+ * other times, e.g. periodically in a program that never exits; each call overwrites the file.
+ */
+void sinl_profile_write(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,100 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include "sinl_refcount.h"
+
+#include <pthread.h>
+
+static struct sinl_rc_thread unattached;
+SINL_THREAD_LOCAL struct sinl_rc_thread *sinl_rc_current_thread = &unattached;
+
+/**
+ * Holds each thread's record, so that the record is closed when the thread exits.
+ */
+static pthread_key_t thread_key;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static int thread_key_created;
+static pthread_once_t exit_watch_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Applies the releases left on a thread's list, and closes it so that no more are handed to the thread.
+ */
+static void close_thread(struct sinl_rc_thread *thread)
+{
+    for (;;)
+    {
+        thread->drain(thread);
+
+        struct sinl_rc_deferred *expected = NULL;
+        if (__atomic_compare_exchange_n(&thread->deferred, &expected, SINL_RC_EXITED, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED) ||
+            expected == SINL_RC_EXITED)
+            return;
+    }
+}
+
+static void thread_exited(void *thread)
+{
+    close_thread(thread);
+}
+
+/**
+ * Threads' records are closed when they exit, except for the thread that exits the program, which never does.
+ */
+static void program_exiting(void)
+{
+    if (sinl_rc_current_thread != &unattached)
+        close_thread(sinl_rc_current_thread);
+}
+
+static void create_thread_key(void)
+{
+    thread_key_created = pthread_key_create(&thread_key, thread_exited) == 0;
+}
+
+static void watch_program_exit(void)
+{
+    atexit(program_exiting);
+}
+
+struct sinl_rc_thread *sinl_rc_attach_thread(void (*drain)(struct sinl_rc_thread *thread))
+{
+    pthread_once(&thread_key_once, create_thread_key);
+
+    struct sinl_rc_thread *thread = malloc(sizeof *thread);
+    if (thread == NULL)
+        return NULL;
+
+    thread->deferred = NULL;
+    thread->drain = drain;
+    if (thread_key_created)
+        pthread_setspecific(thread_key, thread);
+
+    sinl_rc_current_thread = thread;
+    return thread;
+}
+
+void sinl_rc_watch_exit(void)
+{
+    /*
+     * This is registered when a release is first deferred, rather than when the first thread is attached, so that it
+     * runs before the allocation profile is written, which registers its own handler when the first resource is tracked.
+     */
+    pthread_once(&exit_watch_once, watch_program_exit);
+}
+
+void sinl_rc_release_batch_nonatomic(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_nonatomic(resources[i]);
+}
+
+void sinl_rc_release_batch_atomic(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_atomic(resources[i]);
+}
+
+void sinl_rc_release_batch_biased(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_biased(resources[i]);
+}
@@ -0,0 +1,424 @@
+#pragma once
+
+/**
+ * Reference counting for resources managed by the MAM.
+ *
+ * Every managed resource is preceded by a header holding its reference count. The compiler selects one of three
+ * counting modes for the whole program, and emits calls to the matching inline functions below:
+ *  - atomic: every count update is an atomic operation, so resources may be shared freely between threads
+ *  - non-atomic: count updates are plain arithmetic; only correct if no resource is ever shared between threads
+ *  - biased: the thread that allocated a resource updates a private count without atomics, while other threads
+ *    update a shared count atomically. When the owner's count reaches zero, it merges the two, and whichever
+ *    thread brings the merged count to zero frees the resource. A reference the owner counted may be released by
+ *    another thread; rather than take the shared count below zero, that thread hands the release to the owner (see
+ *    `struct sinl_rc_thread`).
+ *
+ * The counting mode must be the same in every translation unit in the program.
+ *
+ * When `SINL_ALLOC_PROFILE` is defined, as it is by `--alloc-profile`, the header also records where the resource was
+ * allocated, and every count update is recorded in the allocation profile (see `sinl_alloc_profile.h`). This changes
+ * the layout of the header, so it too must be the same in every translation unit.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+
+#include "sinl_common.h"
+#include "sinl_pool.h"
+
+#ifdef SINL_ALLOC_PROFILE
+#include "sinl_alloc_profile.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sinl_rc_header
+{
+    intptr_t count;     // the count; in biased mode, the count shared by non-owning threads
+    intptr_t biased;    // biased mode only: the owning thread's count
+    uintptr_t owner;    // biased mode only: the owning thread's `sinl_rc_thread`, or 0 once the counts have been merged
+    size_t size;        // the size of the resource, not including this header
+#ifdef SINL_ALLOC_PROFILE
+    struct sinl_alloc_site *site;   // where the resource was allocated, or NULL if that isn't known
+    uintptr_t reserved;             // keeps the resource aligned to 16 bytes
+#endif
+};
+
+#define SINL_RC_HEADER(resource) ((struct sinl_rc_header *)(resource) - 1)
+
+#ifdef SINL_ALLOC_PROFILE
+#define SINL_RC_PROFILE_RETAIN(header) sinl_alloc_profile_retained((header)->site)
+#define SINL_RC_PROFILE_RELEASE(header) sinl_alloc_profile_released((header)->site)
+#else
+#define SINL_RC_PROFILE_RETAIN(header) ((void)0)
+#define SINL_RC_PROFILE_RELEASE(header) ((void)0)
+#endif
+
+/**
+ * Added to the shared count when the owner's count is merged into it, so that other threads can tell it has been.
+ */
+#define SINL_RC_MERGED ((intptr_t)1 << (sizeof(intptr_t) * CHAR_BIT - 2))
+
+/**
+ * A release handed to the owner of a resource by another thread.
+ */
+struct sinl_rc_deferred
+{
+    struct sinl_rc_deferred *next;
+    void *resource;
+};
+
+/**
+ * A thread that owns resources in the biased mode.
+ *
+ * A thread that releases a reference held by the owner's count can't update that count itself, so it pushes the
+ * release onto the owner's `deferred` list instead. The owner applies the list the next time it allocates or releases
+ * a resource of its own, and when it exits; from then on, the list is closed, and a thread that would hand a release
+ * to it merges the counts itself, which is safe as the owner's count can no longer change. Records are never freed,
+ * since other threads may still hold resources owned by a thread that has exited.
+ */
+struct sinl_rc_thread
+{
+    struct sinl_rc_deferred *deferred;  // the releases handed over by other threads, or SINL_RC_EXITED
+    void (*drain)(struct sinl_rc_thread *thread);   // applies the deferred releases when the thread exits
+};
+
+#define SINL_RC_EXITED ((struct sinl_rc_deferred *)1)
+
+/**
+ * The calling thread's record. Until the thread first allocates a resource in the biased mode, this is a shared record
+ * that owns nothing, and whose `drain` is NULL.
+ */
+extern SINL_THREAD_LOCAL struct sinl_rc_thread *sinl_rc_current_thread;
+
+/**
+ * Creates the calling thread's record, which is closed with `drain` when the thread exits.
+ *
+ * `drain` is passed in, rather than called from the library, because it frees resources, and the layout of their
+ * headers depends on whether the program was built with `SINL_ALLOC_PROFILE`.
+ */
+struct sinl_rc_thread *sinl_rc_attach_thread(void (*drain)(struct sinl_rc_thread *thread));
+
+/**
+ * Ensures that threads which exit with releases still to apply get to apply them; called when a release is first deferred.
+ */
+void sinl_rc_watch_exit(void);
+
+static inline uintptr_t sinl_thread_id(void)
+{
+    return (uintptr_t)sinl_rc_current_thread;
+}
+
+static inline void *sinl_rc_init(struct sinl_rc_header *header, size_t size, intptr_t count, intptr_t biased, uintptr_t owner)
+{
+    if (SINL_UNLIKELY(header == NULL))
+        return NULL;
+
+    header->count = count;
+    header->biased = biased;
+    header->owner = owner;
+    header->size = size;
+#ifdef SINL_ALLOC_PROFILE
+    header->site = NULL;
+#endif
+    return header + 1;
+}
+
+/**
+ * Allocates a managed resource with a single reference, for the atomic and non-atomic modes.
+ */
+static inline void *sinl_rc_alloc(size_t size)
+{
+    return sinl_rc_init(sinl_pool_alloc(sizeof(struct sinl_rc_header) + size), size, 1, 0, 0);
+}
+
+#ifdef SINL_ALLOC_PROFILE
+/**
+ * Records that `resource`, if it was obtained, was allocated at `site`.
+ */
+static inline void *sinl_rc_track(void *resource, struct sinl_alloc_site *site)
+{
+    if (resource != NULL)
+    {
+        SINL_RC_HEADER(resource)->site = site;
+        sinl_alloc_profile_allocated(site, SINL_RC_HEADER(resource)->size);
+    }
+
+    return resource;
+}
+#endif
+
+static inline void sinl_rc_free(void *resource)
+{
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+#ifdef SINL_ALLOC_PROFILE
+    if (header->site != NULL)
+        sinl_alloc_profile_freed(header->site, header->size);
+#endif
+    sinl_pool_free(header, sizeof(struct sinl_rc_header) + header->size);
+}
+
+/* non-atomic counts */
+
+static inline void sinl_rc_retain_nonatomic(void *resource)
+{
+    if (resource != NULL)
+    {
+        SINL_RC_PROFILE_RETAIN(SINL_RC_HEADER(resource));
+        SINL_RC_HEADER(resource)->count++;
+    }
+}
+
+static inline void sinl_rc_release_nonatomic(void *resource)
+{
+    if (resource == NULL)
+        return;
+
+    SINL_RC_PROFILE_RELEASE(SINL_RC_HEADER(resource));
+    if (--SINL_RC_HEADER(resource)->count == 0)
+        sinl_rc_free(resource);
+}
+
+/* atomic counts */
+
+static inline void sinl_rc_retain_atomic(void *resource)
+{
+    if (resource != NULL)
+    {
+        SINL_RC_PROFILE_RETAIN(SINL_RC_HEADER(resource));
+        __atomic_add_fetch(&SINL_RC_HEADER(resource)->count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static inline void sinl_rc_release_atomic(void *resource)
+{
+    if (resource == NULL)
+        return;
+
+    SINL_RC_PROFILE_RELEASE(SINL_RC_HEADER(resource));
+    if (__atomic_sub_fetch(&SINL_RC_HEADER(resource)->count, 1, __ATOMIC_ACQ_REL) == 0)
+        sinl_rc_free(resource);
+}
+
+/* biased counts */
+
+static inline int sinl_rc_is_owner(const struct sinl_rc_header *header)
+{
+    return __atomic_load_n(&header->owner, __ATOMIC_RELAXED) == sinl_thread_id();
+}
+
+static inline void sinl_rc_retain_biased(void *resource)
+{
+    if (resource == NULL)
+        return;
+
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+    SINL_RC_PROFILE_RETAIN(header);
+    if (sinl_rc_is_owner(header))
+        header->biased++;
+    else
+        __atomic_add_fetch(&header->count, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * Releases a reference on the owning thread.
+ */
+static inline void sinl_rc_release_owned(void *resource)
+{
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+    if (--header->biased == 0)
+    {
+        // give up ownership; from now on, every thread uses the shared count
+        __atomic_store_n(&header->owner, 0, __ATOMIC_RELAXED);
+        if (__atomic_fetch_add(&header->count, SINL_RC_MERGED, __ATOMIC_ACQ_REL) == 0)
+            sinl_rc_free(resource);
+    }
+}
+
+/**
+ * Hands a release to the owner of a resource whose shared count is zero, so that the owner's count holds the reference.
+ *
+ * Returns 0 if the counts were being merged, and the release should be tried again.
+ */
+static inline SINL_COLD int sinl_rc_defer_release(void *resource)
+{
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+    uintptr_t owner = __atomic_load_n(&header->owner, __ATOMIC_ACQUIRE);
+    if (owner == 0)
+        return 0;
+
+    struct sinl_rc_thread *thread = (struct sinl_rc_thread *)owner;
+    struct sinl_rc_deferred *node = malloc(sizeof *node);
+    struct sinl_rc_deferred *head = __atomic_load_n(&thread->deferred, __ATOMIC_ACQUIRE);
+    if (node != NULL)
+    {
+        sinl_rc_watch_exit();
+        node->resource = resource;
+        do
+        {
+            node->next = head;
+        } while (head != SINL_RC_EXITED &&
+            !__atomic_compare_exchange_n(&thread->deferred, &head, node, 1, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+
+        if (head != SINL_RC_EXITED)
+            return 1;
+        free(node);
+    }
+    else if (head != SINL_RC_EXITED)
+    {
+        // with nowhere to put the release, the resource is leaked rather than risk freeing it while it is in use
+        return 1;
+    }
+
+    // the owner has exited, so its count is final; whichever thread takes ownership away merges the counts
+    if (!__atomic_compare_exchange_n(&header->owner, &owner, 0, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return 0;
+
+    const intptr_t merged = SINL_RC_MERGED + header->biased - 1;
+    if (__atomic_add_fetch(&header->count, merged, __ATOMIC_ACQ_REL) == SINL_RC_MERGED)
+        sinl_rc_free(resource);
+    return 1;
+}
+
+/**
+ * Releases a reference on a thread other than the owner, or once the counts have been merged.
+ *
+ * The shared count never goes below zero; a reference that the owner's count holds is handed back to the owner.
+ */
+static inline void sinl_rc_release_shared(void *resource)
+{
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+    intptr_t count = __atomic_load_n(&header->count, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        if (SINL_UNLIKELY(count == 0))
+        {
+            if (sinl_rc_defer_release(resource))
+                return;
+            count = __atomic_load_n(&header->count, __ATOMIC_RELAXED);
+        }
+        else if (__atomic_compare_exchange_n(&header->count, &count, count - 1, 1, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+
+    if (count - 1 == SINL_RC_MERGED)
+        sinl_rc_free(resource);
+}
+
+/**
+ * Applies the releases other threads have handed to `thread`, which must be the calling thread.
+ */
+static inline void sinl_rc_drain(struct sinl_rc_thread *thread)
+{
+    struct sinl_rc_deferred *node = __atomic_load_n(&thread->deferred, __ATOMIC_ACQUIRE);
+    while (node != NULL && node != SINL_RC_EXITED &&
+        !__atomic_compare_exchange_n(&thread->deferred, &node, NULL, 1, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        ;
+
+    if (node == SINL_RC_EXITED)
+        return;
+
+    while (node != NULL)
+    {
+        struct sinl_rc_deferred *next = node->next;
+        if (sinl_rc_is_owner(SINL_RC_HEADER(node->resource)))
+            sinl_rc_release_owned(node->resource);
+        else
+            sinl_rc_release_shared(node->resource);
+        free(node);
+        node = next;
+    }
+}
+
+static inline int sinl_rc_has_deferred(const struct sinl_rc_thread *thread)
+{
+    return __atomic_load_n(&thread->deferred, __ATOMIC_RELAXED) != NULL;
+}
+
+/**
+ * Allocates a managed resource with a single reference owned by the calling thread, for the biased mode.
+ */
+static inline void *sinl_rc_alloc_biased(size_t size)
+{
+    struct sinl_rc_thread *thread = sinl_rc_current_thread;
+    if (SINL_UNLIKELY(thread->drain == NULL))
+    {
+        // a thread without a record can't own anything, so the resource starts out with its counts merged
+        thread = sinl_rc_attach_thread(sinl_rc_drain);
+        if (thread == NULL)
+            return sinl_rc_init(sinl_pool_alloc(sizeof(struct sinl_rc_header) + size), size, SINL_RC_MERGED + 1, 0, 0);
+    }
+    else if (SINL_UNLIKELY(sinl_rc_has_deferred(thread)))
+        sinl_rc_drain(thread);
+
+    return sinl_rc_init(sinl_pool_alloc(sizeof(struct sinl_rc_header) + size), size, 0, 1, (uintptr_t)thread);
+}
+
+static inline void sinl_rc_release_biased(void *resource)
+{
+    if (resource == NULL)
+        return;
+
+    struct sinl_rc_header *header = SINL_RC_HEADER(resource);
+    SINL_RC_PROFILE_RELEASE(header);
+    if (sinl_rc_is_owner(header))
+    {
+        sinl_rc_release_owned(resource);
+        if (SINL_UNLIKELY(sinl_rc_has_deferred(sinl_rc_current_thread)))
+            sinl_rc_drain(sinl_rc_current_thread);
+    }
+    else
+    {
+        sinl_rc_release_shared(resource);
+    }
+}
+
+/* batched releases */
+
+/**
+ * Releases one reference to each of `count` resources, such as the managed locals of a scope that is exiting.
+ *
+ * This replaces a call per resource with a single call that updates the counts in a tight loop. NULL entries are skipped.
+ */
+void sinl_rc_release_batch_nonatomic(void *const *resources, size_t count);
+void sinl_rc_release_batch_atomic(void *const *resources, size_t count);
+void sinl_rc_release_batch_biased(void *const *resources, size_t count);
+
+#ifdef SINL_ALLOC_PROFILE
+/*
+ * The runtime library is built without the profiling fields in the header, so when profiling, the batches are
+ * released here instead, in code that knows where the fields are.
+ */
+
+static inline void sinl_rc_release_batch_nonatomic_profiled(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_nonatomic(resources[i]);
+}
+
+static inline void sinl_rc_release_batch_atomic_profiled(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_atomic(resources[i]);
+}
+
+static inline void sinl_rc_release_batch_biased_profiled(void *const *resources, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        sinl_rc_release_biased(resources[i]);
+}
+
+#define sinl_rc_release_batch_nonatomic sinl_rc_release_batch_nonatomic_profiled
+#define sinl_rc_release_batch_atomic sinl_rc_release_batch_atomic_profiled
+#define sinl_rc_release_batch_biased sinl_rc_release_batch_biased_profiled
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * Bump-pointer regions, used for dynamic data when the compiler's region allocation mode is enabled.
+ *
+ * A region hands out memory from a single buffer by advancing an offset. Nothing is released individually;
+ * instead, the generated code records the offset when a scope that allocates from the region is entered
+ * and resets the region to it when the scope exits, releasing everything the scope allocated at once.
+ *
+ * Everything here is defined in this header so that it can be used in uSIN, where no runtime library is linked.
+ */
+
+#include <stddef.h>
+
+#include "sinl_common.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The alignment of every block handed out by a region; suitable for any scalar type.
+ */
+#define SINL_REGION_ALIGNMENT 16
+
+struct sinl_region
+{
+    unsigned char *base;
+    size_t size;
+    size_t top;
+};
+
+/**
+ * Allocates `size` bytes from the region.
+ *
+ * Returns NULL if the region is exhausted.
+ */
+static inline void *sinl_region_alloc(struct sinl_region *region, size_t size)
+{
+    const size_t start = (region->top + SINL_REGION_ALIGNMENT - 1) & ~(size_t)(SINL_REGION_ALIGNMENT - 1);
+    if (SINL_UNLIKELY(start > region->size || size > region->size - start))
+        return NULL;
+
+    region->top = start + size;
+    return region->base + start;
+}
+
+/**
+ * Gets the current position in the region, to be passed to `sinl_region_reset`.
+ */
+static inline size_t sinl_region_mark(const struct sinl_region *region)
+{
+    return region->top;
+}
+
+/**
+ * Releases everything allocated from the region since `mark` was taken.
+ */
+static inline void sinl_region_reset(struct sinl_region *region, size_t mark)
+{
+    region->top = mark;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,158 @@
+#include "sinl_string.h"
+
+#include <string.h>
+
+static char *allocate_buffer(uint32_t capacity)
+{
+    return sinl_pool_alloc((size_t)capacity + 1);
+}
+
+static void free_buffer(char *buffer, uint32_t capacity)
+{
+    sinl_pool_free(buffer, (size_t)capacity + 1);
+}
+
+/**
+ * Builds a string from the given pieces in `result` without touching any existing string,
+ * so that the pieces may refer to the string being replaced.
+ */
+static int build(sinl_string *result, const char *first, uint32_t first_length, const char *second, uint32_t second_length, uint32_t capacity)
+{
+    const uint32_t length = first_length + second_length;
+    char *data;
+    if (length <= SINL_STRING_SMALL_CAPACITY)
+    {
+        result->s.length = length;
+        data = result->s.data;
+    }
+    else
+    {
+        data = allocate_buffer(capacity);
+        if (data == NULL)
+            return 0;
+
+        result->l.length = length;
+        result->l.capacity = capacity;
+        result->l.data = data;
+    }
+
+    if (first_length)
+        memcpy(data, first, first_length);
+    if (second_length)
+        memcpy(data + first_length, second, second_length);
+    data[length] = '\0';
+    return 1;
+}
+
+char *sinl_string_mutable_data(sinl_string *str)
+{
+    if (sinl_string_is_small(str))
+        return str->s.data;
+
+    if (str->l.capacity == 0)
+    {
+        sinl_string owned;
+        if (!build(&owned, str->l.data, str->l.length, NULL, 0, str->l.length))
+            return NULL;
+
+        *str = owned;
+    }
+
+    return str->l.data;
+}
+
+int sinl_string_assign(sinl_string *str, const char *data, uint32_t length)
+{
+    // a short string replacing another needs no memory; memmove allows `data` to point into the string itself
+    if (length <= SINL_STRING_SMALL_CAPACITY && sinl_string_is_small(str))
+    {
+        memmove(str->s.data, data, length);
+        str->s.data[length] = '\0';
+        str->s.length = length;
+        return 1;
+    }
+
+    sinl_string result;
+    if (!build(&result, data, length, NULL, 0, length))
+        return 0;
+
+    sinl_string_release(str);
+    *str = result;
+    return 1;
+}
+
+int sinl_string_concat(sinl_string *dest, const sinl_string *left, const sinl_string *right)
+{
+    const uint32_t left_length = sinl_string_length(left);
+    const uint32_t right_length = sinl_string_length(right);
+    if (right_length > UINT32_MAX - left_length)
+        return 0;
+
+    const uint32_t length = left_length + right_length;
+
+    // appending to a string that has enough space, inline or in a buffer of its own, can be done in place
+    if (dest == left && (sinl_string_is_small(dest) ? length <= SINL_STRING_SMALL_CAPACITY : dest->l.capacity >= length))
+    {
+        char *data = sinl_string_is_small(dest) ? dest->s.data : dest->l.data;
+        memmove(data + left_length, sinl_string_data(right), right_length);
+        data[length] = '\0';
+        dest->s.length = length;
+        return 1;
+    }
+
+    // when appending, leave room to grow so that repeated appends are amortized
+    uint32_t capacity = length;
+    if (dest == left && length <= UINT32_MAX / 2)
+        capacity = length * 2;
+
+    sinl_string result;
+    if (!build(&result, sinl_string_data(left), left_length, sinl_string_data(right), right_length, capacity))
+        return 0;
+
+    sinl_string_release(dest);
+    *dest = result;
+    return 1;
+}
+
+void sinl_string_release(sinl_string *str)
+{
+    if (!sinl_string_is_small(str) && str->l.capacity != 0)
+        free_buffer(str->l.data, str->l.capacity);
+
+    str->s.length = 0;
+    str->s.data[0] = '\0';
+}
+
+sinl_string sinl_string_copy(const sinl_string *str, const struct sinl_error_site *site)
+{
+    if (!sinl_string_is_small(str) && str->l.capacity == 0)
+        return *str;
+
+    sinl_string copy;
+    if (!build(&copy, sinl_string_data(str), sinl_string_length(str), NULL, 0, sinl_string_length(str)))
+        sinl_fail_alloc(site, (size_t)sinl_string_length(str) + 1);
+
+    return copy;
+}
+
+void sinl_string_set(sinl_string *dest, const sinl_string *src, const struct sinl_error_site *site)
+{
+    if (dest == src)
+        return;
+
+    if (!sinl_string_is_small(src) && src->l.capacity == 0)
+    {
+        sinl_string_release(dest);
+        *dest = *src;
+    }
+    else if (!sinl_string_assign(dest, sinl_string_data(src), sinl_string_length(src)))
+    {
+        sinl_fail_alloc(site, (size_t)sinl_string_length(src) + 1);
+    }
+}
+
+void sinl_string_append(sinl_string *dest, const sinl_string *left, const sinl_string *right, const struct sinl_error_site *site)
+{
+    if (!sinl_string_concat(dest, left, right))
+        sinl_fail_alloc(site, (size_t)sinl_string_length(left) + sinl_string_length(right) + 1);
+}
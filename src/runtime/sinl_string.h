@@ -0,0 +1,139 @@
+#pragma once
+
+/**
+ * The representation of the SIN `string` type.
+ *
+ * A string is a 24-byte value beginning with its 4-byte length. Strings of up to SINL_STRING_SMALL_CAPACITY characters
+ * are stored inline, directly after the length, so they need no allocation at all. Longer strings store a pointer
+ * to their characters and the capacity of that buffer instead.
+ *
+ * A long string with a capacity of 0 refers to characters it doesn't own, such as a string literal;
+ * it is copied into a buffer of its own the first time it is modified.
+ *
+ * In both cases, the characters are followed by a null byte so that they may be passed to C.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sinl_error.h"
+#include "sinl_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The size of the inline buffer, including the null terminator.
+ */
+#define SINL_STRING_SMALL_SIZE 20
+#define SINL_STRING_SMALL_CAPACITY (SINL_STRING_SMALL_SIZE - 1)
+
+typedef union sinl_string
+{
+    struct
+    {
+        uint32_t length;
+        char data[SINL_STRING_SMALL_SIZE];
+    } s;
+    struct
+    {
+        uint32_t length;
+        uint32_t capacity;  // 0 if the characters are not owned by the string
+        char *data;
+    } l;
+} sinl_string;
+
+#define SINL_STRING_EMPTY { .s = { 0, "" } }
+
+/**
+ * Initializers for strings from literals; the compiler picks one based on the literal's length.
+ */
+#define SINL_STRING_SMALL_LITERAL(literal, length) { .s = { (length), literal } }
+#define SINL_STRING_LARGE_LITERAL(literal, length) { .l = { (length), 0, (char *)(literal) } }
+
+static inline int sinl_string_is_small(const sinl_string *str)
+{
+    return str->s.length <= SINL_STRING_SMALL_CAPACITY;
+}
+
+static inline uint32_t sinl_string_length(const sinl_string *str)
+{
+    return str->s.length;
+}
+
+/**
+ * Gets the string's characters for reading.
+ */
+static inline const char *sinl_string_data(const sinl_string *str)
+{
+    return sinl_string_is_small(str) ? str->s.data : str->l.data;
+}
+
+/**
+ * Gets the character at `index`; the index must already have been checked against the length.
+ */
+static inline char sinl_string_at(const sinl_string *str, uint32_t index)
+{
+    return sinl_string_data(str)[index];
+}
+
+/**
+ * Compares the contents of two strings.
+ */
+static inline int sinl_string_equal(const sinl_string *left, const sinl_string *right)
+{
+    const uint32_t length = sinl_string_length(left);
+    if (length != sinl_string_length(right))
+        return 0;
+
+    const char *left_data = sinl_string_data(left);
+    const char *right_data = sinl_string_data(right);
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (left_data[i] != right_data[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Gets the string's characters for writing, first copying them into a buffer of its own if necessary.
+ *
+ * Returns NULL if the memory could not be obtained.
+ */
+char *sinl_string_mutable_data(sinl_string *str);
+
+/**
+ * Sets the string's contents to `length` characters from `data`.
+ *
+ * Returns 0 if the memory could not be obtained, in which case the string is unchanged.
+ */
+int sinl_string_assign(sinl_string *str, const char *data, uint32_t length);
+
+/**
+ * Sets `dest` to the concatenation of `left` and `right`; `dest` may be either of them.
+ *
+ * Returns 0 if the memory could not be obtained, in which case `dest` is unchanged.
+ */
+int sinl_string_concat(sinl_string *dest, const sinl_string *left, const sinl_string *right);
+
+/**
+ * Releases any memory owned by the string, leaving it empty.
+ */
+void sinl_string_release(sinl_string *str);
+
+/**
+ * The operations used by generated code, which stop the program at `site` if the memory could not be obtained.
+ *
+ * Strings are values, so each copy owns its characters; copies of a string that doesn't own its characters, such as a
+ * literal, share them instead.
+ */
+sinl_string sinl_string_copy(const sinl_string *str, const struct sinl_error_site *site);
+void sinl_string_set(sinl_string *dest, const sinl_string *src, const struct sinl_error_site *site);
+void sinl_string_append(sinl_string *dest, const sinl_string *left, const sinl_string *right, const struct sinl_error_site *site);
+
+#ifdef __cplusplus
+}
+#endif
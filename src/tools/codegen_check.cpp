@@ -0,0 +1,148 @@
+/*
+
+SIN Compiler
+codegen_check.cpp
+
+Checks the compiler's output on small SIN programs.
+
+Usage: codegen_check
+
+Each case compiles a short program at a given optimization level, then checks that the generated C contains the
+expected text and that none of the listed messages were printed while compiling it. The program exits with an error if
+any case failed.
+
+*/
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../cgen/cgen.hpp"
+
+namespace
+{
+    struct check_case
+    {
+        const char* name;
+        unsigned int optimization_level;
+        const char* source;
+        std::vector<std::string> expected;     // text the generated C must contain
+        std::vector<std::string> forbidden;    // text the compiler must not print
+    };
+
+    const std::vector<check_case> cases = {
+        {
+            // folding gives negative literals, which must not be taken as too large for their type
+            "folded negative literals", 2,
+            "def int f(alloc int y) {\n"
+            "    alloc int x: 3 - 64;\n"
+            "    let x = x + y * (2 - 10);\n"
+            "    return x;\n"
+            "}\n",
+            { "-61", "-8" },
+            { "W243" },
+        },
+    };
+
+    /**
+     * Reads a whole file.
+     */
+    std::string read_file(const std::filesystem::path& path)
+    {
+        std::ifstream in(path);
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    /**
+     * Runs a single case, printing every way in which it failed.
+     *
+     * @return  Whether the case passed
+     */
+    bool run_case(const check_case& c, const std::filesystem::path& dir)
+    {
+        const auto in_path = dir / "check.sin";
+        const auto out_path = dir / "check.c";
+        {
+            std::ofstream in(in_path);
+            in << c.source;
+        }
+
+        // warnings are written to std::cout
+        std::ostringstream messages;
+        std::streambuf* const stdout_buffer = std::cout.rdbuf(messages.rdbuf());
+        std::string error;
+        try
+        {
+            cgen generator(false, false, false, c.optimization_level);
+            generator.generate_code(in_path.string(), out_path.string());
+        }
+        catch (std::exception& e)
+        {
+            error = e.what();
+        }
+        std::cout.rdbuf(stdout_buffer);
+
+        if (!error.empty())
+        {
+            std::cout << "FAIL " << c.name << ": " << error << std::endl;
+            return false;
+        }
+
+        bool passed = true;
+        const std::string generated = read_file(out_path);
+        for (const std::string& text: c.expected)
+        {
+            if (generated.find(text) == std::string::npos)
+            {
+                std::cout << "FAIL " << c.name << ": generated code does not contain \"" << text << "\"" << std::endl;
+                passed = false;
+            }
+        }
+
+        for (const std::string& text: c.forbidden)
+        {
+            if (messages.str().find(text) != std::string::npos)
+            {
+                std::cout << "FAIL " << c.name << ": compiler printed \"" << text << "\"" << std::endl;
+                passed = false;
+            }
+        }
+
+        if (!passed)
+        {
+            std::cout << messages.str();
+        }
+
+        return passed;
+    }
+}
+
+int main()
+{
+    const auto dir = std::filesystem::temp_directory_path() / "csin_codegen_check";
+    std::filesystem::create_directories(dir);
+
+    size_t failed = 0;
+    for (const check_case& c: cases)
+    {
+        if (run_case(c, dir))
+        {
+            std::cout << "ok   " << c.name << std::endl;
+        }
+        else
+        {
+            failed += 1;
+        }
+    }
+
+    std::filesystem::remove_all(dir);
+
+    std::cout << cases.size() - failed << " of " << cases.size() << " cases passed" << std::endl;
+    return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
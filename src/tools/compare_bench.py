@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+
+"""
+Compares two result files written by `micro_bench --json`, flagging benchmarks that slowed down.
+
+Usage: compare_bench.py <baseline.json> <current.json> [--threshold=<percent>]
+
+A benchmark is flagged when its median time per iteration grew by more than the threshold (default 5%). Exits with
+status 1 if any were flagged, so that it may be used to fail a build.
+"""
+
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as f:
+        results = json.load(f)
+
+    return results.get("label", ""), {b["name"]: b for b in results["benchmarks"]}
+
+
+def main(argv):
+    threshold = 5.0
+    filenames = []
+    for arg in argv[1:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg[len("--threshold="):])
+        else:
+            filenames.append(arg)
+
+    if len(filenames) != 2:
+        print(__doc__.strip(), file=sys.stderr)
+        return 2
+
+    baseline_label, baseline = load(filenames[0])
+    current_label, current = load(filenames[1])
+
+    print("{:<40} {:>16} {:>16} {:>9}".format("benchmark", baseline_label or "baseline", current_label or "current", "change"))
+
+    slower = []
+    for name, result in current.items():
+        if name not in baseline:
+            print("{:<40} {:>16} {:>16.1f} {:>9}".format(name, "-", result["ns_per_op"], "new"))
+            continue
+
+        before = baseline[name]["ns_per_op"]
+        after = result["ns_per_op"]
+        change = (after - before) / before * 100.0 if before > 0 else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  SLOWER"
+            slower.append(name)
+
+        print("{:<40} {:>16.1f} {:>16.1f} {:>+8.1f}%{}".format(name, before, after, change, flag))
+
+    for name in baseline:
+        if name not in current:
+            print("{:<40} {:>16.1f} {:>16} {:>9}".format(name, baseline[name]["ns_per_op"], "-", "removed"))
+
+    if slower:
+        print("\n{} benchmark(s) slowed down by more than {}%".format(len(slower), threshold))
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,187 @@
+/*
+
+SIN Compiler
+compile_bench.cpp
+
+Measures the throughput of each phase of the compiler on a set of SIN files, such as a corpus from `sin_corpus`.
+
+Usage: compile_bench [-O<level>] [-r<runs>] files...
+
+Every file is compiled `runs` times (default 3) at the given optimization level (default 0), and the generated C is
+discarded. The phases are timed with the time report, and their throughput is given in source bytes and tokens per
+second, taken from the fastest run of each.
+
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../cgen/cgen.hpp"
+#include "../parser/lexer.hpp"
+#include "../util/exceptions.hpp"
+#include "../util/phase_report.hpp"
+
+using general_utilities::phase_report;
+
+namespace
+{
+    // the phases run by cgen::generate_code, in order
+    const char* const phases[] = { "lex", "parse", "optimize", "generate", "write output" };
+
+    /**
+     * Counts the tokens in a file the way the parser does, skipping empty lexemes.
+     */
+    size_t count_tokens(const std::string& filename)
+    {
+        std::ifstream in(filename);
+        lexer l(in);
+
+        size_t tokens = 0;
+        while (!l.eof() && !l.exit_flag_is_set())
+        {
+            const lexeme token = l.read_next();
+            if (token.type != enumerations::lexeme_type::NULL_LEXEME && token.line_number != 0)
+                tokens++;
+        }
+
+        return tokens;
+    }
+
+    /**
+     * Gets the total wall time of each top-level phase recorded so far.
+     */
+    std::map<std::string, double> get_phase_times()
+    {
+        std::map<std::string, double> times;
+        for (const auto& p: phase_report::get().get_phases())
+        {
+            if (p.parent == phase_report::npos)
+                times[p.name] += p.wall_seconds;
+        }
+
+        return times;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int optimization_level = 0;
+    unsigned int runs = 3;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg.compare(0, 2, "-O") == 0)
+            optimization_level = static_cast<unsigned int>(std::atoi(arg.c_str() + 2));
+        else if (arg.compare(0, 2, "-r") == 0 && std::atoi(arg.c_str() + 2) > 0)
+            runs = static_cast<unsigned int>(std::atoi(arg.c_str() + 2));
+        else
+            files.push_back(arg);
+    }
+
+    if (files.empty())
+    {
+        std::cerr << "Usage: compile_bench [-O<level>] [-r<runs>] files..." << std::endl;
+        return 1;
+    }
+
+    size_t bytes = 0;
+    size_t tokens = 0;
+    size_t lines = 0;
+    for (const auto& filename: files)
+    {
+        // a directory opens without error, but fails on the first read
+        std::ifstream in(filename, std::ios::binary);
+        if (!std::filesystem::is_regular_file(filename) || !in.good())
+        {
+            std::cerr << "Could not open '" << filename << "'" << std::endl;
+            return 1;
+        }
+
+        const std::string source((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes += source.size();
+        lines += std::count(source.begin(), source.end(), '\n');
+        tokens += count_tokens(filename);
+    }
+
+    // the compiler reports its progress on stdout, which would drown out the results
+    std::ostringstream discarded;
+    std::streambuf* const stdout_buffer = std::cout.rdbuf(discarded.rdbuf());
+
+    phase_report::get().enable();
+    std::map<std::string, double> best;
+    double best_total = 0.0;
+    for (unsigned int run = 0; run < runs; run++)
+    {
+        const std::map<std::string, double> before = get_phase_times();
+        for (const auto& filename: files)
+        {
+            try
+            {
+                cgen generator(false, false, false, optimization_level);
+                generator.generate_code(filename, "/dev/null");
+            }
+            catch (std::exception& e)
+            {
+                std::cout.rdbuf(stdout_buffer);
+                std::cerr << filename << ": " << e.what() << std::endl;
+                return 1;
+            }
+            discarded.str("");
+        }
+
+        // keep the fastest time of each phase
+        const std::map<std::string, double> after = get_phase_times();
+        double total = 0.0;
+        for (const auto& p: after)
+        {
+            const auto it = before.find(p.first);
+            const double seconds = p.second - (it == before.end() ? 0.0 : it->second);
+            total += seconds;
+            if (run == 0 || seconds < best[p.first])
+                best[p.first] = seconds;
+        }
+        if (run == 0 || total < best_total)
+            best_total = total;
+    }
+
+    std::cout.rdbuf(stdout_buffer);
+
+    std::cout << files.size() << " files, " << bytes / 1024 << " KiB, " << lines << " lines, " << tokens << " tokens; " <<
+        "best of " << runs << " runs at -O" << optimization_level << std::endl;
+    std::cout << std::left << std::setw(16) << "phase" << std::right <<
+        std::setw(12) << "wall (ms)" <<
+        std::setw(12) << "MiB/s" <<
+        std::setw(14) << "tokens/s" <<
+        std::setw(14) << "lines/s" << std::endl;
+
+    std::cout << std::fixed;
+    const auto print_phase = [&](const std::string& name, double seconds)
+    {
+        const double mib = static_cast<double>(bytes) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(16) << name << std::right <<
+            std::setprecision(3) << std::setw(12) << seconds * 1000.0 <<
+            std::setprecision(3) << std::setw(12) << (seconds > 0.0 ? mib / seconds : 0.0) <<
+            std::setprecision(0) << std::setw(14) << (seconds > 0.0 ? tokens / seconds : 0.0) <<
+            std::setw(14) << (seconds > 0.0 ? lines / seconds : 0.0) << std::endl;
+    };
+
+    for (const char* name: phases)
+    {
+        const auto it = best.find(name);
+        if (it != best.end())
+            print_phase(name, it->second);
+    }
+    print_phase("total", best_total);
+
+    return 0;
+}
@@ -0,0 +1,566 @@
+/*
+
+SIN Compiler
+micro_bench.cpp
+
+Microbenchmarks for the compiler's hot paths: the lexer, expression parsing, the type system, symbol decoration and
+lookup, and allocation codegen.
+
+Usage: micro_bench [--filter=<text>] [--min-time=<seconds>] [--repetitions=<n>] [--json=<file>] [--label=<text>]
+
+Each benchmark is first run until it takes `min-time` (default 0.1s) to find how many iterations to time, and then
+timed `repetitions` times (default 5); the median time per iteration is reported. With `--json`, the results are also
+written to a file that `compare_bench.py` can compare against another run, e.g. one from the previous commit; the label
+is stored with them, so it may be used for the commit hash.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../cgen/cgen.hpp"
+#include "../cgen/common/symbol.hpp"
+#include "../cgen/common/symbol_table.hpp"
+#include "../parser/lexer.hpp"
+#include "../parser/parser.hpp"
+#include "../util/data_type.hpp"
+
+namespace
+{
+    /**
+     * Passed to a benchmark, which performs its operation `iterations()` times.
+     *
+     * Setup that shouldn't be timed is done between `pause()` and `resume()`.
+     */
+    class bench_state
+    {
+        size_t _iterations;
+        size_t _items;
+        bool _running;
+        std::chrono::steady_clock::time_point _start;
+        std::chrono::steady_clock::duration _elapsed;
+    public:
+        size_t iterations() const { return _iterations; }
+
+        void pause()
+        {
+            if (_running)
+            {
+                _elapsed += std::chrono::steady_clock::now() - _start;
+                _running = false;
+            }
+        }
+
+        void resume()
+        {
+            if (!_running)
+            {
+                _start = std::chrono::steady_clock::now();
+                _running = true;
+            }
+        }
+
+        /**
+         * Sets the number of items, such as tokens, handled by each iteration, so that throughput can be reported.
+         */
+        void set_items_per_iteration(size_t items) { _items = items; }
+        size_t get_items_per_iteration() const { return _items; }
+
+        double get_seconds() const
+        {
+            return std::chrono::duration<double>(_elapsed).count();
+        }
+
+        explicit bench_state(size_t iterations)
+            : _iterations(iterations)
+            , _items(0)
+            , _running(false)
+            , _elapsed(0) { }
+    };
+
+    struct benchmark
+    {
+        std::string name;
+        std::function<void(bench_state&)> run;
+    };
+
+    struct result
+    {
+        std::string name;
+        size_t iterations;
+        double ns_per_op;       // the median of the repetitions
+        double min_ns_per_op;
+        double items_per_second;
+    };
+
+    /**
+     * Keeps the compiler from discarding a computation whose result is never used.
+     */
+    template <typename T>
+    void keep(const T& value)
+    {
+        __asm__ volatile("" : : "g"(&value) : "memory");
+    }
+
+    /**
+     * Writes source for a benchmark to a temporary file, which the parser requires, and removes it when done.
+     */
+    class source_file
+    {
+        std::string _path;
+    public:
+        const std::string& path() const { return _path; }
+
+        source_file(const std::string& name, const std::string& source)
+            : _path((std::filesystem::temp_directory_path() / ("micro_bench_" + name + ".sin")).string())
+        {
+            std::ofstream out(_path);
+            out << source;
+        }
+
+        ~source_file()
+        {
+            std::error_code error;
+            std::filesystem::remove(_path, error);
+        }
+    };
+
+    std::string repeat(const std::string& s, size_t count)
+    {
+        std::string repeated;
+        for (size_t i = 0; i < count; i++)
+            repeated += s;
+
+        return repeated;
+    }
+
+    /**
+     * Lexes `source` on every iteration.
+     */
+    benchmark lexer_benchmark(const std::string& name, const std::string& source)
+    {
+        return benchmark{ "lexer/read_next/" + name, [source](bench_state& state)
+        {
+            size_t tokens = 0;
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                state.pause();
+                std::istringstream in(source);
+                lexer l(in);
+                tokens = 0;
+                state.resume();
+
+                while (!l.eof() && !l.exit_flag_is_set())
+                {
+                    const lexeme token = l.read_next();
+                    keep(token);
+                    tokens++;
+                }
+            }
+            state.pause();
+            state.set_items_per_iteration(tokens);
+        } };
+    }
+
+    /**
+     * Parses `source` on every iteration; it is lexed only once, as each iteration starts from a copy of the parser.
+     */
+    benchmark parser_benchmark(const std::string& name, const std::string& source, size_t expressions)
+    {
+        return benchmark{ "parser/parse_expression/" + name, [name, source, expressions](bench_state& state)
+        {
+            // the parser reads past the end of a file ending in a binary expression, so the statements are put in a block
+            const source_file file(name, "{\n" + source + "}\n");
+            const parser lexed(file.path());
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                state.pause();
+                parser p(lexed);
+                state.resume();
+
+                const statement::statement_block ast = p.create_ast();
+                keep(ast);
+            }
+            state.pause();
+            state.set_items_per_iteration(expressions);
+        } };
+    }
+
+    /**
+     * Builds `1 + 2 * 3 - 4 ...` with `operands` operands, for precedence climbing.
+     */
+    std::string binary_chain(size_t operands)
+    {
+        static const char* const operators[] = { " + ", " * ", " - ", " / ", " < ", " and " };
+
+        std::string expression = "1";
+        for (size_t i = 1; i < operands; i++)
+            expression += std::string(operators[i % 6]) + std::to_string(i + 1);
+
+        return expression;
+    }
+
+    /**
+     * Builds `(1 + (2 * (3 - ...)))`, `depth` parentheses deep.
+     */
+    std::string binary_nested(size_t depth)
+    {
+        static const char* const operators[] = { " + ", " * ", " - " };
+
+        std::string expression = std::to_string(depth + 1);
+        for (size_t i = depth; i > 0; i--)
+            expression = "(" + std::to_string(i) + operators[i % 3] + expression + ")";
+
+        return expression;
+    }
+
+    /**
+     * A tuple<int, array<16, float>, string, ptr<long int>>, which exercises each kind of contained type.
+     */
+    data_type make_complex_type()
+    {
+        data_type array(enumerations::primitive_type::ARRAY, data_type(enumerations::primitive_type::FLOAT), symbol_qualities());
+        array.set_array_length(16);
+
+        const data_type long_int(
+            enumerations::primitive_type::INT,
+            std::vector<data_type>{ },
+            symbol_qualities(std::vector<enumerations::symbol_quality>{ enumerations::symbol_quality::LONG })
+        );
+        const data_type pointer(enumerations::primitive_type::PTR, long_int, symbol_qualities());
+
+        return data_type(
+            enumerations::primitive_type::TUPLE,
+            std::vector<data_type>{ data_type(enumerations::primitive_type::INT), array, data_type(enumerations::primitive_type::STRING), pointer },
+            symbol_qualities()
+        );
+    }
+
+    const std::vector<std::string> benchmark_scope{ "main", "loop_body", "if_block" };
+
+    std::vector<symbol> make_symbols(size_t count)
+    {
+        const data_type types[] = {
+            data_type(enumerations::primitive_type::INT),
+            data_type(enumerations::primitive_type::FLOAT),
+            data_type(enumerations::primitive_type::STRING),
+            make_complex_type()
+        };
+
+        std::vector<symbol> symbols;
+        for (size_t i = 0; i < count; i++)
+            symbols.emplace_back("symbol_" + std::to_string(i), benchmark_scope, types[i % 4], true, i + 1);
+
+        return symbols;
+    }
+
+    std::vector<benchmark> get_benchmarks()
+    {
+        std::vector<benchmark> benchmarks;
+
+        benchmarks.push_back(lexer_benchmark("keywords", repeat("alloc const int counter: total;\nlet value = counter;\n", 8)));
+        benchmarks.push_back(lexer_benchmark("numbers", repeat("1234 3.14159 0 42 1000000 2.5 7 65535\n", 8)));
+        benchmarks.push_back(lexer_benchmark("operators", repeat("a + b * (c - d) / e % f << g >= h != i and j or not k\n", 4)));
+        benchmarks.push_back(lexer_benchmark("strings", repeat("\"hello, world\" \"a somewhat longer string literal\" \"\"\n", 8)));
+
+        benchmarks.push_back(parser_benchmark("chain_64", "let x = " + binary_chain(64) + ";\n", 1));
+        benchmarks.push_back(parser_benchmark("nested_32", "let x = " + binary_nested(32) + ";\n", 1));
+        benchmarks.push_back(parser_benchmark("statements_32", repeat("let x = " + binary_chain(8) + ";\n", 32), 32));
+
+        benchmarks.push_back(benchmark{ "data_type/copy", [](bench_state& state)
+        {
+            const data_type t = make_complex_type();
+            state.resume();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                const data_type copy(t);
+                keep(copy);
+            }
+            state.pause();
+        } });
+
+        benchmarks.push_back(benchmark{ "data_type/compare", [](bench_state& state)
+        {
+            const data_type left = make_complex_type();
+            const data_type right = make_complex_type();
+            state.resume();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                const bool equal = left == right;
+                keep(equal);
+            }
+            state.pause();
+        } });
+
+        benchmarks.push_back(benchmark{ "data_type/decorate", [](bench_state& state)
+        {
+            const data_type t = make_complex_type();
+            state.resume();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                const std::string decorated = t.decorate();
+                keep(decorated);
+            }
+            state.pause();
+        } });
+
+        benchmarks.push_back(benchmark{ "symbol/decorate", [](bench_state& state)
+        {
+            const data_type t = make_complex_type();
+            state.resume();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                const std::string decorated = symbol::decorate("counter", benchmark_scope, t);
+                keep(decorated);
+            }
+            state.pause();
+        } });
+
+        benchmarks.push_back(benchmark{ "symbol_table/insert_1000", [](bench_state& state)
+        {
+            const std::vector<symbol> symbols = make_symbols(1000);
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                std::vector<symbol> to_add(symbols);
+                utility::symbol_table table;
+                state.resume();
+
+                for (auto& s: to_add)
+                    table.add_symbol(std::move(s));
+
+                state.pause();
+            }
+            state.set_items_per_iteration(symbols.size());
+        } });
+
+        benchmarks.push_back(benchmark{ "symbol_table/lookup_1000", [](bench_state& state)
+        {
+            const std::vector<symbol> symbols = make_symbols(1000);
+            utility::symbol_table table;
+            for (const auto& s: symbols)
+                table.add_symbol(symbol(s));
+
+            state.resume();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                for (const auto& s: symbols)
+                {
+                    const bool found = table.contains(s.get_name(), s.get_scope(), s.get_type());
+                    keep(found);
+                }
+            }
+            state.pause();
+            state.set_items_per_iteration(symbols.size());
+        } });
+
+        benchmarks.push_back(benchmark{ "cgen/gen_allocation", [](bench_state& state)
+        {
+            // a mix of the allocations gen_allocation treats differently; dynamic data may only be allocated in functions
+            std::string source = "def void bench() {\n";
+            size_t allocations = 0;
+            for (size_t i = 0; i < 25; i++)
+            {
+                const std::string n = std::to_string(i);
+                source += "alloc int i" + n + ": " + n + " * 4 + 1;\n";
+                source += "alloc float f" + n + ": 1.5;\n";
+                source += "alloc const string s" + n + ": \"constant string\";\n";
+                source += "alloc string t" + n + ": \"a string that is too long to be stored inline\";\n";
+                source += "alloc array<16, int> a" + n + ";\n";
+                source += "alloc int d" + n + " &dynamic;\n";
+                source += "alloc array<8, float> da" + n + " &dynamic;\n";
+                source += "alloc tuple<int, float, string> u" + n + ";\n";
+                allocations += 8;
+            }
+            source += "return void;\n}\n";
+
+            const source_file file("gen_allocation", source);
+            parser p(file.path());
+            const statement::statement_block ast = p.create_ast();
+            for (size_t i = 0; i < state.iterations(); i++)
+            {
+                cgen generator(false, false, false);
+                state.resume();
+                generator.generate_code(ast);
+                state.pause();
+            }
+            state.set_items_per_iteration(allocations);
+        } });
+
+        return benchmarks;
+    }
+
+    /**
+     * Runs a benchmark with the given number of iterations, returning the seconds it took and the items it handled.
+     */
+    std::pair<double, size_t> run_once(const benchmark& b, size_t iterations)
+    {
+        bench_state state(iterations);
+        b.run(state);
+        state.pause();
+
+        return { state.get_seconds(), state.get_items_per_iteration() };
+    }
+
+    result run_benchmark(const benchmark& b, double min_time, size_t repetitions)
+    {
+        // find how many iterations take at least `min_time`
+        size_t iterations = 1;
+        while (true)
+        {
+            const double seconds = run_once(b, iterations).first;
+            if (seconds >= min_time || iterations >= 1000000000)
+                break;
+
+            const double estimate = seconds > 0.0 ? min_time / seconds * 1.4 : 10.0;
+            iterations = static_cast<size_t>(iterations * std::min(std::max(estimate, 2.0), 10.0));
+        }
+
+        std::vector<double> samples;
+        size_t items = 0;
+        for (size_t i = 0; i < repetitions; i++)
+        {
+            const std::pair<double, size_t> run = run_once(b, iterations);
+            samples.push_back(run.first / iterations * 1e9);
+            items = run.second;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        const double median = samples.size() % 2 ? samples[samples.size() / 2] :
+            (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0;
+        return result{ b.name, iterations, median, samples.front(), items ? items / (median / 1e9) : 0.0 };
+    }
+
+    void print_table(std::ostream& out, const std::vector<result>& results)
+    {
+        out << std::left << std::setw(40) << "benchmark" << std::right <<
+            std::setw(12) << "iterations" <<
+            std::setw(16) << "ns/op" <<
+            std::setw(16) << "min ns/op" <<
+            std::setw(16) << "items/s" << std::endl;
+
+        out << std::fixed;
+        for (const auto& r: results)
+        {
+            out << std::left << std::setw(40) << r.name << std::right <<
+                std::setw(12) << r.iterations <<
+                std::setprecision(1) << std::setw(16) << r.ns_per_op <<
+                std::setw(16) << r.min_ns_per_op <<
+                std::setprecision(0) << std::setw(16) << r.items_per_second << std::endl;
+        }
+    }
+
+    bool write_json(const std::string& filename, const std::string& label, const std::vector<result>& results)
+    {
+        std::ofstream out(filename);
+        if (!out.good())
+            return false;
+
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        // labels are expected to be commit hashes or the like, but quotes would still break the file
+        std::string escaped;
+        for (char c: label)
+        {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+
+        out << "{\n  \"label\": \"" << escaped << "\",\n  \"date\": \"" << date << "\",\n  \"benchmarks\": [\n";
+        out << std::fixed << std::setprecision(3);
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const result& r = results[i];
+            out << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations <<
+                ", \"ns_per_op\": " << r.ns_per_op <<
+                ", \"min_ns_per_op\": " << r.min_ns_per_op <<
+                ", \"items_per_second\": " << r.items_per_second << "}" <<
+                (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+
+        return out.good();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string filter;
+    std::string json_filename;
+    std::string label;
+    double min_time = 0.1;
+    size_t repetitions = 5;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t equals = arg.find('=');
+        const std::string name = arg.substr(0, equals);
+        const std::string value = equals == std::string::npos ? "" : arg.substr(equals + 1);
+
+        if (name == "--filter")
+            filter = value;
+        else if (name == "--json" && !value.empty())
+            json_filename = value;
+        else if (name == "--label")
+            label = value;
+        else if (name == "--min-time" && std::atof(value.c_str()) > 0.0)
+            min_time = std::atof(value.c_str());
+        else if (name == "--repetitions" && std::atoi(value.c_str()) > 0)
+            repetitions = static_cast<size_t>(std::atoi(value.c_str()));
+        else
+        {
+            std::cerr << "Usage: micro_bench [--filter=<text>] [--min-time=<seconds>] [--repetitions=<n>] " <<
+                "[--json=<file>] [--label=<text>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // the compiler reports its progress on stdout, which would get mixed in with the results
+    std::ostringstream discarded;
+    std::ostream results_out(std::cout.rdbuf());
+    std::cout.rdbuf(discarded.rdbuf());
+
+    // a benchmark that fails partway would time less work than it claims, so none of the results are reported
+    std::vector<result> results;
+    for (const auto& b: get_benchmarks())
+    {
+        if (b.name.find(filter) == std::string::npos)
+            continue;
+
+        try
+        {
+            results.push_back(run_benchmark(b, min_time, repetitions));
+        }
+        catch (const std::exception& e)
+        {
+            std::cout.rdbuf(results_out.rdbuf());
+            std::cerr << "Benchmark '" << b.name << "' failed: " << e.what() << std::endl;
+            return 1;
+        }
+        discarded.str("");
+    }
+
+    std::cout.rdbuf(results_out.rdbuf());
+    print_table(std::cout, results);
+
+    if (!json_filename.empty() && !write_json(json_filename, label, results))
+    {
+        std::cerr << "Could not write '" << json_filename << "'" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
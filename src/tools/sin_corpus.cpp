@@ -0,0 +1,575 @@
+/*
+
+SIN Compiler
+sin_corpus.cpp
+
+Generates synthetic SIN programs for benchmarking the compiler.
+
+The programs are valid SIN -- every symbol is defined before it is used, every expression is well-typed, and every
+function returns -- but they don't do anything useful. Their shape is set on the command line, and the same options
+and seed always produce the same files, so timings taken on different commits may be compared.
+
+Usage: sin_corpus [options] [directory]
+
+The corpus is written to `directory` (default `corpus`, created if it doesn't exist) as `main.sin` and one
+`unit_<n>.sin` for each included file.
+
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * The shape of the generated corpus.
+     */
+    struct corpus_options
+    {
+        uint64_t seed = 1;
+        unsigned int functions = 32;        // functions across all files
+        unsigned int statements = 8;        // statements in each block
+        unsigned int depth = 3;             // how deeply `if` and `while` blocks may nest
+        unsigned int structs = 4;           // structs defined in each file
+        unsigned int aggregates = 10;       // percent of local allocations that are structs or tuples
+        unsigned int expression_size = 6;   // operands in the largest expressions
+        unsigned int includes = 4;          // files included by `main.sin`
+        unsigned int literals = 40;         // percent of expression operands that are literals
+    };
+
+    /**
+     * A small, fast generator whose output doesn't depend on the standard library implementation.
+     *
+     * The distributions in <random> are implementation-defined, so they would give a different corpus on each platform.
+     */
+    class random_source
+    {
+        uint64_t _state;
+    public:
+        // splitmix64
+        uint64_t next()
+        {
+            uint64_t z = (_state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * Gets a number in [low, high].
+         */
+        unsigned int between(unsigned int low, unsigned int high)
+        {
+            return low + static_cast<unsigned int>(next() % (static_cast<uint64_t>(high) - low + 1));
+        }
+
+        /**
+         * Returns true `percent` percent of the time.
+         */
+        bool chance(unsigned int percent)
+        {
+            return next() % 100 < percent;
+        }
+
+        explicit random_source(uint64_t seed)
+            : _state(seed) { }
+    };
+
+    enum local_kind
+    {
+        INT_LOCAL,
+        FLOAT_LOCAL,
+        OTHER_LOCAL
+    };
+
+    struct local
+    {
+        std::string name;
+        local_kind kind;
+    };
+
+    struct struct_info
+    {
+        std::string name;
+        std::vector<std::string> int_members;
+    };
+
+    /**
+     * Writes the files of a corpus.
+     *
+     * Each included file only uses its own functions and structs; `main.sin` includes all of them, so it may use
+     * anything defined in the corpus.
+     */
+    class corpus_generator
+    {
+        corpus_options _options;
+        random_source _random;
+
+        std::ostringstream _out;
+        unsigned int _indent;
+
+        // the functions and structs that may be used by the code being generated
+        std::vector<std::string> _functions;
+        std::vector<struct_info> _structs;
+
+        // those defined by the files already written
+        std::vector<std::string> _all_functions;
+        std::vector<struct_info> _all_structs;
+
+        // the locals in each enclosing block
+        std::vector<std::vector<local>> _scopes;
+        unsigned int _next_local;
+
+        void line(const std::string& text)
+        {
+            _out << std::string(_indent * 4, ' ') << text << "\n";
+        }
+
+        std::string gen_int_literal()
+        {
+            return std::to_string(_random.between(0, 99));
+        }
+
+        std::string gen_float_literal()
+        {
+            return std::to_string(_random.between(0, 99)) + "." + std::to_string(_random.between(0, 9));
+        }
+
+        std::string gen_string_literal()
+        {
+            static const char* const words[] = { "alpha", "beta", "gamma", "delta", "sin", "corpus", "value", "data" };
+
+            std::string s;
+            const unsigned int count = _random.between(1, 4);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                if (i)
+                    s += ' ';
+                s += words[_random.between(0, sizeof(words) / sizeof(words[0]) - 1)];
+            }
+
+            return "\"" + s + "\"";
+        }
+
+        std::string new_local_name()
+        {
+            return "v" + std::to_string(_next_local++);
+        }
+
+        /**
+         * Picks a local of the given kind in scope, or returns an empty string if there isn't one.
+         */
+        std::string pick_local(local_kind kind)
+        {
+            std::vector<const local*> candidates;
+            for (const auto& scope: _scopes)
+            {
+                for (const auto& l: scope)
+                {
+                    if (l.kind == kind)
+                        candidates.push_back(&l);
+                }
+            }
+
+            if (candidates.empty())
+                return "";
+
+            return candidates[_random.between(0, candidates.size() - 1)]->name;
+        }
+
+        std::string gen_operand(local_kind kind, bool allow_calls)
+        {
+            if (!_random.chance(_options.literals))
+            {
+                // calls are kept to a few percent of operands so that expressions don't grow too quickly
+                if (kind == INT_LOCAL && allow_calls && !_functions.empty() && _random.chance(5))
+                {
+                    const std::string& callee = _functions[_random.between(0, _functions.size() - 1)];
+                    return "@" + callee + "(" + gen_expression(INT_LOCAL, 2, false) + ", " +
+                        gen_expression(INT_LOCAL, 2, false) + ")";
+                }
+
+                const std::string name = pick_local(kind);
+                if (!name.empty())
+                    return name;
+            }
+
+            return kind == FLOAT_LOCAL ? gen_float_literal() : gen_int_literal();
+        }
+
+        /**
+         * Generates an arithmetic expression with `size` operands.
+         *
+         * Only addition, subtraction, and multiplication are used, so that constant expressions never divide by zero.
+         */
+        std::string gen_expression(local_kind kind, unsigned int size, bool allow_calls = true)
+        {
+            if (size <= 1)
+                return gen_operand(kind, allow_calls);
+
+            static const char* const operators[] = { " + ", " - ", " * " };
+
+            const unsigned int left = _random.between(1, size - 1);
+            std::string lhs = gen_expression(kind, left, allow_calls);
+            std::string rhs = gen_expression(kind, size - left, allow_calls);
+            if (left > 1 && _random.chance(50))
+                lhs = "(" + lhs + ")";
+            if (size - left > 1)
+                rhs = "(" + rhs + ")";
+
+            return lhs + operators[_random.between(0, 2)] + rhs;
+        }
+
+        std::string gen_condition()
+        {
+            static const char* const comparisons[] = { " < ", " > ", " <= ", " >= ", " = ", " != " };
+
+            const unsigned int size = _random.between(1, (_options.expression_size + 1) / 2);
+            std::string condition = "(" + gen_expression(INT_LOCAL, size) + comparisons[_random.between(0, 5)] +
+                gen_expression(INT_LOCAL, size) + ")";
+            if (_random.chance(25))
+            {
+                condition += _random.chance(50) ? " and " : " or ";
+                condition += "(" + gen_expression(INT_LOCAL, 1) + " < " + gen_expression(INT_LOCAL, 1) + ")";
+            }
+
+            return condition;
+        }
+
+        void gen_allocation()
+        {
+            const std::string name = new_local_name();
+            if (_random.chance(_options.aggregates))
+            {
+                if (!_structs.empty() && _random.chance(50))
+                {
+                    const struct_info& s = _structs[_random.between(0, _structs.size() - 1)];
+                    line("alloc " + s.name + " " + name + ";");
+                    if (!s.int_members.empty())
+                    {
+                        const std::string& member = s.int_members[_random.between(0, s.int_members.size() - 1)];
+                        line("let " + name + "." + member + " = " +
+                            gen_expression(INT_LOCAL, _random.between(1, _options.expression_size)) + ";");
+                    }
+                }
+                else
+                {
+                    line("alloc tuple<int, float, string> " + name + ";");
+                }
+
+                _scopes.back().push_back(local{ name, OTHER_LOCAL });
+                return;
+            }
+
+            const unsigned int kind = _random.between(0, 9);
+            if (kind < 7)
+            {
+                line("alloc int " + name + ": " + gen_expression(INT_LOCAL, _random.between(1, _options.expression_size)) + ";");
+                _scopes.back().push_back(local{ name, INT_LOCAL });
+            }
+            else if (kind < 9)
+            {
+                line("alloc float " + name + ": " + gen_expression(FLOAT_LOCAL, _random.between(1, _options.expression_size)) + ";");
+                _scopes.back().push_back(local{ name, FLOAT_LOCAL });
+            }
+            else
+            {
+                line("alloc string " + name + ": " + gen_string_literal() + ";");
+                _scopes.back().push_back(local{ name, OTHER_LOCAL });
+            }
+        }
+
+        void gen_assignment()
+        {
+            const local_kind kind = _random.chance(80) ? INT_LOCAL : FLOAT_LOCAL;
+            const std::string target = pick_local(kind);
+            if (target.empty())
+            {
+                gen_allocation();
+                return;
+            }
+
+            line("let " + target + " = " + gen_expression(kind, _random.between(1, _options.expression_size)) + ";");
+        }
+
+        void gen_block(unsigned int depth)
+        {
+            _scopes.emplace_back();
+            for (unsigned int i = 0; i < _options.statements; i++)
+            {
+                const unsigned int kind = _random.between(0, 9);
+                if (kind < 2 && depth < _options.depth)
+                {
+                    line("if (" + gen_condition() + ") {");
+                    _indent++;
+                    gen_block(depth + 1);
+                    _indent--;
+                    if (_random.chance(50))
+                    {
+                        line("} else {");
+                        _indent++;
+                        gen_block(depth + 1);
+                        _indent--;
+                    }
+                    line("}");
+                }
+                else if (kind < 3 && depth < _options.depth)
+                {
+                    // loops count up to a literal bound, so they always terminate
+                    const std::string counter = new_local_name();
+                    line("alloc int " + counter + ": 0;");
+                    line("while (" + counter + " < " + gen_int_literal() + ") {");
+                    _indent++;
+                    gen_block(depth + 1);
+                    line("let " + counter + " = " + counter + " + 1;");
+                    _indent--;
+                    line("}");
+                    _scopes.back().push_back(local{ counter, INT_LOCAL });
+                }
+                else if (kind < 6)
+                {
+                    gen_assignment();
+                }
+                else
+                {
+                    gen_allocation();
+                }
+            }
+            _scopes.pop_back();
+        }
+
+        void gen_function(const std::string& name)
+        {
+            // every call passes two arguments, so a third parameter must have a default value
+            std::string parameters = "alloc int p0, alloc int p1";
+            if (_random.chance(25))
+                parameters += ", alloc int p2: " + gen_int_literal();
+
+            _scopes.emplace_back();
+            _scopes.back().push_back(local{ "p0", INT_LOCAL });
+            _scopes.back().push_back(local{ "p1", INT_LOCAL });
+
+            _next_local = 0;
+            line("def int " + name + "(" + parameters + ") {");
+            _indent++;
+            gen_block(1);
+            line("return " + gen_expression(INT_LOCAL, _random.between(1, _options.expression_size)) + ";");
+            _indent--;
+            line("}");
+            line("");
+            _scopes.pop_back();
+
+            _functions.push_back(name);
+        }
+
+        void gen_struct(const std::string& name)
+        {
+            static const char* const types[] = { "int", "float", "bool", "char", "long int", "short int", "long float" };
+
+            struct_info info{ name, { } };
+            line("def struct " + name + " {");
+            _indent++;
+            const unsigned int members = _random.between(2, 8);
+            for (unsigned int i = 0; i < members; i++)
+            {
+                const std::string member = "m" + std::to_string(i);
+                const char* type = types[_random.between(0, sizeof(types) / sizeof(types[0]) - 1)];
+                line("alloc " + std::string(type) + " " + member + ";");
+                if (std::strcmp(type, "int") == 0)
+                    info.int_members.push_back(member);
+            }
+            _indent--;
+            line("}");
+            line("");
+
+            _structs.push_back(info);
+        }
+
+        /**
+         * Generates the globals of a file; their initializers are constant, as static data requires.
+         */
+        void gen_globals(const std::string& prefix)
+        {
+            const unsigned int count = _random.between(1, 4);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                const std::string name = prefix + "_g" + std::to_string(i);
+                if (_random.chance(25))
+                {
+                    line("alloc const string " + name + ": " + gen_string_literal() + ";");
+                }
+                else
+                {
+                    // there are no locals in scope here, so every operand is a literal
+                    line("alloc int " + name + ": " + gen_expression(INT_LOCAL, _random.between(1, _options.expression_size), false) + ";");
+                }
+            }
+
+            if (!_structs.empty() && _random.chance(50))
+            {
+                line("alloc array<" + std::to_string(_random.between(1, 64)) + ", " + _structs.back().name + "> " + prefix + "_table;");
+            }
+            line("");
+        }
+
+        std::string gen_file(const std::string& prefix, unsigned int function_count, bool is_main, const std::vector<std::string>& includes)
+        {
+            _out.str("");
+            _indent = 0;
+
+            if (is_main)
+            {
+                _functions = _all_functions;
+                _structs = _all_structs;
+            }
+            else
+            {
+                _functions.clear();
+                _structs.clear();
+            }
+
+            line("// generated by sin_corpus; do not edit");
+            line("");
+            for (const auto& include: includes)
+            {
+                line("include \"" + include + "\";");
+            }
+            if (!includes.empty())
+                line("");
+
+            for (unsigned int i = 0; i < _options.structs; i++)
+            {
+                gen_struct(prefix + "_s" + std::to_string(i));
+            }
+            gen_globals(prefix);
+            for (unsigned int i = 0; i < function_count; i++)
+            {
+                gen_function(prefix + "_f" + std::to_string(i));
+            }
+
+            if (!is_main)
+            {
+                _all_functions.insert(_all_functions.end(), _functions.begin(), _functions.end());
+                _all_structs.insert(_all_structs.end(), _structs.begin(), _structs.end());
+            }
+
+            return _out.str();
+        }
+    public:
+        /**
+         * Writes the corpus to `directory`, returning false if a file couldn't be written.
+         */
+        bool write(const std::string& directory)
+        {
+            std::error_code error;
+            std::filesystem::create_directories(directory, error);
+            if (error)
+            {
+                std::cerr << "Could not create '" << directory << "': " << error.message() << std::endl;
+                return false;
+            }
+
+            // the functions are shared evenly between the files, with any left over going to main
+            const unsigned int files = _options.includes + 1;
+            const unsigned int per_file = _options.functions / files;
+
+            std::vector<std::string> units;
+            for (unsigned int i = 0; i < files; i++)
+            {
+                const bool is_main = i == _options.includes;
+                const std::string filename = is_main ? "main.sin" : "unit_" + std::to_string(i) + ".sin";
+                const unsigned int count = is_main ? _options.functions - per_file * _options.includes : per_file;
+                const std::string code = gen_file(is_main ? "main" : "unit" + std::to_string(i), count, is_main, units);
+
+                std::ofstream out(directory + "/" + filename);
+                if (!out.good())
+                {
+                    std::cerr << "Could not open '" << directory << "/" << filename << "'" << std::endl;
+                    return false;
+                }
+                out << code;
+                units.push_back(filename);
+            }
+
+            return true;
+        }
+
+        explicit corpus_generator(const corpus_options& options)
+            : _options(options)
+            , _random(options.seed)
+            , _indent(0)
+            , _next_local(0) { }
+    };
+
+    void print_usage()
+    {
+        std::cerr << "Usage: sin_corpus [options] [directory]\n"
+            "  --seed=N             seed for the generator (default 1)\n"
+            "  --functions=N        functions across all files (default 32)\n"
+            "  --statements=N       statements in each block (default 8)\n"
+            "  --depth=N            nesting depth of if and while blocks (default 3)\n"
+            "  --structs=N          structs defined in each file (default 4)\n"
+            "  --aggregates=P       percent of local allocations that are structs or tuples (default 10)\n"
+            "  --expression-size=N  operands in the largest expressions (default 6)\n"
+            "  --includes=N         files included by main.sin (default 4)\n"
+            "  --literals=P         percent of expression operands that are literals (default 40)\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    corpus_options options;
+    std::string directory = "corpus";
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t equals = arg.find('=');
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            directory = arg;
+            continue;
+        }
+        else if (equals == std::string::npos)
+        {
+            print_usage();
+            return 1;
+        }
+
+        const std::string name = arg.substr(2, equals - 2);
+        const unsigned long long value = std::strtoull(arg.c_str() + equals + 1, nullptr, 10);
+        if (name == "seed")
+            options.seed = value;
+        else if (name == "functions")
+            options.functions = static_cast<unsigned int>(value);
+        else if (name == "statements")
+            options.statements = static_cast<unsigned int>(value);
+        else if (name == "depth")
+            options.depth = static_cast<unsigned int>(value);
+        else if (name == "structs")
+            options.structs = static_cast<unsigned int>(value);
+        else if (name == "aggregates" && value <= 100)
+            options.aggregates = static_cast<unsigned int>(value);
+        else if (name == "expression-size" && value > 0)
+            options.expression_size = static_cast<unsigned int>(value);
+        else if (name == "includes")
+            options.includes = static_cast<unsigned int>(value);
+        else if (name == "literals" && value <= 100)
+            options.literals = static_cast<unsigned int>(value);
+        else
+        {
+            print_usage();
+            return 1;
+        }
+    }
+
+    corpus_generator generator(options);
+    return generator.write(directory) ? 0 : 1;
+}
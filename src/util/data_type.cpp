@@ -19,6 +19,29 @@ const std::unordered_map<
     std::make_pair<>(enumerations::primitive_type::VOID, "v")
 };
 
+size_t data_type::_array_header_size = sin_widths::ARRAY_LENGTH_SIZE;
+
+void data_type::set_array_alignment(size_t alignment)
+{
+	_array_header_size = alignment > sin_widths::ARRAY_LENGTH_SIZE ? alignment : sin_widths::ARRAY_LENGTH_SIZE;
+}
+
+size_t data_type::get_array_header_size()
+{
+	return _array_header_size;
+}
+
+size_t data_type::get_array_width(size_t length, size_t element_width)
+{
+	const size_t width = _array_header_size + length * element_width;
+	if (_array_header_size == sin_widths::ARRAY_LENGTH_SIZE)
+	{
+		return width;
+	}
+
+	return (width + _array_header_size - 1) / _array_header_size * _array_header_size;
+}
+
 void data_type::set_width()
 {
 	// All other types have different widths
@@ -50,9 +73,8 @@ void data_type::set_width()
 		// because we are compiling to x86_64, pointers and references should be 64-bit
 		this->width = sin_widths::PTR_WIDTH;
 	} else if (this->primary == enumerations::primitive_type::STRING) {
-		// since strings are all implemented as pointers, they have widths of 8 bytes
-		// (they always point to dynamic memory, but syntactically don't behave like pointers)
-		this->width = sin_widths::PTR_WIDTH;
+		// short strings are stored inline, and only long ones point to dynamic memory (see runtime/sinl_string.h)
+		this->width = sin_widths::STRING_WIDTH;
 	} else if (this->primary == enumerations::primitive_type::CHAR) {
 		// todo: determine whether it is ASCII or UTF-8
 		this->width = sin_widths::CHAR_WIDTH;
@@ -74,12 +96,23 @@ void data_type::set_width()
 			it++;
 		}
 	}
+	else if (this->primary == enumerations::primitive_type::ARRAY && this->array_length != 0) {
+		// once the length has been evaluated, the width is the header plus the width of each element
+		// if the element width isn't known yet (e.g., a struct), we still have to wait for the struct table
+		size_t element_width = this->contained_types.empty() ? 0 : this->contained_types[0].get_width();
+		if (element_width != 0) {
+			this->width = get_array_width(this->array_length, element_width);
+		}
+		else {
+			this->width = 0;
+		}
+	}
 	else {
 		/*
 
 		Everything else should use 0:
 			void	-	a void type is literally nothing
-			array	-	do not have defined widths, it depends on the array and its subtype
+			array	-	do not have defined widths until the compiler has evaluated the length
 			struct	-	require the compiler to look for the width in the struct table
 			
 		While it is possible to calculate the width of arrays and structs if all of that information is known at compile time, it is possible that a struct member would only be known to the compiler through the "decl" keyword, in which case it would be impossible to know the width when the allocation was occurring.
@@ -327,6 +360,7 @@ void data_type::set_contained_types(std::vector<data_type> types_list) {
 
 void data_type::set_array_length(size_t new_length) {
 	this->array_length = new_length;
+	this->set_width();
 }
 
 void data_type::add_qualities(symbol_qualities to_add) {
@@ -401,6 +435,16 @@ bool data_type::is_valid_type(const data_type &t) {
 		return t.qualities.is_managed();
 	}
 
+	// only fixed-length arrays of structs may be split into parallel arrays of their members
+	if (t.qualities.is_soa() && (
+		t.primary != enumerations::primitive_type::ARRAY ||
+		t.qualities.is_dynamic() ||
+		t.contained_types.empty() ||
+		t.contained_types[0].primary != enumerations::primitive_type::STRUCT
+	)) {
+		is_valid = false;
+	}
+
 	return is_valid;
 }
 
@@ -457,6 +501,12 @@ std::string data_type::decorate() const
 	bool first = true;
 	for (const auto& contained: contained_types)
 	{
+		// scalar types still carry an empty subtype, which has no encoding
+		if (contained.get_primary() == enumerations::primitive_type::NONE)
+		{
+			continue;
+		}
+
 		if (first)
 		{
 			decorated << "&";
@@ -531,7 +581,7 @@ std::string data_type::get_c_typename() const
         }
         case primitive_type::STRING:
         {
-            type_string = constants::STRING_BASE;
+            type_string = "sinl_string";
             break;
         }
         case primitive_type::BOOL:
@@ -539,6 +589,11 @@ std::string data_type::get_c_typename() const
             type_string = "bool";
             break;
         }
+        case primitive_type::CHAR:
+        {
+            type_string = "char";
+            break;
+        }
         case primitive_type::VOID:
         {
             type_string = "void";
@@ -613,6 +668,8 @@ std::string data_type::get_c_typename() const
 	{
 		type_string += " *";
 	}
+
+	return type_string;
 }
 
 data_type::data_type
@@ -640,7 +697,8 @@ data_type::data_type
 	this->array_length = 0;
 	
     // if the type is int, set signed to true if it is not unsigned
-	if (primary == enumerations::primitive_type::INT && !this->qualities.is_unsigned()) {
+	// note 'is_unsigned' can't be used here; it is true whenever 'signed' hasn't been set yet
+	if (primary == enumerations::primitive_type::INT && !this->qualities.has_sign_quality()) {
 		this->qualities.add_quality(enumerations::symbol_quality::SIGNED);
 	}
 	else if (primary == enumerations::primitive_type::FLOAT)
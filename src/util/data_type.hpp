@@ -47,7 +47,27 @@ class data_type
     void set_must_free();
 
     bool _must_free;
+
+	/**
+	 * The size of the header at the head of every array; the length word, padded to the alignment of the elements.
+	 */
+	static size_t _array_header_size;
 public:
+	/**
+	 * Sets the alignment of array elements for the whole build.
+	 * 
+	 * Arrays pad their length word out to this many bytes, so the widths of array types depend on it;
+	 * it must be set before any are created. An alignment no greater than the length word leaves arrays packed.
+	 */
+	static void set_array_alignment(size_t alignment);
+	static size_t get_array_header_size();
+	/**
+	 * Gets the width of an array of `length` elements, each `element_width` bytes wide.
+	 *
+	 * Aligned arrays are padded at the end to a multiple of the alignment, as C pads the storage types they are declared with.
+	 */
+	static size_t get_array_width(size_t length, size_t element_width);
+
 	/**
 	 * Ensures that type promotion rules are not broken
 	 */
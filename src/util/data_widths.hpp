@@ -22,5 +22,7 @@ namespace sin_widths {
     constexpr size_t HALF_WIDTH = 2;
 
     constexpr size_t STRING_LENGTH_SIZE = 4;
+    constexpr size_t STRING_WIDTH = 24;    // the length, followed by the characters of short strings or a pointer to those of long ones
+    constexpr size_t STRING_SMALL_CAPACITY = 19;   // the longest string stored inline; must match SINL_STRING_SMALL_CAPACITY
     constexpr size_t ARRAY_LENGTH_SIZE = 4;
 };
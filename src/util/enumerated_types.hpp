@@ -85,7 +85,8 @@ namespace enumerations
 		C64_CONVENTION,
 		WINDOWS_CONVENTION,
 		EXTERN,
-		UNMANAGED
+		UNMANAGED,
+		SOA
 	};
 
 	/**< A list of available operators */
@@ -154,4 +155,23 @@ namespace enumerations
 		STRUCT,
 		TUPLE
 	};
+
+	/**< How the code generator obtains dynamic memory */
+	enum allocation_mode {
+		POOLED_ALLOCATION,	// the runtime's pooled allocator; resources are managed by the MAM
+		REGION_ALLOCATION	// a bump-pointer region that is reset when the allocating scope exits
+	};
+
+	/**< How reference counts on managed resources are updated */
+	enum refcount_mode {
+		ATOMIC_REFCOUNT,	// safe to share resources between threads
+		NONATOMIC_REFCOUNT,	// for single-threaded programs
+		BIASED_REFCOUNT	// the allocating thread's updates are non-atomic, others' are atomic
+	};
+
+	/**< How the members of structs are laid out */
+	enum struct_layout {
+		DECLARED_LAYOUT,	// in declaration order, with no padding
+		ALIGNED_LAYOUT	// sorted by decreasing alignment and padded to their natural alignment
+	};
 } /* namespace enumerations */
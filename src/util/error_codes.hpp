@@ -30,6 +30,7 @@ namespace error_code {
     constexpr unsigned int INVALID_UNARY_OPERATOR_ERROR = 55;   /**< This operator may not be used as a unary operator. */
     constexpr unsigned int UNARY_TYPE_NOT_SUPPORTED = 56;   /**< The unary operator given is not defined for the type found. */
 	constexpr unsigned int UNDEFINED_OPERATOR_ERROR = 57;	/**< The operator is undefined for the given data type. */
+    constexpr unsigned int DIVISION_BY_ZERO = 58;   /**< A constant expression divided by zero. */
     
     constexpr unsigned int ILLEGAL_ADDRESS_OF_ARGUMENT = 61;    /**< The address-of operator may only be used with lvalues and member selection binary expressions. */
     constexpr unsigned int ILLEGAL_INDIRECTION = 62;    /** The dereference (`*`) operator may only be used with pointer types. */
@@ -55,3 +55,17 @@ bool general_utilities::is_bitwise(const enumerations::exp_operator op) {
             op == enumerations::exp_operator::BIT_XOR || 
             op == enumerations::exp_operator::BIT_NOT);
 }
+
+/**
+ * Quotes a string for use as a C string literal, such as a file name in the generated code.
+ */
+std::string general_utilities::quote(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c: s) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+
+    return quoted + "\"";
+}
@@ -9,4 +9,5 @@ namespace general_utilities {
     bool returns(const statement::statement_base& to_check);
     bool ite_returns(const statement::if_else* to_check);
     bool is_bitwise(const enumerations::exp_operator op);
+    std::string quote(const std::string& s);
 }
@@ -0,0 +1,363 @@
+#include "phase_report.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+/*
+ * Every allocation the compiler makes goes through these, so that phases can be charged for the allocations they make.
+ *
+ * The counts are kept per thread, in plain variables, so that counting costs next to nothing whether or not a report
+ * was asked for; phases are only timed on the thread that enabled the report, so its own counts are all they need.
+ * Each form of `operator new` is replaced, so that none of them bypasses the counts, along with the matching forms of
+ * `operator delete`.
+ */
+
+static thread_local size_t allocation_count = 0;
+static thread_local size_t allocated_bytes = 0;
+
+static void* allocate(std::size_t size) noexcept
+{
+    allocation_count++;
+    allocated_bytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+static void* allocate(std::size_t size, std::align_val_t alignment) noexcept
+{
+    allocation_count++;
+    allocated_bytes += size;
+
+    // aligned_alloc() requires the size to be a nonzero multiple of the alignment
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = size ? (size + align - 1) / align * align : align;
+    return std::aligned_alloc(align, rounded);
+}
+
+void* operator new(std::size_t size)
+{
+    void* p = allocate(size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    void* p = allocate(size, alignment);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return allocate(size, alignment);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+namespace general_utilities
+{
+    phase_report::scope::scope(const char* name, const std::string& detail)
+        : _span(name, "phase", detail)
+        , _index(phase_report::get().start(name))
+    {
+        // scopes are left in place around small passes, so they do nothing more than this unless the report is enabled
+        if (_index == npos)
+            return;
+
+        _wall_start = std::chrono::steady_clock::now();
+        _cpu_start = std::clock();
+        _allocations_start = get_allocations();
+        _bytes_start = get_allocated_bytes();
+    }
+
+    phase_report::scope::~scope()
+    {
+        if (_index == npos)
+            return;
+
+        const std::chrono::duration<double> wall = std::chrono::steady_clock::now() - _wall_start;
+        const double cpu = static_cast<double>(std::clock() - _cpu_start) / CLOCKS_PER_SEC;
+        phase_report::get().finish(
+            _index,
+            wall.count(),
+            cpu,
+            get_allocations() - _allocations_start,
+            get_allocated_bytes() - _bytes_start
+        );
+    }
+
+    phase_report& phase_report::get()
+    {
+        static phase_report report;
+        return report;
+    }
+
+    void phase_report::enable(format f)
+    {
+        _enabled = true;
+        _format = f;
+        _owner = std::this_thread::get_id();
+    }
+
+    size_t phase_report::get_allocations()
+    {
+        return allocation_count;
+    }
+
+    size_t phase_report::get_allocated_bytes()
+    {
+        return allocated_bytes;
+    }
+
+    long phase_report::get_peak_rss()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+        {
+#if defined(__APPLE__)
+            return usage.ru_maxrss / 1024;  // bytes on macOS
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return 0;
+    }
+
+    /**
+     * Starts a run of the named phase under the current one, returning its index, or `npos` if the report is disabled.
+     */
+    size_t phase_report::start(const char* name)
+    {
+        if (!_enabled || std::this_thread::get_id() != _owner)
+            return npos;
+
+        // a phase is identified by its name and where it is nested
+        size_t index = npos;
+        for (size_t i = 0; i < _phases.size(); i++)
+        {
+            if (_phases[i].parent == _current && _phases[i].name == name)
+            {
+                index = i;
+                break;
+            }
+        }
+
+        if (index == npos)
+        {
+            const size_t depth = _current == npos ? 0 : _phases[_current].depth + 1;
+            _phases.push_back(phase{ name, _current, depth, 0, 0.0, 0.0, 0, 0, 0 });
+            index = _phases.size() - 1;
+        }
+
+        _current = index;
+        return index;
+    }
+
+    void phase_report::finish(size_t index, double wall, double cpu, size_t allocations, size_t bytes)
+    {
+        phase& p = _phases[index];
+        p.runs++;
+        p.wall_seconds += wall;
+        p.cpu_seconds += cpu;
+        p.allocations += allocations;
+        p.allocated_bytes += bytes;
+        p.peak_rss_kib = get_peak_rss();
+
+        _current = p.parent;
+    }
+
+    void phase_report::print(std::ostream& out) const
+    {
+        if (!_enabled)
+            return;
+
+        if (_format == JSON)
+            print_json(out);
+        else
+            print_table(out);
+    }
+
+    void phase_report::print_table(std::ostream& out) const
+    {
+        const std::ios::fmtflags flags = out.flags();
+
+        out << "**** Time report:" << std::endl;
+        out << std::left << std::setw(32) << "phase" << std::right <<
+            std::setw(6) << "runs" <<
+            std::setw(12) << "wall (ms)" <<
+            std::setw(12) << "cpu (ms)" <<
+            std::setw(14) << "allocations" <<
+            std::setw(14) << "alloc (KiB)" <<
+            std::setw(16) << "peak RSS (KiB)" << std::endl;
+
+        // print each phase followed by the phases nested in it, in the order they were first started
+        std::vector<size_t> order;
+        for (size_t i = 0; i < _phases.size(); i++)
+        {
+            if (_phases[i].parent == npos)
+            {
+                std::vector<size_t> stack{ i };
+                while (!stack.empty())
+                {
+                    const size_t p = stack.back();
+                    stack.pop_back();
+                    order.push_back(p);
+
+                    for (size_t c = _phases.size(); c-- > p + 1; )
+                    {
+                        if (_phases[c].parent == p)
+                            stack.push_back(c);
+                    }
+                }
+            }
+        }
+
+        out << std::fixed << std::setprecision(3);
+        for (size_t i: order)
+        {
+            const phase& p = _phases[i];
+            out << std::left << std::setw(32) << (std::string(p.depth * 2, ' ') + p.name) << std::right <<
+                std::setw(6) << p.runs <<
+                std::setw(12) << p.wall_seconds * 1000.0 <<
+                std::setw(12) << p.cpu_seconds * 1000.0 <<
+                std::setw(14) << p.allocations <<
+                std::setw(14) << p.allocated_bytes / 1024 <<
+                std::setw(16) << p.peak_rss_kib << std::endl;
+        }
+
+        out.flags(flags);
+    }
+
+    /**
+     * Prints the phases as a JSON array, in the order they were first started.
+     */
+    void phase_report::print_json(std::ostream& out) const
+    {
+        const std::ios::fmtflags flags = out.flags();
+
+        out << "[\n" << std::fixed << std::setprecision(6);
+        for (size_t i = 0; i < _phases.size(); i++)
+        {
+            const phase& p = _phases[i];
+            out << "  {\"phase\": \"" << p.name << "\", \"parent\": ";
+            if (p.parent == npos)
+                out << "null";
+            else
+                out << "\"" << _phases[p.parent].name << "\"";
+
+            out << ", \"runs\": " << p.runs <<
+                ", \"wall_seconds\": " << p.wall_seconds <<
+                ", \"cpu_seconds\": " << p.cpu_seconds <<
+                ", \"allocations\": " << p.allocations <<
+                ", \"allocated_bytes\": " << p.allocated_bytes <<
+                ", \"peak_rss_kib\": " << p.peak_rss_kib << "}" <<
+                (i + 1 < _phases.size() ? "," : "") << "\n";
+        }
+        out << "]" << std::endl;
+
+        out.flags(flags);
+    }
+
+    phase_report::phase_report()
+        : _enabled(false)
+        , _format(TABLE)
+        , _current(npos) { }
+}
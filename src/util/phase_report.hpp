@@ -0,0 +1,107 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace general_utilities
+{
+    /**
+     * Collects the time and memory each phase of compilation takes, for `--time-report`.
+     *
+     * Phases are timed by creating a `phase_report::scope` for their duration; a phase started within another is nested
+     * under it in the report, and its time is included in its parent's. Phases that run more than once, such as the
+     * optimization passes run for each function, are added together.
+     *
+     * Nothing is recorded unless the report has been enabled, so the scopes may be left in place. The driver prints the
+     * report once the whole build, including the C compiler, has finished. Phases are only timed on the thread that
+     * enabled the report, and scopes on other threads are ignored; work on other threads should be traced with
+     * `trace::span` instead.
+     */
+    class phase_report
+    {
+    public:
+        enum format
+        {
+            TABLE,
+            JSON
+        };
+
+        /**
+         * The totals for one phase.
+         */
+        struct phase
+        {
+            std::string name;
+            size_t parent;          // the index of the enclosing phase, or `npos` if there is none
+            size_t depth;
+            size_t runs;
+            double wall_seconds;
+            double cpu_seconds;
+            size_t allocations;     // calls to `operator new`
+            size_t allocated_bytes;
+            long peak_rss_kib;      // the process's peak resident set size when the phase last finished
+        };
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        /**
+         * Times a phase from construction to destruction.
+         *
+         * The phase is also recorded as a span in the trace, if there is one, along with `detail`.
+         */
+        class scope
+        {
+            trace::span _span;
+            size_t _index;
+            std::chrono::steady_clock::time_point _wall_start;
+            std::clock_t _cpu_start;
+            size_t _allocations_start;
+            size_t _bytes_start;
+        public:
+            explicit scope(const char* name, const std::string& detail = "");
+            ~scope();
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+        };
+
+        static phase_report& get();
+
+        void enable(format f = TABLE);
+        bool is_enabled() const { return _enabled; }
+
+        const std::vector<phase>& get_phases() const { return _phases; }
+        void print(std::ostream& out) const;
+
+        /**
+         * Gets the number of calls to `operator new` made by the calling thread so far, and the number of bytes they
+         * requested.
+         */
+        static size_t get_allocations();
+        static size_t get_allocated_bytes();
+        /**
+         * Gets the peak resident set size of the process so far, in KiB, or 0 if it isn't available.
+         */
+        static long get_peak_rss();
+    private:
+        bool _enabled;
+        format _format;
+        std::vector<phase> _phases;
+        size_t _current;    // the innermost phase running, or `npos`
+        std::thread::id _owner;     // the thread that enabled the report
+
+        size_t start(const char* name);
+        void finish(size_t index, double wall, double cpu, size_t allocations, size_t bytes);
+
+        void print_table(std::ostream& out) const;
+        void print_json(std::ostream& out) const;
+
+        phase_report();
+    };
+}
@@ -12,7 +12,8 @@ const std::unordered_map<std::string, enumerations::symbol_quality> symbol_quali
 	{ "signed", enumerations::symbol_quality::SIGNED },
 	{ "unsigned", enumerations::symbol_quality::UNSIGNED },
 	{ "extern", enumerations::symbol_quality::EXTERN },
-    { "unmanaged", enumerations::symbol_quality::UNMANAGED }
+    { "unmanaged", enumerations::symbol_quality::UNMANAGED },
+    { "soa", enumerations::symbol_quality::SOA }
 };
 
 bool symbol_qualities::operator==(const symbol_qualities& right) const {
@@ -24,7 +25,8 @@ bool symbol_qualities::operator==(const symbol_qualities& right) const {
 		(this->_qualities[_final_index] == right._qualities[_final_index]) &&
 		(this->_qualities[_dynamic_index] == right._qualities[_dynamic_index]) &&
 		(this->_qualities[_extern_index] == right._qualities[_extern_index]) &&
-		(this->_qualities[_managed_index] == right._qualities[_managed_index])
+		(this->_qualities[_managed_index] == right._qualities[_managed_index]) &&
+		(this->_qualities[_soa_index] == right._qualities[_soa_index])
 	);
 }
 
@@ -87,6 +89,11 @@ bool symbol_qualities::is_managed() const
     return _qualities[_managed_index];
 }
 
+bool symbol_qualities::is_soa() const
+{
+    return _qualities[_soa_index];
+}
+
 void symbol_qualities::add_qualities(symbol_qualities to_add)
 {
 	if (to_add._qualities[_const_index])
@@ -118,6 +125,9 @@ void symbol_qualities::add_qualities(symbol_qualities to_add)
     
 	if (!to_add._qualities[_managed_index])
 		this->add_quality(enumerations::symbol_quality::UNMANAGED);
+
+	if (to_add._qualities[_soa_index])
+		this->add_quality(enumerations::symbol_quality::SOA);
 }
 
 void symbol_qualities::add_quality(enumerations::symbol_quality to_add)
@@ -159,6 +169,35 @@ void symbol_qualities::add_quality(enumerations::symbol_quality to_add)
     else if (to_add == enumerations::symbol_quality::UNMANAGED) {
         _qualities[_managed_index] = false;
     }
+	else if (to_add == enumerations::symbol_quality::SOA) {
+		_qualities[_soa_index] = true;
+	}
+	else {
+		throw error::illegal_quality("no quality", 0);
+	}
+}
+
+void symbol_qualities::remove_quality(enumerations::symbol_quality to_remove)
+{
+	// Remove a single storage or access quality; sign, width, and management are changed with add_quality
+	if (to_remove == enumerations::symbol_quality::CONSTANT) {
+		_qualities[_const_index] = false;
+	}
+	else if (to_remove == enumerations::symbol_quality::FINAL) {
+		_qualities[_final_index] = false;
+	}
+	else if (to_remove == enumerations::symbol_quality::STATIC) {
+		_qualities[_static_index] = false;
+	}
+	else if (to_remove == enumerations::symbol_quality::DYNAMIC) {
+		_qualities[_dynamic_index] = false;
+	}
+	else if (to_remove == enumerations::symbol_quality::EXTERN) {
+		_qualities[_extern_index] = false;
+	}
+	else if (to_remove == enumerations::symbol_quality::SOA) {
+		_qualities[_soa_index] = false;
+	}
 	else {
 		throw error::illegal_quality("no quality", 0);
 	}
@@ -216,6 +255,9 @@ symbol_qualities::symbol_qualities(std::vector<enumerations::symbol_quality> qua
         else if (*it == enumerations::symbol_quality::UNMANAGED) {
             _qualities[_managed_index] = false;
         }
+		else if (*it == enumerations::symbol_quality::SOA) {
+			_qualities[_soa_index] = true;
+		}
 		else {
 			continue;
 		}
@@ -273,6 +315,7 @@ symbol_qualities::symbol_qualities()
 	_qualities[_extern_index] = false;
     _qualities[_listed_unsigned_index] = false;
     _qualities[_managed_index] = true;
+    _qualities[_soa_index] = false;
 }
 
 symbol_qualities::~symbol_qualities() { }
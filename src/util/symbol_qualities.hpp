@@ -10,8 +10,8 @@
 
 class symbol_qualities
 {
-	static constexpr std::array<char, 10> _decorations {
-		'c', 'f', 'a', 'd', 'g', 'l', 's', 'e', 'u', 'm'
+	static constexpr std::array<char, 11> _decorations {
+		'c', 'f', 'a', 'd', 'g', 'l', 's', 'e', 'u', 'm', 'o'
 	};
 	std::array<bool, _decorations.size()> _qualities;
 
@@ -25,6 +25,7 @@ class symbol_qualities
 	static constexpr size_t _short_index{7};
 	static constexpr size_t _extern_index{8};
 	static constexpr size_t _managed_index{9};
+	static constexpr size_t _soa_index{10};
 
 public:
 	bool operator==(const symbol_qualities& right) const;
@@ -42,11 +43,13 @@ public:
 	bool is_short() const;
 	bool is_extern() const;
     bool is_managed() const;
+    bool is_soa() const;
 
     bool has_sign_quality() const;
 
 	void add_qualities(symbol_qualities to_add);
     void add_quality(enumerations::symbol_quality to_add);
+    void remove_quality(enumerations::symbol_quality to_remove);
 
 	std::string decorate() const; 
 
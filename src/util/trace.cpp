@@ -0,0 +1,122 @@
+#include "trace.hpp"
+#include "exceptions.hpp"
+
+#include <atomic>
+#include <fstream>
+
+namespace general_utilities
+{
+    trace::span::span(const char* name, const char* category, const std::string& detail)
+        : _name(name)
+        , _category(category)
+        , _start(-1)
+    {
+        trace& t = trace::get();
+        if (t.is_enabled())
+        {
+            _detail = detail;
+            _start = t.now();
+        }
+    }
+
+    trace::span::~span()
+    {
+        if (_start < 0)
+            return;
+
+        trace& t = trace::get();
+        t.record(_name, _category, std::move(_detail), _start, t.now());
+    }
+
+    trace& trace::get()
+    {
+        static trace instance;
+        return instance;
+    }
+
+    void trace::enable(const std::string& filename)
+    {
+        _enabled = true;
+        _filename = filename;
+        _begin = std::chrono::steady_clock::now();
+
+        // the thread that enables the trace gets the first track
+        get_thread_id();
+    }
+
+    int64_t trace::now() const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _begin).count();
+    }
+
+    void trace::record(const char* name, const char* category, std::string&& detail, int64_t start, int64_t end)
+    {
+        const unsigned int thread = get_thread_id();
+
+        std::lock_guard<std::mutex> guard(_lock);
+        _events.push_back(event{ name, category, std::move(detail), start, end - start, thread });
+    }
+
+    /**
+     * Gets a small number identifying the calling thread, numbered in the order they first record something.
+     */
+    unsigned int trace::get_thread_id()
+    {
+        static std::atomic<unsigned int> next_id{1};
+        thread_local const unsigned int id = next_id.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    std::string trace::escape(const std::string& s)
+    {
+        std::string escaped;
+        for (char c: s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+                escaped += c;
+            }
+            else if (static_cast<unsigned char>(c) < 0x20)
+            {
+                escaped += ' ';
+            }
+            else
+            {
+                escaped += c;
+            }
+        }
+
+        return escaped;
+    }
+
+    void trace::write() const
+    {
+        if (!_enabled)
+            return;
+
+        std::ofstream out(_filename);
+        if (!out.good())
+        {
+            throw error::compiler_exception("Could not open trace file '" + _filename + "'");
+        }
+
+        std::lock_guard<std::mutex> guard(_lock);
+        out << "{\"traceEvents\": [\n";
+        out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"csin\"}}";
+        for (const auto& e: _events)
+        {
+            out << ",\n{\"name\": \"" << e.name << "\", \"cat\": \"" << e.category << "\", \"ph\": \"X\", \"ts\": " << e.start <<
+                ", \"dur\": " << e.duration << ", \"pid\": 1, \"tid\": " << e.thread;
+            if (!e.detail.empty())
+            {
+                out << ", \"args\": {\"detail\": \"" << escape(e.detail) << "\"}";
+            }
+            out << "}";
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+    }
+
+    trace::trace()
+        : _enabled(false) { }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace general_utilities
+{
+    /**
+     * Records what the compiler is doing over time, for `--trace=<file>`.
+     *
+     * The trace is written in the Chrome trace event format, which chrome://tracing and Perfetto can display. Each span
+     * is a complete ("X") event on the track of the thread that ran it, so work done on other threads shows up on tracks
+     * of its own. Spans may be recorded from any thread.
+     *
+     * Like the time report, nothing is recorded unless the trace has been enabled; the driver writes it at the end of the build.
+     */
+    class trace
+    {
+    public:
+        /**
+         * Records a span from construction to destruction.
+         *
+         * `detail` is shown with the span, e.g. the file being lexed or the function being generated.
+         */
+        class span
+        {
+            const char* _name;
+            const char* _category;
+            std::string _detail;
+            int64_t _start;     // microseconds since the trace began, or -1 if the trace isn't enabled
+        public:
+            span(const char* name, const char* category, const std::string& detail = "");
+            ~span();
+
+            span(const span&) = delete;
+            span& operator=(const span&) = delete;
+        };
+
+        static trace& get();
+
+        void enable(const std::string& filename);
+        bool is_enabled() const { return _enabled; }
+
+        /**
+         * Writes the events recorded so far to the trace file.
+         */
+        void write() const;
+    private:
+        struct event
+        {
+            const char* name;
+            const char* category;
+            std::string detail;
+            int64_t start;
+            int64_t duration;
+            unsigned int thread;
+        };
+
+        bool _enabled;
+        std::string _filename;
+        std::chrono::steady_clock::time_point _begin;
+        std::vector<event> _events;
+        mutable std::mutex _lock;
+
+        int64_t now() const;
+        void record(const char* name, const char* category, std::string&& detail, int64_t start, int64_t end);
+        static unsigned int get_thread_id();
+        static std::string escape(const std::string& s);
+
+        trace();
+    };
+}